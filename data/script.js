@@ -500,6 +500,111 @@ function getEventIcon(type) {
     return icons[type] || '🌍';
 }
 
+// Helicorder: precomputed min/max columns per day from /api/helicorder
+let helicorderInfo = null;
+let helicorderColumns = null;
+const helicorderColors = ['#000000', '#c0392b', '#1f4e9c', '#1e7b34'];
+
+function loadHelicorderInfo() {
+    fetch('/api/helicorder')
+        .then(response => response.json())
+        .then(info => {
+            helicorderInfo = info;
+            const select = document.getElementById('helicorderDate');
+            const selected = select.value;
+            const days = (info.days || []).slice().sort().reverse();
+            
+            select.innerHTML = days.map(day => '<option value="' + day + '">' + day + '</option>').join('');
+            if (days.includes(selected)) select.value = selected;
+            
+            if (days.length === 0) {
+                document.getElementById('helicorderStatus').innerHTML = 
+                    info.recording ? 'Recording, first data after one minute' : 'Waiting for NTP time';
+                return;
+            }
+            loadHelicorder();
+        })
+        .catch(error => console.error('Helicorder Info Error:', error));
+}
+
+function loadHelicorder() {
+    const date = document.getElementById('helicorderDate').value;
+    if (!date || !helicorderInfo) return;
+    
+    fetch('/api/helicorder?date=' + date)
+        .then(response => {
+            if (!response.ok) throw new Error('HTTP ' + response.status);
+            return response.arrayBuffer();
+        })
+        .then(buffer => {
+            // Little-endian int16 pairs (min, max) per column
+            const view = new DataView(buffer);
+            const count = Math.floor(buffer.byteLength / 4);
+            helicorderColumns = new Int16Array(count * 2);
+            for (let i = 0; i < count * 2; i++) {
+                helicorderColumns[i] = view.getInt16(i * 2, true);
+            }
+            document.getElementById('helicorderStatus').innerHTML = 
+                (count * helicorderInfo.column_s / 3600).toFixed(1) + ' h recorded';
+            drawHelicorder();
+        })
+        .catch(error => {
+            console.error('Helicorder Error:', error);
+            document.getElementById('helicorderStatus').innerHTML = 'Error loading helicorder';
+        });
+}
+
+function drawHelicorder() {
+    const canvas = document.getElementById('helicorderCanvas');
+    const ctx = canvas.getContext('2d');
+    ctx.clearRect(0, 0, canvas.width, canvas.height);
+    if (!helicorderInfo || !helicorderColumns) return;
+    
+    const rows = helicorderInfo.rows;
+    const columnsPerRow = helicorderInfo.columns_per_row;
+    const labelWidth = 50;
+    const rowHeight = canvas.height / rows;
+    const columnWidth = (canvas.width - labelWidth) / columnsPerRow;
+    
+    // Selected scale (mg) maps to half a row; traces may swing one row either way
+    const scaleMg = parseFloat(document.getElementById('helicorderScale').value);
+    const pixelsPerUnit = (rowHeight / 2) / (scaleMg * 1000 / helicorderInfo.unit_ug);
+    const clip = rowHeight;
+    
+    ctx.font = '10px monospace';
+    ctx.lineWidth = Math.max(1, columnWidth * 0.8);
+    const columnCount = helicorderColumns.length / 2;
+    
+    for (let row = 0; row < rows; row++) {
+        const baseline = (row + 0.5) * rowHeight;
+        const minutes = row * helicorderInfo.row_minutes;
+        
+        if (minutes % 60 === 0) {
+            ctx.fillStyle = '#666';
+            const label = String(Math.floor(minutes / 60)).padStart(2, '0') + ':00';
+            ctx.fillText(label, 5, baseline + 3);
+        }
+        
+        ctx.strokeStyle = helicorderColors[row % helicorderColors.length];
+        ctx.beginPath();
+        for (let col = 0; col < columnsPerRow; col++) {
+            const index = row * columnsPerRow + col;
+            if (index >= columnCount) break;
+            
+            const min = helicorderColumns[index * 2];
+            const max = helicorderColumns[index * 2 + 1];
+            if (min > max) continue; // No samples in this column
+            
+            const x = labelWidth + (col + 0.5) * columnWidth;
+            const top = baseline - Math.min(clip, max * pixelsPerUnit);
+            const bottom = baseline - Math.max(-clip, min * pixelsPerUnit);
+            ctx.moveTo(x, bottom + 0.5);
+            ctx.lineTo(x, top - 0.5);
+        }
+        ctx.stroke();
+    }
+}
+
 window.onload = function() {
     initChart();
     
@@ -509,8 +614,10 @@ window.onload = function() {
     // Fallback HTTP polling (reduced frequency since WebSocket handles real-time updates)
     setInterval(updateData, 10000); // Reduced from 5s to 10s
     setInterval(loadSeismicEvents, 30000); // Reduced from 10s to 30s
+    setInterval(loadHelicorderInfo, 300000); // Day files grow once per minute
     
     // Initial data load
     updateData();
     loadSeismicEvents();
+    loadHelicorderInfo();
 };
@@ -24,6 +24,10 @@
 #define TOPIC_DATA "tele/seismograph/data"
 #define TOPIC_EVENT "tele/seismograph/event"
 #define TOPIC_STATUS "tele/seismograph/status"
+#define TOPIC_RSAM "tele/seismograph/rsam"
+#define TOPIC_ALERT "tele/seismograph/alert"  // Early-warning trigger-on/update/summary
+#define TOPIC_TRIGGER_FORMAT "tele/%s/trigger"  // Per station, %s = COINCIDENCE_STATION_ID
+#define TOPIC_TRIGGER_PEERS "tele/+/trigger"  // Trigger on/off of every station on the broker
 #define TOPIC_COMMAND "cmnd/seismograph/"
 
 // MQTT Publishing Intervals
@@ -34,7 +38,41 @@
 
 // Seismograph Configuration
 #define SAMPLING_RATE 500  // Hz - Increased for better seismic detection (Nyquist theorem: >2x highest frequency of interest)
-#define SAMPLING_INTERVAL (1000 / SAMPLING_RATE)  // ms
+#define SAMPLING_PERIOD_US (1000000UL / SAMPLING_RATE)  // us - sample spacing inside a block
+// Oversample-and-decimate: the sensor is read at OVERSAMPLE_FACTOR times
+// SAMPLING_RATE and a FIR low-pass decimates the calibrated channel back to
+// SAMPLING_RATE, gaining ~0.5*log2(factor) bits (e.g. SAMPLING_RATE 200 with
+// factor 5 reads at 1 kHz). The fixed-point pipeline then runs on int32
+// samples with WIDE_SAMPLE_FRACTION_BITS below the sensor LSB.
+#define OVERSAMPLE_FACTOR 1               // 1 = off
+#define DECIMATION_TAPS_PER_PHASE 8       // FIR length = factor * this
+#define DECIMATION_CUTOFF 0.8f            // Pass band edge as a fraction of the output Nyquist
+#define WIDE_SAMPLE_FRACTION_BITS 4
+#define ACQUISITION_RATE (SAMPLING_RATE * OVERSAMPLE_FACTOR)  // Hz - sensor reads
+#define ACQUISITION_PERIOD_US (1000000UL / ACQUISITION_RATE)
+#define SAMPLING_INTERVAL (1000 / ACQUISITION_RATE)  // ms - tick clock period
+// Sample clock: a hardware timer ISR timestamps each read and wakes the
+// sensor task (any rate up to the 1 kHz accelerometer output rate). false
+// falls back to vTaskDelayUntil on the 1 ms FreeRTOS tick.
+#define SAMPLING_CLOCK_TIMER true
+#define SAMPLING_TIMER_NUMBER 0           // Hardware timer group/index used for the sample clock
+#define SAMPLING_TIMER_STALL_MS 50        // No tick for this long counts as a timer stall
+
+#if ACQUISITION_RATE > 1000
+#error "SAMPLING_RATE * OVERSAMPLE_FACTOR above the MPU6050 accelerometer output rate (1 kHz)"
+#endif
+#if !SAMPLING_CLOCK_TIMER && (1000 % ACQUISITION_RATE != 0)
+#error "The tick clock needs the acquisition rate to divide 1000 Hz - enable SAMPLING_CLOCK_TIMER"
+#endif
+// 1 = int16 counts / int32 accumulators (int32 samples when oversampling), 0 = float reference pipeline.
+// Float stays the default until test_sample_format has been measured on the ESP32
+// (on the host the fixed chain is about 20 % faster).
+#define SAMPLE_PIPELINE_FIXED_POINT 0
+// int16 pipeline unit = 2^shift ±2 g counts, so it spans the highest accel range
+// (0 = ±2 g at 61 µg/LSB, 3 = ±16 g at 488 µg/LSB; still below the MPU6050 noise floor).
+// THRESHOLD_MICRO must stay >= 8 LSB (static_assert): with auto-range the int16
+// pipeline needs ACCEL_RANGE_MAX_SHIFT <= 1, or oversampling for int32 samples
+#define SAMPLE_PIPELINE_HEADROOM_SHIFT (ACCEL_AUTO_RANGE ? ACCEL_RANGE_MAX_SHIFT : 0)
 
 // Event Detection Thresholds (in g) - Optimized for scientific accuracy
 #define THRESHOLD_MICRO 0.001f    // Level 1: Mikrobewegungen (lowered for better sensitivity)
@@ -46,9 +84,97 @@
 #define LTA_WINDOW 2500   // Long-term average window (samples) - 5s at 500Hz
 #define STA_LTA_RATIO 2.5f // Trigger ratio (lowered for better sensitivity)
 
+// Processing Pipeline - stage chain selected per station at compile time
+#define STATION_PROFILE_STANDARD 0        // Spike filter + STA/LTA on the calibrated magnitude
+#define STATION_PROFILE_DRIFT_TOLERANT 1  // DC removal ahead of the magnitude (thermal/tilt drift)
+#define STATION_PROFILE_URBAN 2           // DC removal + band-pass against cultural noise
+#define STATION_PROFILE STATION_PROFILE_STANDARD
+#define PIPELINE_BLOCK_SIZE 16            // Samples per pipeline block call
+#define DC_REMOVAL_CUTOFF_HZ 0.05f        // DC blocker corner frequency
+#define BANDPASS_LOW_HZ 1.0f              // Band-pass lower corner (2nd order Butterworth)
+#define BANDPASS_HIGH_HZ 20.0f            // Band-pass upper corner (2nd order Butterworth)
+
+// Band Energy Monitoring - Goertzel bank over decimated blocks
+#define BAND_DECIMATION 2                 // 500 Hz -> 250 Hz, Nyquist still above mains pickup
+#define BAND_WINDOW_MS 1000               // Energy window (also the Goertzel bin spacing: 1 Hz)
+#define BAND_MAX_BINS 32                  // Goertzel bins across all bands
+#define BAND_MICROSEISM_LOW_HZ 1.0f       // Microseism band (monitor only)
+#define BAND_MICROSEISM_HIGH_HZ 3.0f
+#define BAND_LOCAL_LOW_HZ 5.0f            // Local earthquake band (trigger input)
+#define BAND_LOCAL_HIGH_HZ 15.0f
+#define BAND_MAINS_LOW_HZ 49.0f           // Mains/machinery pickup band (trigger veto)
+#define BAND_MAINS_HIGH_HZ 51.0f
+#define BAND_TRIGGER_RATIO 4.0f           // Trigger band RMS / background to raise a trigger
+#define BAND_VETO_RATIO 2.0f              // Veto band RMS / trigger band RMS to suppress new triggers
+#define BAND_BACKGROUND_ALPHA 0.05f       // Per-window EMA weight of the band background
+#define BAND_MIN_RMS 0.0005f              // Band RMS floor (g) below which trigger/veto never fire
+#define BAND_TRIGGER_ENABLED true         // Use band trigger/veto decisions in event detection
+
+// RSAM/SSAM - 1-minute mean absolute amplitude, computed in the background task
+#define RSAM_INTERVAL_MS 60000            // RSAM/SSAM averaging interval
+#define RSAM_DC_CUTOFF_HZ 0.1f            // DC removal ahead of the amplitude averages
+#define SSAM_BAND_COUNT 5                 // Octave bands starting at SSAM_LOWEST_HZ
+#define SSAM_LOWEST_HZ 0.5f               // 0.5-1, 1-2, 2-4, 4-8, 8-16 Hz
+#define RSAM_HISTORY_SIZE 120             // Minutes kept in RAM for /api/rsam
+#define RSAM_RETENTION_DAYS 30            // Daily archive files in /rsam (~20 KB per day)
+
+// Multi-station coincidence - events are confirmed when k stations trigger
+// within the window (onsets in UTC ms from the SNTP-disciplined system clock)
+#define COINCIDENCE_ENABLED true
+#define COINCIDENCE_STATION_ID ""         // Unique per station on the broker; "" = "seismo-" + last 3 MAC bytes
+#define COINCIDENCE_MIN_STATIONS 2        // k, including this station
+#define COINCIDENCE_WINDOW_MS 3000        // Max onset spread (covers P-wave travel across the network)
+#define COINCIDENCE_MAX_PEERS 8           // Peer stations tracked
+#define COINCIDENCE_ONSET_HISTORY 4       // Recent onsets kept per peer (re-triggers during an event)
+#define COINCIDENCE_PEER_TIMEOUT_MS 60000 // A peer still "on" after this missed its off message
+
+// Early-warning alerts - published on trigger-on, while the event runs and at its end,
+// ahead of all other outbound traffic
+#define ALERT_ENABLED true
+#define ALERT_UPDATE_INTERVAL_MS 500      // Running PGA/magnitude updates while the event is active
+#define ALERT_QUEUE_SIZE 16
+
+// Early magnitude (tau_c / Pd) from the first seconds of the P wave after a refined onset
+#define EARLY_MAG_ENABLED true
+#define EARLY_MAG_WINDOW_MS 3000          // P-wave window analysed from the onset
+#define EARLY_MAG_MIN_WINDOW_MS 1000      // First preliminary estimate after this much P wave
+#define EARLY_MAG_PRETRIGGER_MS 1000      // AIC onset search before the trigger sample
+#define EARLY_MAG_HIGHPASS_HZ 0.075f      // Butterworth high-pass after each integration
+#define EARLY_MAG_DISTANCE_KM 20.0f       // Assumed hypocentral distance for the Pd relation
+#define EARLY_MAG_MIN_PD_CM 0.05f         // Below this Pd the double-integrated sensor noise dominates
+
+// Helicorder - 24 h drum view as min/max per pixel column, built in the background task
+#define HELICORDER_ROW_MINUTES 15         // 96 rows per day
+#define HELICORDER_COLUMN_S 3             // Seconds per pixel column (300 columns per row)
+#define HELICORDER_UNIT_UG 10             // Stored LSB in micro-g (int16 saturates at +-327 mg)
+#define HELICORDER_DC_CUTOFF_HZ 0.05f     // DC removal so traces centre on their row
+#define HELICORDER_FLUSH_COLUMNS 20       // Columns buffered in RAM per flash append (60 s)
+#define HELICORDER_RETENTION_DAYS 2       // Daily files in /heli (~112 KB per day)
+
+// Adaptive-rate waveform archive - full rate around events, a low rate while quiet
+#define ADAPTIVE_RATE_ENABLED 1           // 0 = no waveform archive, WebSocket always at the base rate
+#define ADAPTIVE_QUIET_RATE_HZ 1          // Archive rate while no detector is active (~530 KB per day)
+#define ADAPTIVE_QUIET_STREAM_MS 1000     // WebSocket update interval while quiet
+#define ADAPTIVE_PRETRIGGER_MS 3000       // Full-rate ring archived ahead of each trigger
+#define ADAPTIVE_POSTTRIGGER_MS 2000      // Full rate kept after the detector ends
+#define ADAPTIVE_MAX_EVENT_MS 120000      // Longest full-rate stretch (~3 KB per second at 500 Hz)
+#define WAVEFORM_SEGMENT_SAMPLES 256      // Samples buffered in RAM per segment append
+#define WAVEFORM_RETENTION_DAYS 1         // Daily files in /wave
+
+#if ADAPTIVE_RATE_ENABLED && (SAMPLING_RATE % ADAPTIVE_QUIET_RATE_HZ != 0)
+#error "ADAPTIVE_QUIET_RATE_HZ must divide SAMPLING_RATE"
+#endif
+
+// Synthetic event injection - waveform superimposed on the live sample stream
+#define SYNTHETIC_DEFAULT_SHAPE "quake"   // sine, ricker, chirp, quake
+#define SYNTHETIC_DEFAULT_FREQ_HZ 5.0f    // Dominant frequency
+#define SYNTHETIC_MIN_DURATION_MS 200
+#define SYNTHETIC_MAX_DURATION_MS 60000
+
 // Event Configuration
 #define MIN_EVENT_DURATION 100  // ms
 #define MAX_EVENTS_MEMORY 50    // Maximum events in memory
+#define EVENT_FINALIZER_SLOTS 4 // Ended events waiting in the background task for their coincidence deadline
 
 // Debug Configuration
 #define DEBUG_MODE_TIMEOUT 3600000  // 1 hour in ms
@@ -67,10 +193,21 @@
 #define TIMEZONE_OFFSET 0       // Zero offset for UTC
 
 // Task Configuration
-#define SENSOR_TASK_PRIORITY 3
-#define BACKGROUND_TASK_PRIORITY 1
+// The Wi-Fi driver and lwIP run on core 0 at priorities 18-23, and AsyncTCP
+// (WebSocket) is pinned there by -DCONFIG_ASYNC_TCP_RUNNING_CORE=0 in
+// platformio.ini. Acquisition therefore runs on core 1 above everything else
+// there; the background task takes the slack on core 0. This default follows
+// from the priorities above and has NOT been measured yet: run
+// POST /api/benchmark/topology on the hardware and take its "best" preset.
+#define SENSOR_TASK_CORE 1
+#define SENSOR_TASK_PRIORITY 10
+#define BACKGROUND_TASK_CORE 0
+#define BACKGROUND_TASK_PRIORITY 2
+#define NETWORK_LOOP_PRIORITY 1           // Arduino loop task: MQTT, OTA, NTP (core set by ARDUINO_RUNNING_CORE)
 #define SENSOR_TASK_STACK_SIZE 4096
 #define BACKGROUND_TASK_STACK_SIZE 8192
+#define BACKGROUND_NOTIFY_BATCH 16        // Sensor samples per wake-up of the background task
+#define BACKGROUND_IDLE_WAKE_MS 100       // Wake without notification (finalizer deadlines, stalled sensor)
 
 // Task Watchdog Configuration
 #define TASK_WATCHDOG_TIMEOUT_S 30        // 30 seconds timeout (increased from default 5s)
@@ -80,8 +217,18 @@
 #define MQTT_TASK_STACK_SIZE 6144         // Stack size for MQTT tasks
 
 // Queue Configuration
-#define SENSOR_DATA_QUEUE_SIZE 50
+#define SENSOR_DATA_QUEUE_SIZE (LOW_POWER_MODE ? 176 : 50)  // Low-power mode queues a whole FIFO batch at once
 #define EVENT_QUEUE_SIZE 20
+#define SENSOR_LATE_THRESHOLD_US (ACQUISITION_PERIOD_US * 3 / 2) // Sensor wake-up counted as late
+
+// Topology benchmark - sampling jitter per task topology under synthetic Wi-Fi load
+#define BENCH_SETTLE_MS 2000              // After switching topology, before measuring
+#define BENCH_DEFAULT_MEASURE_MS 20000    // Measurement per topology
+#define BENCH_MAX_MEASURE_MS 300000
+#define BENCH_LOAD_INTERVAL_MS 50         // One burst per interval
+#define BENCH_LOAD_PACKETS 8              // UDP broadcast packets per burst
+#define BENCH_LOAD_PACKET_BYTES 1400
+#define BENCH_LOAD_UDP_PORT 40000
 
 // Web Server Configuration
 #define WEB_SERVER_PORT 80
@@ -99,6 +246,71 @@
 #define OTA_PASSWORD "IhrOTAPasswort"
 #define OTA_PORT 3232
 
+// I2C sensor bus (ESP-IDF master driver, takes over from Wire after setup)
+#define I2C_BUS_PORT I2C_NUM_0
+#define I2C_BUS_FREQUENCY_HZ 400000      // Hz - MPU6050 fast mode
+#define I2C_TRANSACTION_TIMEOUT_MS 5     // Per transaction, counted as timeout when exceeded
+
+// Sensor array: MPU6050s on the same bus (AD0 low = 0x68, AD0 high = 0x69),
+// read back-to-back each sample tick and averaged into one combined channel
+#define SENSOR_COUNT 1
+#define SENSOR_ADDRESSES { 0x68, 0x69 }
+#define ARRAY_CONSISTENCY_G 0.05f        // g - allowed deviation of one sensor from the array consensus
+#define ARRAY_CONSISTENCY_RELATIVE 0.10f // Plus this fraction of the consensus (gain mismatch in strong motion)
+
+#if SENSOR_COUNT < 1 || SENSOR_COUNT > 2
+#error "SENSOR_COUNT: one I2C bus holds at most two MPU6050 (0x68, 0x69)"
+#endif
+
+// Gyroscope as rotational channels (tilt vs. translation in strong motion).
+// 0 compiles them out; at runtime they cost a 14-byte instead of a 6-byte
+// read per sensor only while switched on (/api/gyro, MQTT command "gyro").
+#define GYRO_CHANNELS_ENABLED 1
+#define GYRO_DEFAULT_ON false
+
+// Accelerometer range switching: a sensor whose raw counts reach the clip
+// level steps up one range (±2 -> ±4 -> ±8 -> ±16 g) after the block that
+// clipped; it steps back down once its peak stayed inside the lower range's
+// fraction for the hold time. Samples are normalised to one pipeline unit,
+// so no sample is dropped and filters/STA/LTA never see a scale change.
+#define ACCEL_AUTO_RANGE 1
+#define ACCEL_RANGE_MAX_SHIFT 3           // Highest range ±2 g << shift (3 = ±16 g)
+#define ACCEL_CLIP_COUNTS 32000           // |raw| at or above this counts as clipped
+#define ACCEL_RANGE_DOWN_FRACTION 0.7f    // Step down below this fraction of the lower range (gravity alone is 0.5 at ±2 g)
+#define ACCEL_RANGE_HOLD_MS 10000         // ms - quiet time before stepping down
+
+#if ACCEL_RANGE_MAX_SHIFT < 0 || ACCEL_RANGE_MAX_SHIFT > 3
+#error "ACCEL_RANGE_MAX_SHIFT: MPU6050 ranges are ±2/4/8/16 g (shift 0..3)"
+#endif
+
+// Low-power mode for battery/solar stations: the MPU6050 paces itself
+// (SMPLRT_DIV) and buffers accelerometer reads in its FIFO while the CPU
+// light-sleeps; the sensor task wakes once per batch and runs it through the
+// pipeline as one block. Wi-Fi is off between scheduled uplink windows and in
+// modem sleep during them; a trigger opens a window at once. The MPU6050 has
+// no FIFO watermark interrupt, so a timer sized to the batch wakes the CPU
+// and the FIFO overflow interrupt on MPU6050_INT_PIN is the backstop.
+// Rotational channels are not buffered in this mode.
+#define LOW_POWER_MODE 0
+#define LOW_POWER_BATCH_SAMPLES 100       // Reads per wake-up (the FIFO holds 170 accel reads)
+#define LOW_POWER_FIFO_WAKE true          // Also wake on the FIFO overflow interrupt (MPU6050_INT_PIN)
+#define LOW_POWER_DRAIN_TIMEOUT_MS 50     // Wait for core 0 to drain a batch before sleeping
+#define LOW_POWER_CLOCK_STEP_MS 20        // Batch sample clock re-anchored (a counted gap) beyond this error
+#define LOW_POWER_LOOP_INTERVAL_MS 200    // Arduino loop period (10 ms otherwise)
+#define LOW_POWER_UPLINK_INTERVAL_MS 900000  // Scheduled uplink windows (15 min)
+#define LOW_POWER_UPLINK_WINDOW_MS 30000  // Wi-Fi on per window, and after the last trigger
+// Current estimates for the power report (ESP32 + MPU6050, 3.3 V rail)
+#define LOW_POWER_ACTIVE_MA 40.0f
+#define LOW_POWER_SLEEP_MA 4.5f
+#define LOW_POWER_WIFI_MA 20.0f           // Added while Wi-Fi is on (modem sleep average)
+
+#if LOW_POWER_MODE && (LOW_POWER_BATCH_SAMPLES > 150)
+#error "LOW_POWER_BATCH_SAMPLES: keep a margin below the 170 reads the 1 KB FIFO holds"
+#endif
+#if LOW_POWER_MODE && (8000 % ACQUISITION_RATE != 0 || ACQUISITION_RATE < 32)
+#error "LOW_POWER_MODE paces reads with SMPLRT_DIV: the acquisition rate must divide 8 kHz (32 Hz minimum)"
+#endif
+
 // MPU6050 Constants
 #define MPU6050_ACCEL_SCALE 16384.0f  // LSB/g for ±2g range
 #define MPU6050_GYRO_SCALE 131.0f     // LSB/°/s for ±250°/s range
@@ -110,17 +322,17 @@
 // Spike Filter Constants
 #define SPIKE_MEDIAN_MULTIPLIER 5.0f  // Multiplier for median-based spike detection
 #define SPIKE_THRESHOLD_MULTIPLIER 2.0f // Multiplier for threshold-based spike detection
-#define SPIKE_FILTER_BUFFER_SIZE 5    // Size of magnitude buffer for spike detection
+#define SPIKE_FILTER_BUFFER_SIZE 5    // Running median window (samples, odd; O(log n) per sample)
+#define SPIKE_FILTER_REPLACE_WITH_MEDIAN 0 // 1 = replace spikes by the median (keeps the timeline), 0 = drop them
 
 // Calibration Constants
 #define CALIBRATION_SAMPLES 200       // Number of samples for calibration
 #define STABILITY_CHECK_SAMPLES 50    // Samples for stability check
+#define CALIBRATION_MAX_FAILED_READS_PCT 10 // Failed sensor reads are re-read; calibration fails beyond this share
+#define CALIBRATION_REQUEST_TIMEOUT_MS (SENSOR_COUNT * 6000UL) // Wait for the sensor task to run a requested calibration
 #define MAX_CALIBRATION_STDDEV 0.01f  // Maximum allowed standard deviation during calibration
-#define MAX_XY_OFFSET 0.5f           // Maximum reasonable X/Y axis offset
-#define MIN_Z_OFFSET 0.8f            // Minimum Z-axis offset (gravity)
-#define MAX_Z_OFFSET 1.5f            // Maximum Z-axis offset (gravity)
-#define MIN_Z_VALUE 0.8f             // Minimum Z-axis raw value
-#define MAX_Z_VALUE 1.5f             // Maximum Z-axis raw value
+#define MIN_GRAVITY_MAGNITUDE 0.8f   // Minimum |g| accepted during calibration (any mounting orientation)
+#define MAX_GRAVITY_MAGNITUDE 1.5f   // Maximum |g| accepted during calibration
 
 // Drift Detection Constants
 #define DRIFT_CHECK_INTERVAL 300000   // 5 minutes in ms
@@ -129,4 +341,11 @@
 #define HIGH_BASELINE_THRESHOLD 0.1f  // High baseline warning threshold
 #define MAX_CALIBRATION_AGE 86400000  // 24 hours in ms
 
+// Temperature Compensation (MPU6050 on-die sensor)
+#define TEMP_SAMPLE_INTERVAL 1000            // ms between temperature reads
+#define TEMP_COMP_FORGETTING_FACTOR 0.999994 // Per observation - ~2 day memory at 1 Hz
+#define TEMP_COMP_MIN_OBSERVATIONS 600       // Observations before the model is applied
+#define TEMP_COMP_MIN_SPAN_C 2.0f            // Temperature span required to fit a slope
+#define TEMP_COMP_RESIDUAL_ALPHA 0.01f       // EWMA weight for residual RMS tracking
+
 #endif // CONFIG_H
@@ -13,6 +13,13 @@
 #include "modules/mqtt_handler.h"
 #include "modules/web_server.h"
 #include "modules/time_manager.h"
+#include "modules/amplitude_monitor.h"
+#include "modules/helicorder_recorder.h"
+#include "modules/waveform_recorder.h"
+#include "modules/event_finalizer.h"
+#include "modules/latency_tracer.h"
+#include "modules/topology_benchmark.h"
+#include "modules/power_manager.h"
 #include "utils/led_controller.h"
 
 // Global objects
@@ -22,6 +29,17 @@ DataLogger dataLogger;
 MQTTHandler mqttHandler;
 WebServerManager webServer;
 TimeManager timeManager;
+AmplitudeMonitor amplitudeMonitor;
+HelicorderRecorder helicorder;
+#if ADAPTIVE_RATE_ENABLED
+WaveformRecorder waveformRecorder;
+#endif
+EventFinalizer eventFinalizer;
+LatencyTracer latencyTracer;
+TopologyBenchmark topologyBenchmark;
+#if LOW_POWER_MODE
+PowerManager powerManager;
+#endif
 LEDController ledController;
 
 // Global references for modules
@@ -85,9 +103,42 @@ void setup() {
     seismograph.detailedLoggingEnabled = detailedLoggingEnabled;
     if (detailedLoggingEnabled) Serial.println("Seismograph initialized");
     
+    // Initialize RSAM/SSAM amplitude channels (archive in /rsam)
+    if (!amplitudeMonitor.begin()) {
+        Serial.println("WARNING: RSAM archive unavailable, keeping RAM history only");
+    }
+    amplitudeMonitor.detailedLoggingEnabled = detailedLoggingEnabled;
+    amplitudeMonitor.setTimeManagerReference(&timeManager);
+    
+    // Initialize helicorder (daily files in /heli, starts once NTP time is valid)
+    if (!helicorder.begin()) {
+        Serial.println("WARNING: Helicorder archive unavailable");
+    }
+    helicorder.detailedLoggingEnabled = detailedLoggingEnabled;
+    helicorder.setTimeManagerReference(&timeManager);
+    
+#if ADAPTIVE_RATE_ENABLED
+    // Initialize adaptive-rate waveform archive (segments in /wave, stored once NTP time is valid)
+    waveformRecorder.detailedLoggingEnabled = detailedLoggingEnabled;
+    if (!waveformRecorder.begin()) {
+        Serial.println("WARNING: Waveform archive unavailable");
+    }
+#endif
+    
     // Initialize WiFi
     WiFi.mode(WIFI_STA);
     WiFi.setHostname(HOSTNAME);
+    
+    // Coincidence station id: configured, or unique per board from the MAC,
+    // so stations with default configs do not drop each other's triggers
+    if (strlen(COINCIDENCE_STATION_ID) == 0) {
+        uint8_t mac[6];
+        WiFi.macAddress(mac);
+        char stationId[16];
+        snprintf(stationId, sizeof(stationId), "seismo-%02x%02x%02x", mac[3], mac[4], mac[5]);
+        seismograph.getCoincidenceTrigger().setStationId(stationId);
+    }
+    Serial.printf("Coincidence station id: %s\n", seismograph.getCoincidenceTrigger().getStationId());
     WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
     
     Serial.print("Connecting to WiFi");
@@ -129,6 +180,16 @@ void setup() {
         
         // Set references for web server
         webServer.setReferences(&seismograph, &dataLogger, &mqttHandler, &timeManager);
+        webServer.setAmplitudeMonitorReference(&amplitudeMonitor);
+        webServer.setHelicorderReference(&helicorder);
+#if ADAPTIVE_RATE_ENABLED
+        webServer.setWaveformReference(&waveformRecorder);
+#endif
+        webServer.setLatencyTracerReference(&latencyTracer);
+        webServer.setTopologyBenchmarkReference(&topologyBenchmark);
+#if LOW_POWER_MODE
+        webServer.setPowerManagerReference(&powerManager);
+#endif
         webServer.addHttpEndpoint("/toggle_logging", HTTP_GET, [](AsyncWebServerRequest *request){
             toggleDetailedLogging(request);
         });
@@ -147,6 +208,27 @@ void setup() {
     // Set references for dual core manager
     coreManager.setReferences(&seismograph, &dataLogger, &mqttHandler);
     coreManager.setWebServerReference(&webServer);
+    coreManager.setAmplitudeMonitorReference(&amplitudeMonitor);
+    coreManager.setHelicorderReference(&helicorder);
+#if ADAPTIVE_RATE_ENABLED
+    coreManager.setWaveformReference(&waveformRecorder);
+#endif
+    
+    // Event finalization runs in the background task (core per task topology)
+    eventFinalizer.detailedLoggingEnabled = detailedLoggingEnabled;
+    eventFinalizer.setReferences(&seismograph, &dataLogger, &mqttHandler, &timeManager);
+    eventFinalizer.setWebServerReference(&webServer);
+    eventFinalizer.setLatencyTracerReference(&latencyTracer);
+    coreManager.setEventFinalizerReference(&eventFinalizer);
+    coreManager.setLatencyTracerReference(&latencyTracer);
+    
+#if LOW_POWER_MODE
+    // Duty cycling: FIFO batches and light sleep in the sensor task, uplink
+    // windows in the loop below (setup's connection is the first window)
+    powerManager.detailedLoggingEnabled = detailedLoggingEnabled;
+    powerManager.begin();
+    coreManager.setPowerManagerReference(&powerManager);
+#endif
     
     // Initialize dual core manager (must be last)
     if (!coreManager.begin()) {
@@ -155,6 +237,10 @@ void setup() {
         while(1) delay(1000);
     }
     if (detailedLoggingEnabled) Serial.println("Dual core manager initialized");
+    topologyBenchmark.setReferences(&coreManager, &webServer);
+    
+    // The loop task runs MQTT, OTA and NTP below the sensor task
+    vTaskPrioritySet(NULL, NETWORK_LOOP_PRIORITY);
     
     // System ready
     systemInitialized = true;
@@ -192,6 +278,10 @@ void loop() {
     
     // Update components
     ledController.update(); // Update LED blinking
+    topologyBenchmark.loop();
+#if LOW_POWER_MODE
+    powerManager.loop();
+#endif
     
     if (WiFi.status() == WL_CONNECTED) {
         ArduinoOTA.handle();
@@ -204,8 +294,13 @@ void loop() {
         esp_task_wdt_reset(); // Reset after time manager operations
     }
     
-    // Small delay to prevent watchdog issues
+    // Small delay to prevent watchdog issues; in low-power mode the loop
+    // only has to follow the uplink windows
+#if LOW_POWER_MODE
+    delay(LOW_POWER_LOOP_INTERVAL_MS);
+#else
     delay(10);
+#endif
 }
 
 void performHealthCheck() {
@@ -217,8 +312,12 @@ void performHealthCheck() {
         dataLogger.logEvent("LOW_MEMORY", "Low memory warning", freeHeap);
     }
     
-    // Check WiFi connection
+    // Check WiFi connection (low-power mode: only inside an uplink window)
+#if LOW_POWER_MODE
+    if (WiFi.status() != WL_CONNECTED && powerManager.isUplinkOpen()) {
+#else
     if (WiFi.status() != WL_CONNECTED) {
+#endif
         Serial.println("WARNING: WiFi disconnected");
         // Try to reconnect
         WiFi.reconnect();
@@ -288,10 +387,16 @@ void updateStatusLED() {
 String createStatusJson() {
     // Pre-allocate string buffer for better performance
     String json;
-    json.reserve(512);
+    json.reserve(896);
+    
+    const TemperatureCompensator& tc = seismograph.getTemperatureCompensator();
+    uint32_t latencyP50Us, latencyP95Us, latencyMaxUs;
+    latencyTracer.getEndToEnd(latencyP50Us, latencyP95Us, latencyMaxUs);
+    I2cBusStats busStats;
+    seismograph.getSensorBus().getStats(busStats);
     
     // Use sprintf for more efficient string building
-    char buffer[512];
+    char buffer[896];
     snprintf(buffer, sizeof(buffer),
         "{"
         "\"uptime\":%lu,"
@@ -305,6 +410,14 @@ String createStatusJson() {
         "\"sensor_calibrated\":%s,"
         "\"events_detected\":%lu,"
         "\"last_magnitude\":%.4f,"
+        "\"sensor_temp_c\":%.2f,"
+        "\"temp_comp_active\":%s,"
+        "\"temp_comp_slope\":[%.6f,%.6f,%.6f],"
+        "\"temp_comp_residual_rms\":[%.6f,%.6f,%.6f],"
+        "\"latency_traces\":%lu,"
+        "\"latency_e2e_us\":{\"p50\":%lu,\"p95\":%lu,\"max\":%lu},"
+        "\"i2c_errors\":%lu,"
+        "\"i2c_timeouts\":%lu,"
         "\"ota_enabled\":true"
         "}",
         millis() / 1000,
@@ -317,16 +430,38 @@ String createStatusJson() {
         timeManager.isTimeValid() ? timeManager.getEpochTime() : 0,
         seismograph.isCalibrated() ? "true" : "false",
         seismograph.getEventsDetected(),
-        seismograph.getLastMagnitude()
+        seismograph.getLastMagnitude(),
+        tc.getLastTemp(),
+        tc.isReady() ? "true" : "false",
+        tc.getSlope(0), tc.getSlope(1), tc.getSlope(2),
+        tc.getResidualRms(0), tc.getResidualRms(1), tc.getResidualRms(2),
+        latencyTracer.getTraceCount(),
+        (unsigned long)latencyP50Us, (unsigned long)latencyP95Us, (unsigned long)latencyMaxUs,
+        busStats.errors + busStats.otherErrors,
+        busStats.timeouts
     );
     
     json = buffer;
+#if LOW_POWER_MODE
+    // Power and wake statistics as a nested object
+    json.remove(json.length() - 1);
+    json += ",\"power\":" + powerManager.getStatsJson() + "}";
+#endif
     return json;
 }
 
 void toggleDetailedLogging(AsyncWebServerRequest *request) {
     detailedLoggingEnabled = !detailedLoggingEnabled;
     seismograph.detailedLoggingEnabled = detailedLoggingEnabled;
+    amplitudeMonitor.detailedLoggingEnabled = detailedLoggingEnabled;
+    helicorder.detailedLoggingEnabled = detailedLoggingEnabled;
+#if ADAPTIVE_RATE_ENABLED
+    waveformRecorder.detailedLoggingEnabled = detailedLoggingEnabled;
+#endif
+    eventFinalizer.detailedLoggingEnabled = detailedLoggingEnabled;
+#if LOW_POWER_MODE
+    powerManager.detailedLoggingEnabled = detailedLoggingEnabled;
+#endif
     dataLogger.setDetailedLogging(detailedLoggingEnabled);
     String message = "Detailed logging " + String(detailedLoggingEnabled ? "enabled" : "disabled");
     webServer.send(request, 200, "text/plain", message);
@@ -0,0 +1,254 @@
+#include "amplitude_monitor.h"
+#include <ArduinoJson.h>
+#include "time_manager.h"
+
+static const uint32_t RSAM_INTERVAL_S = RSAM_INTERVAL_MS / 1000;
+
+AmplitudeMonitor::AmplitudeMonitor() : retention("/rsam", RSAM_RETENTION_DAYS) {
+    detailedLoggingEnabled = false;
+    initialized = false;
+    timeManagerRef = nullptr;
+    historyLock = portMUX_INITIALIZER_UNLOCKED;
+
+    dcBlocker.configure(BiquadCoefficients::dcBlocker(SAMPLING_RATE, RSAM_DC_CUTOFF_HZ));
+    for (int band = 0; band < SSAM_BAND_COUNT; band++) {
+        bandHighPass[band].configure(BiquadCoefficients::highPass(SAMPLING_RATE, bandLowHz(band)));
+        bandLowPass[band].configure(BiquadCoefficients::lowPass(SAMPLING_RATE, bandHighHz(band)));
+    }
+
+    rsamSum = 0.0f;
+    for (int band = 0; band < SSAM_BAND_COUNT; band++) ssamSum[band] = 0.0f;
+    sampleCount = 0;
+    intervalEnd = 0;
+    intervalStartEpoch = 0;
+    intervalOpen = false;
+
+    historyIndex = 0;
+    historyCount = 0;
+    recordsArchived = 0;
+    archiveErrors = 0;
+}
+
+bool AmplitudeMonitor::begin() {
+    if (!LittleFS.exists("/rsam") && !LittleFS.mkdir("/rsam")) {
+        Serial.println("ERROR: Failed to create /rsam directory");
+        return false;
+    }
+    initialized = true;
+    if (detailedLoggingEnabled) {
+        Serial.printf("RSAM/SSAM monitor initialized (%lu s intervals, %d SSAM bands, %d days retention)\n",
+                      (unsigned long)RSAM_INTERVAL_S, SSAM_BAND_COUNT, RSAM_RETENTION_DAYS);
+    }
+    return true;
+}
+
+void AmplitudeMonitor::setTimeManagerReference(TimeManager* timeManager) {
+    timeManagerRef = timeManager;
+}
+
+bool AmplitudeMonitor::addSample(float accelZ, unsigned long timestampMs) {
+    bool completed = false;
+    if (!intervalOpen) {
+        openInterval(timestampMs);
+    } else if ((long)(timestampMs - intervalEnd) >= 0) {
+        closeInterval(timestampMs);
+        openInterval(timestampMs);
+        completed = true;
+    }
+
+    float v = dcBlocker.process(accelZ);
+    rsamSum += fabsf(v);
+    for (int band = 0; band < SSAM_BAND_COUNT; band++) {
+        ssamSum[band] += fabsf(bandLowPass[band].process(bandHighPass[band].process(v)));
+    }
+    sampleCount++;
+
+    return completed;
+}
+
+void AmplitudeMonitor::openInterval(unsigned long timestampMs) {
+    rsamSum = 0.0f;
+    for (int band = 0; band < SSAM_BAND_COUNT; band++) ssamSum[band] = 0.0f;
+    sampleCount = 0;
+    intervalOpen = true;
+
+    // Align to wall-clock minutes when NTP time is available
+    if (timeManagerRef != nullptr && timeManagerRef->isTimeValid()) {
+        uint32_t epoch = timeManagerRef->getEpochTime();
+        uint32_t intoInterval = epoch % RSAM_INTERVAL_S;
+        intervalStartEpoch = epoch - intoInterval;
+        intervalEnd = timestampMs + (RSAM_INTERVAL_S - intoInterval) * 1000UL;
+    } else {
+        intervalStartEpoch = 0;
+        intervalEnd = timestampMs + RSAM_INTERVAL_MS;
+    }
+}
+
+void AmplitudeMonitor::closeInterval(unsigned long timestampMs) {
+    if (sampleCount == 0) return;
+
+    RsamRecord record;
+    float scale = 1.0f / sampleCount;
+    record.time = intervalStartEpoch;
+    record.uptimeMs = timestampMs;
+    record.rsam = toMicroG(rsamSum * scale);
+    for (int band = 0; band < SSAM_BAND_COUNT; band++) {
+        record.ssam[band] = toMicroG(ssamSum[band] * scale);
+    }
+    record.samples = sampleCount > 0xFFFF ? 0xFFFF : (uint16_t)sampleCount;
+
+    portENTER_CRITICAL(&historyLock);
+    history[historyIndex] = record;
+    historyIndex = (historyIndex + 1) % RSAM_HISTORY_SIZE;
+    if (historyCount < RSAM_HISTORY_SIZE) historyCount++;
+    portEXIT_CRITICAL(&historyLock);
+
+    // Only wall-clock aligned intervals can be placed in a daily file
+    if (initialized && record.time != 0) {
+        if (archiveRecord(record)) {
+            recordsArchived++;
+        } else {
+            archiveErrors++;
+        }
+        retention.cleanup(record.time / 86400, detailedLoggingEnabled);
+    }
+}
+
+bool AmplitudeMonitor::archiveRecord(const RsamRecord& record) {
+    ArchiveRecord entry;
+    entry.minuteOfDay = (uint16_t)((record.time % 86400) / 60);
+    entry.rsam = record.rsam;
+    for (int band = 0; band < SSAM_BAND_COUNT; band++) entry.ssam[band] = record.ssam[band];
+
+    File file = LittleFS.open(getArchivePath(record.time / 86400), "a");
+    if (!file) return false;
+    size_t written = file.write((const uint8_t*)&entry, sizeof(entry));
+    file.close();
+    return written == sizeof(entry);
+}
+
+uint16_t AmplitudeMonitor::toMicroG(float g) {
+    float ug = g * 1e6f;
+    if (ug <= 0.0f) return 0;
+    if (ug >= 65535.0f) return 0xFFFF;
+    return (uint16_t)(ug + 0.5f);
+}
+
+String AmplitudeMonitor::getArchivePath(uint32_t epochDay) {
+    return "/rsam/" + String(epochDay) + ".bin";
+}
+
+bool AmplitudeMonitor::getLatest(RsamRecord& record) {
+    bool available = false;
+    portENTER_CRITICAL(&historyLock);
+    if (historyCount > 0) {
+        record = history[(historyIndex + RSAM_HISTORY_SIZE - 1) % RSAM_HISTORY_SIZE];
+        available = true;
+    }
+    portEXIT_CRITICAL(&historyLock);
+    return available;
+}
+
+String AmplitudeMonitor::createRecordJson(const RsamRecord& record) {
+    JsonDocument doc;
+    doc["device_id"] = MQTT_CLIENT_ID;
+    doc["time"] = record.time;
+    doc["uptime_ms"] = record.uptimeMs;
+    doc["interval_s"] = RSAM_INTERVAL_S;
+    doc["unit"] = "ug";
+    doc["rsam"] = record.rsam;
+    JsonArray ssam = doc["ssam"].to<JsonArray>();
+    for (int band = 0; band < SSAM_BAND_COUNT; band++) ssam.add(record.ssam[band]);
+    doc["samples"] = record.samples;
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+String AmplitudeMonitor::getHistoryJson(int minutes) {
+    JsonDocument doc;
+    doc["interval_s"] = RSAM_INTERVAL_S;
+    doc["unit"] = "ug";
+    JsonArray bands = doc["ssam_bands_hz"].to<JsonArray>();
+    for (int band = 0; band < SSAM_BAND_COUNT; band++) {
+        JsonArray edges = bands.add<JsonArray>();
+        edges.add(bandLowHz(band));
+        edges.add(bandHighHz(band));
+    }
+
+    // Oldest first; one record copied per lock so the background task is never held up
+    JsonArray records = doc["records"].to<JsonArray>();
+    portENTER_CRITICAL(&historyLock);
+    int available = historyCount;
+    int newest = historyIndex;
+    portEXIT_CRITICAL(&historyLock);
+    int count = constrain(minutes, 1, available);
+
+    for (int i = count; i > 0; i--) {
+        RsamRecord record;
+        portENTER_CRITICAL(&historyLock);
+        record = history[(newest + RSAM_HISTORY_SIZE - i) % RSAM_HISTORY_SIZE];
+        portEXIT_CRITICAL(&historyLock);
+
+        JsonObject entry = records.add<JsonObject>();
+        entry["time"] = record.time;
+        entry["uptime_ms"] = record.uptimeMs;
+        entry["rsam"] = record.rsam;
+        JsonArray ssam = entry["ssam"].to<JsonArray>();
+        for (int band = 0; band < SSAM_BAND_COUNT; band++) ssam.add(record.ssam[band]);
+        entry["samples"] = record.samples;
+    }
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+String AmplitudeMonitor::getDayJson(uint32_t epochDay, int step) {
+    File file = LittleFS.open(getArchivePath(epochDay), "r");
+    if (!file) return "";
+
+    step = constrain(step, 1, 60);
+    JsonDocument doc;
+    doc["date"] = TimeManager::formatEpochDay(epochDay);
+    doc["interval_s"] = RSAM_INTERVAL_S * step;
+    doc["unit"] = "ug";
+    JsonArray bands = doc["ssam_bands_hz"].to<JsonArray>();
+    for (int band = 0; band < SSAM_BAND_COUNT; band++) {
+        JsonArray edges = bands.add<JsonArray>();
+        edges.add(bandLowHz(band));
+        edges.add(bandHighHz(band));
+    }
+    doc["columns"] = "minute_of_day,rsam,ssam...";
+
+    // Rows of [minute, rsam, ssam...], averaged over step consecutive records
+    JsonArray rows = doc["records"].to<JsonArray>();
+    ArchiveRecord entry;
+    uint32_t sums[1 + SSAM_BAND_COUNT];
+    int grouped = 0;
+    uint16_t groupMinute = 0;
+    while (true) {
+        bool haveEntry = file.read((uint8_t*)&entry, sizeof(entry)) == sizeof(entry);
+        if (grouped > 0 && (!haveEntry || grouped == step)) {
+            JsonArray row = rows.add<JsonArray>();
+            row.add(groupMinute);
+            for (int i = 0; i < 1 + SSAM_BAND_COUNT; i++) row.add(sums[i] / grouped);
+            grouped = 0;
+        }
+        if (!haveEntry) break;
+
+        if (grouped == 0) {
+            groupMinute = entry.minuteOfDay;
+            for (int i = 0; i < 1 + SSAM_BAND_COUNT; i++) sums[i] = 0;
+        }
+        sums[0] += entry.rsam;
+        for (int band = 0; band < SSAM_BAND_COUNT; band++) sums[1 + band] += entry.ssam[band];
+        grouped++;
+    }
+    file.close();
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
@@ -0,0 +1,92 @@
+#ifndef AMPLITUDE_MONITOR_H
+#define AMPLITUDE_MONITOR_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <freertos/FreeRTOS.h>
+#include "config.h"
+#include "../utils/archive_retention.h"
+#include "../utils/biquad.h"
+
+// Forward declarations
+class TimeManager;
+
+// One RSAM/SSAM interval. Amplitudes are mean |a| in micro-g, saturating.
+struct RsamRecord {
+    uint32_t time;                    // Epoch seconds of the interval start (0 = no NTP)
+    unsigned long uptimeMs;           // millis() at the interval end
+    uint16_t rsam;                    // Broadband (DC removed) mean absolute amplitude
+    uint16_t ssam[SSAM_BAND_COUNT];   // Band-limited mean absolute amplitudes
+    uint16_t samples;                 // Samples averaged (drops show up here)
+};
+
+// RSAM (real-time seismic amplitude measurement) and SSAM (its band-limited
+// variant) on the vertical channel. Runs in the background task from the sensor queue:
+// per sample one DC blocker plus two biquads per SSAM octave band, and a
+// running |a| sum. Completed intervals go to a RAM history, to daily binary
+// files in /rsam (14 bytes per minute) and out via MQTT.
+class AmplitudeMonitor {
+public:
+    bool detailedLoggingEnabled;
+
+private:
+    // Archive layout: /rsam/<days since 1970>.bin, little-endian uint16 words
+    struct __attribute__((packed)) ArchiveRecord {
+        uint16_t minuteOfDay;
+        uint16_t rsam;
+        uint16_t ssam[SSAM_BAND_COUNT];
+    };
+
+    bool initialized;
+    TimeManager* timeManagerRef;
+
+    // Filters (float: the background task has headroom, poles at 0.1 Hz need the precision)
+    Biquad<FloatSampleFormat> dcBlocker;
+    Biquad<FloatSampleFormat> bandHighPass[SSAM_BAND_COUNT];
+    Biquad<FloatSampleFormat> bandLowPass[SSAM_BAND_COUNT];
+
+    // Current interval
+    float rsamSum;
+    float ssamSum[SSAM_BAND_COUNT];
+    unsigned long sampleCount;
+    unsigned long intervalEnd;
+    uint32_t intervalStartEpoch;
+    bool intervalOpen;
+
+    // Completed intervals
+    RsamRecord history[RSAM_HISTORY_SIZE];
+    int historyIndex;
+    int historyCount;
+    portMUX_TYPE historyLock;
+
+    unsigned long recordsArchived;
+    unsigned long archiveErrors;
+    ArchiveRetention retention;
+
+    void openInterval(unsigned long timestampMs);
+    void closeInterval(unsigned long timestampMs);
+    bool archiveRecord(const RsamRecord& record);
+    static uint16_t toMicroG(float g);
+
+public:
+    AmplitudeMonitor();
+    bool begin();
+    void setTimeManagerReference(TimeManager* timeManager);
+
+    // Background task: feed one calibrated vertical sample (g); true when an interval completed
+    bool addSample(float accelZ, unsigned long timestampMs);
+
+    // Any core
+    bool getLatest(RsamRecord& record);
+    String createRecordJson(const RsamRecord& record);
+    String getHistoryJson(int minutes);
+    String getDayJson(uint32_t epochDay, int step);
+    String getArchivePath(uint32_t epochDay);
+
+    unsigned long getRecordsArchived() { return recordsArchived; }
+    unsigned long getArchiveErrors() { return archiveErrors; }
+    static float bandLowHz(int band) { return SSAM_LOWEST_HZ * (float)(1 << band); }
+    static float bandHighHz(int band) { return SSAM_LOWEST_HZ * (float)(2 << band); }
+};
+
+#endif // AMPLITUDE_MONITOR_H
@@ -0,0 +1,166 @@
+#include "band_energy_monitor.h"
+
+// Decimated rate and window length define the bin spacing: fs / N Hz
+static const float BAND_SAMPLE_RATE = (float)SAMPLING_RATE / BAND_DECIMATION;
+
+BandEnergyMonitor::BandEnergyMonitor() {
+    snapshotLock = portMUX_INITIALIZER_UNLOCKED;
+    windowLength = (int)(BAND_SAMPLE_RATE * BAND_WINDOW_MS / 1000.0f);
+    totalBins = 0;
+    
+    configureBand(0, "microseism", BAND_MICROSEISM_LOW_HZ, BAND_MICROSEISM_HIGH_HZ, BAND_ROLE_MONITOR);
+    configureBand(1, "local", BAND_LOCAL_LOW_HZ, BAND_LOCAL_HIGH_HZ, BAND_ROLE_TRIGGER);
+    configureBand(2, "mains", BAND_MAINS_LOW_HZ, BAND_MAINS_HIGH_HZ, BAND_ROLE_VETO);
+    
+    reset();
+}
+
+void BandEnergyMonitor::configureBand(int index, const char* name, float lowHz, float highHz, BandRole role) {
+    float binHz = BAND_SAMPLE_RATE / windowLength;
+    int first = (int)ceilf(lowHz / binHz);
+    int last = (int)floorf(highHz / binHz);
+    
+    // Keep bins below Nyquist and within the bin budget
+    int nyquistBin = windowLength / 2 - 1;
+    if (last > nyquistBin) last = nyquistBin;
+    if (first < 1) first = 1;
+    int count = last - first + 1;
+    if (count < 0) count = 0;
+    if (totalBins + count > BAND_MAX_BINS) count = BAND_MAX_BINS - totalBins;
+    
+    bands[index].name = name;
+    bands[index].role = role;
+    bands[index].firstBin = totalBins;
+    bands[index].binCount = count;
+    bands[index].lowHz = first * binHz;
+    bands[index].highHz = (first + count - 1) * binHz;
+    
+    for (int i = 0; i < count; i++) {
+        coeff[totalBins + i] = 2.0f * cosf(2.0f * PI * (first + i) / windowLength);
+    }
+    totalBins += count;
+}
+
+void BandEnergyMonitor::reset() {
+    for (int bin = 0; bin < BAND_MAX_BINS; bin++) {
+        for (int axis = 0; axis < 3; axis++) {
+            s1[bin][axis] = 0.0f;
+            s2[bin][axis] = 0.0f;
+        }
+    }
+    decimSum[0] = decimSum[1] = decimSum[2] = 0.0f;
+    decimCount = 0;
+    windowCount = 0;
+    
+    portENTER_CRITICAL(&snapshotLock);
+    for (int band = 0; band < BAND_COUNT; band++) {
+        current.rms[band] = 0.0f;
+        current.background[band] = 0.0f;
+    }
+    current.triggered = false;
+    current.vetoed = false;
+    current.timestamp = 0;
+    current.windows = 0;
+    portEXIT_CRITICAL(&snapshotLock);
+}
+
+bool BandEnergyMonitor::addSample(float x, float y, float z) {
+    decimSum[0] += x;
+    decimSum[1] += y;
+    decimSum[2] += z;
+    if (++decimCount < BAND_DECIMATION) return false;
+    
+    const float scale = 1.0f / BAND_DECIMATION;
+    addDecimated(decimSum[0] * scale, decimSum[1] * scale, decimSum[2] * scale);
+    decimSum[0] = decimSum[1] = decimSum[2] = 0.0f;
+    decimCount = 0;
+    
+    if (++windowCount < windowLength) return false;
+    finishWindow();
+    windowCount = 0;
+    return true;
+}
+
+void BandEnergyMonitor::addDecimated(float x, float y, float z) {
+    // Goertzel recurrence s[n] = x[n] + 2cos(w) s[n-1] - s[n-2]
+    for (int bin = 0; bin < totalBins; bin++) {
+        float c = coeff[bin];
+        float s0x = x + c * s1[bin][0] - s2[bin][0];
+        float s0y = y + c * s1[bin][1] - s2[bin][1];
+        float s0z = z + c * s1[bin][2] - s2[bin][2];
+        s2[bin][0] = s1[bin][0]; s1[bin][0] = s0x;
+        s2[bin][1] = s1[bin][1]; s1[bin][1] = s0y;
+        s2[bin][2] = s1[bin][2]; s1[bin][2] = s0z;
+    }
+}
+
+void BandEnergyMonitor::finishWindow() {
+    // |X_k|^2 = s1^2 + s2^2 - 2cos(w) s1 s2; a bin's mean-square share is 2|X_k|^2 / N^2
+    const float norm = 2.0f / ((float)windowLength * windowLength);
+    float rms[BAND_COUNT];
+    
+    for (int band = 0; band < BAND_COUNT; band++) {
+        float meanSquare = 0.0f;
+        for (int i = 0; i < bands[band].binCount; i++) {
+            int bin = bands[band].firstBin + i;
+            for (int axis = 0; axis < 3; axis++) {
+                float a = s1[bin][axis];
+                float b = s2[bin][axis];
+                meanSquare += (a * a + b * b - coeff[bin] * a * b) * norm;
+                s1[bin][axis] = 0.0f;
+                s2[bin][axis] = 0.0f;
+            }
+        }
+        rms[band] = sqrtf(meanSquare > 0.0f ? meanSquare : 0.0f);
+    }
+    
+    // Trigger and veto decisions against the previous window's background
+    bool triggered = false;
+    bool vetoed = false;
+    float triggerBandRms = 0.0f;
+    for (int band = 0; band < BAND_COUNT; band++) {
+        if (bands[band].role == BAND_ROLE_TRIGGER) {
+            triggerBandRms += rms[band];
+            if (current.windows > 0 && rms[band] > BAND_MIN_RMS &&
+                rms[band] > current.background[band] * BAND_TRIGGER_RATIO) {
+                triggered = true;
+            }
+        }
+    }
+    for (int band = 0; band < BAND_COUNT; band++) {
+        if (bands[band].role == BAND_ROLE_VETO && rms[band] > BAND_MIN_RMS &&
+            rms[band] > triggerBandRms * BAND_VETO_RATIO) {
+            vetoed = true;
+        }
+    }
+    
+    portENTER_CRITICAL(&snapshotLock);
+    for (int band = 0; band < BAND_COUNT; band++) {
+        current.rms[band] = rms[band];
+        // Background only follows quiet windows so an event does not raise its own baseline
+        if (current.windows == 0) {
+            current.background[band] = rms[band];
+        } else if (!triggered) {
+            current.background[band] += BAND_BACKGROUND_ALPHA * (rms[band] - current.background[band]);
+        }
+    }
+    current.triggered = triggered;
+    current.vetoed = vetoed;
+    current.timestamp = millis();
+    current.windows++;
+    portEXIT_CRITICAL(&snapshotLock);
+}
+
+void BandEnergyMonitor::getSnapshot(BandEnergySnapshot& snapshot) {
+    portENTER_CRITICAL(&snapshotLock);
+    snapshot = current;
+    portEXIT_CRITICAL(&snapshotLock);
+}
+
+const char* BandEnergyMonitor::roleName(BandRole role) {
+    switch (role) {
+        case BAND_ROLE_TRIGGER: return "trigger";
+        case BAND_ROLE_VETO: return "veto";
+        default: return "monitor";
+    }
+}
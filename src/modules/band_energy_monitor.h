@@ -0,0 +1,87 @@
+#ifndef BAND_ENERGY_MONITOR_H
+#define BAND_ENERGY_MONITOR_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "config.h"
+
+enum BandRole {
+    BAND_ROLE_MONITOR = 0,  // Reported only
+    BAND_ROLE_TRIGGER = 1,  // Energy jump over its background raises a trigger
+    BAND_ROLE_VETO = 2      // Dominant energy suppresses new triggers (machinery, mains)
+};
+
+#define BAND_COUNT 3
+
+// Per-window result, copied out under a spinlock for readers on the other core
+struct BandEnergySnapshot {
+    float rms[BAND_COUNT];         // Band RMS acceleration over X/Y/Z (g)
+    float background[BAND_COUNT];  // Slow background of the band RMS (g)
+    bool triggered;                // A trigger band exceeded BAND_TRIGGER_RATIO
+    bool vetoed;                   // A veto band dominated the trigger bands
+    unsigned long timestamp;       // millis() at the end of the window
+    unsigned long windows;         // Completed windows since start
+};
+
+// Continuous band energies from a bank of Goertzel detectors. Input is
+// decimated by BAND_DECIMATION (boxcar average) and analysed in windows of
+// BAND_WINDOW_MS; every integer-Hz bin inside a band is one Goertzel
+// recurrence per axis, so a window costs bins * 3 multiply-adds per
+// decimated sample instead of a full FFT.
+class BandEnergyMonitor {
+private:
+    struct Band {
+        const char* name;
+        BandRole role;
+        int firstBin;   // Index into the bin arrays
+        int binCount;
+        float lowHz;    // Centre of the first bin
+        float highHz;   // Centre of the last bin
+    };
+    
+    Band bands[BAND_COUNT];
+    int totalBins;
+    int windowLength;  // Decimated samples per window (N)
+    
+    // Goertzel state per bin and axis
+    float coeff[BAND_MAX_BINS];
+    float s1[BAND_MAX_BINS][3];
+    float s2[BAND_MAX_BINS][3];
+    
+    // Decimation and window progress
+    float decimSum[3];
+    int decimCount;
+    int windowCount;
+    
+    // Published result
+    BandEnergySnapshot current;
+    portMUX_TYPE snapshotLock;
+    
+    void configureBand(int index, const char* name, float lowHz, float highHz, BandRole role);
+    void addDecimated(float x, float y, float z);
+    void finishWindow();
+
+public:
+    BandEnergyMonitor();
+    void reset();
+    
+    // Feeds calibrated samples (g); returns true when a window completed
+    bool addSample(float x, float y, float z);
+    
+    // Sensor-task side: flags from the last completed window
+    bool isTriggered() const { return current.triggered; }
+    bool isVetoed() const { return current.vetoed; }
+    
+    // Any core: consistent copy of the last completed window
+    void getSnapshot(BandEnergySnapshot& snapshot);
+    
+    int getBandCount() const { return BAND_COUNT; }
+    const char* getBandName(int band) const { return bands[band].name; }
+    BandRole getBandRole(int band) const { return bands[band].role; }
+    float getBandLowHz(int band) const { return bands[band].lowHz; }
+    float getBandHighHz(int band) const { return bands[band].highHz; }
+    
+    static const char* roleName(BandRole role);
+};
+
+#endif // BAND_ENERGY_MONITOR_H
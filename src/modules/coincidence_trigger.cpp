@@ -0,0 +1,237 @@
+#include "coincidence_trigger.h"
+
+CoincidenceTrigger::CoincidenceTrigger(const char* id, int required, uint32_t window) {
+    detailedLoggingEnabled = false;
+    setStationId(id);
+    requiredStations = required;
+    windowMs = window;
+
+    peerCount = 0;
+    outboxHead = 0;
+    outboxCount = 0;
+    for (int i = 0; i < SENT_HISTORY; i++) sentMs[i] = 0;
+    sentIndex = 0;
+    lock = portMUX_INITIALIZER_UNLOCKED;
+
+    messagesSent = 0;
+    messagesReceived = 0;
+    messagesRejected = 0;
+    outboxOverflows = 0;
+    confirmedEvents = 0;
+    unconfirmedEvents = 0;
+    idCollisions = 0;
+    lastCollisionWarning = 0;
+}
+
+void CoincidenceTrigger::setStationId(const char* id) {
+    strncpy(stationId, id, MAX_STATION_ID - 1);
+    stationId[MAX_STATION_ID - 1] = '\0';
+    snprintf(topic, sizeof(topic), TOPIC_TRIGGER_FORMAT, stationId);
+}
+
+void CoincidenceTrigger::localTriggerOn(uint64_t utcMs, float ratio) {
+    queueTransition(true, utcMs, ratio);
+}
+
+void CoincidenceTrigger::localTriggerOff(uint64_t utcMs) {
+    queueTransition(false, utcMs, 0.0f);
+}
+
+void CoincidenceTrigger::queueTransition(bool on, uint64_t utcMs, float ratio) {
+    portENTER_CRITICAL(&lock);
+    if (outboxCount == OUTBOX_SIZE) {
+        // Broker unreachable: the newest transitions matter most to peers
+        outboxHead = (outboxHead + 1) % OUTBOX_SIZE;
+        outboxCount--;
+        outboxOverflows++;
+    }
+    Transition& t = outbox[(outboxHead + outboxCount) % OUTBOX_SIZE];
+    t.on = on;
+    t.utcMs = utcMs;
+    t.ratio = ratio;
+    outboxCount++;
+    portEXIT_CRITICAL(&lock);
+}
+
+bool CoincidenceTrigger::popOutgoing(String& payload) {
+    Transition t;
+    portENTER_CRITICAL(&lock);
+    if (outboxCount == 0) {
+        portEXIT_CRITICAL(&lock);
+        return false;
+    }
+    t = outbox[outboxHead];
+    outboxHead = (outboxHead + 1) % OUTBOX_SIZE;
+    outboxCount--;
+    sentMs[sentIndex] = t.utcMs;
+    sentIndex = (sentIndex + 1) % SENT_HISTORY;
+    portEXIT_CRITICAL(&lock);
+
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%s,%d,%llu,%.2f",
+             stationId, t.on ? 1 : 0, (unsigned long long)t.utcMs, t.ratio);
+    payload = buffer;
+    messagesSent++;
+    return true;
+}
+
+CoincidenceTrigger::PeerTrigger* CoincidenceTrigger::findPeer(const char* id) {
+    for (int i = 0; i < peerCount; i++) {
+        if (strcmp(peers[i].id, id) == 0) return &peers[i];
+    }
+    return nullptr;
+}
+
+bool CoincidenceTrigger::wasSent(uint64_t utcMs) {
+    bool sent = false;
+    portENTER_CRITICAL(&lock);
+    for (int i = 0; i < SENT_HISTORY; i++) {
+        if (sentMs[i] == utcMs) sent = true;
+    }
+    portEXIT_CRITICAL(&lock);
+    return sent;
+}
+
+bool CoincidenceTrigger::handlePeerMessage(const char* payload, unsigned int length, unsigned long nowMs) {
+    char buffer[64];
+    if (length == 0 || length >= sizeof(buffer)) {
+        messagesRejected++;
+        return false;
+    }
+    memcpy(buffer, payload, length);
+    buffer[length] = '\0';
+
+    char id[MAX_STATION_ID];
+    int on = 0;
+    unsigned long long utcMs = 0;
+    float ratio = 0.0f;
+    int fields = sscanf(buffer, "%23[^,],%d,%llu,%f", id, &on, &utcMs, &ratio);
+    if (fields < 3 || utcMs == 0) {
+        messagesRejected++;
+        return false;
+    }
+
+    // Own messages come back through the wildcard subscription. Anything
+    // else with our id is a second station configured with the same id,
+    // whose triggers we would otherwise drop without notice.
+    if (strcmp(id, stationId) == 0) {
+        if (wasSent(utcMs)) return false;
+        idCollisions++;
+        if (idCollisions == 1 || nowMs - lastCollisionWarning >= COINCIDENCE_PEER_TIMEOUT_MS) {
+            lastCollisionWarning = nowMs;
+            Serial.printf("WARNING: Another station publishes triggers as '%s' - set a unique COINCIDENCE_STATION_ID\n",
+                          stationId);
+        }
+        return false;
+    }
+
+    portENTER_CRITICAL(&lock);
+    PeerTrigger* peer = findPeer(id);
+    if (peer == nullptr) {
+        if (peerCount < COINCIDENCE_MAX_PEERS) {
+            peer = &peers[peerCount++];
+        } else {
+            // Table full: replace the peer heard from least recently
+            peer = &peers[0];
+            for (int i = 1; i < peerCount; i++) {
+                if ((long)(peers[i].receivedAt - peer->receivedAt) < 0) peer = &peers[i];
+            }
+        }
+        strncpy(peer->id, id, MAX_STATION_ID);
+        peer->active = false;
+        for (int i = 0; i < COINCIDENCE_ONSET_HISTORY; i++) peer->onsets[i] = 0;
+        peer->onsetIndex = 0;
+        peer->offMs = 0;
+        peer->ratio = 0.0f;
+    }
+    if (on) {
+        peer->active = true;
+        // A repeated message (reconnect, QoS retry) carries the same onset
+        int latest = (peer->onsetIndex + COINCIDENCE_ONSET_HISTORY - 1) % COINCIDENCE_ONSET_HISTORY;
+        if (peer->onsets[latest] != utcMs) {
+            peer->onsets[peer->onsetIndex] = utcMs;
+            peer->onsetIndex = (peer->onsetIndex + 1) % COINCIDENCE_ONSET_HISTORY;
+        }
+        peer->ratio = ratio;
+    } else {
+        peer->active = false;
+        peer->offMs = utcMs;
+    }
+    peer->receivedAt = nowMs;
+    messagesReceived++;
+    portEXIT_CRITICAL(&lock);
+
+    if (detailedLoggingEnabled) {
+        Serial.printf("Coincidence: %s trigger %s at %llu (ratio %.2f)\n", id, on ? "ON" : "off", utcMs, ratio);
+    }
+    return true;
+}
+
+int CoincidenceTrigger::countPeersInWindow(uint64_t startMs, uint64_t endMs, char contributing[][MAX_STATION_ID]) {
+    // Caller holds the lock
+    int count = 0;
+    for (int i = 0; i < peerCount; i++) {
+        for (int h = 0; h < COINCIDENCE_ONSET_HISTORY; h++) {
+            uint64_t onMs = peers[i].onsets[h];
+            if (onMs != 0 && onMs >= startMs && onMs <= endMs) {
+                if (contributing != nullptr) memcpy(contributing[count], peers[i].id, MAX_STATION_ID);
+                count++;
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+CoincidenceResult CoincidenceTrigger::evaluate(uint64_t onsetMs) {
+    CoincidenceResult result;
+    result.evaluated = true;
+    result.stations = 1;
+    result.required = requiredStations;
+    result.onsetMs = onsetMs;
+
+    // A window [start, start + windowMs] holding the local onset; the best
+    // one starts at the local onset or at a peer onset before it
+    uint64_t earliest = onsetMs > windowMs ? onsetMs - windowMs : 0;
+    char contributing[COINCIDENCE_MAX_PEERS][MAX_STATION_ID];
+    portENTER_CRITICAL(&lock);
+    uint64_t bestStart = onsetMs;
+    int bestCount = countPeersInWindow(onsetMs, onsetMs + windowMs, nullptr);
+    for (int i = 0; i < peerCount; i++) {
+        for (int h = 0; h < COINCIDENCE_ONSET_HISTORY; h++) {
+            uint64_t start = peers[i].onsets[h];
+            if (start == 0 || start < earliest || start >= onsetMs) continue;
+            int count = countPeersInWindow(start, start + windowMs, nullptr);
+            if (count > bestCount) {
+                bestCount = count;
+                bestStart = start;
+            }
+        }
+    }
+    int contributingCount = countPeersInWindow(bestStart, bestStart + windowMs, contributing);
+    portEXIT_CRITICAL(&lock);
+
+    for (int i = 0; i < contributingCount; i++) {
+        if (i > 0) result.peers += ",";
+        result.peers += contributing[i];
+    }
+    result.stations += contributingCount;
+    result.confirmed = result.stations >= requiredStations;
+
+    if (result.confirmed) {
+        confirmedEvents++;
+    } else {
+        unconfirmedEvents++;
+    }
+    return result;
+}
+
+int CoincidenceTrigger::getActivePeers(unsigned long nowMs) {
+    int active = 0;
+    portENTER_CRITICAL(&lock);
+    for (int i = 0; i < peerCount; i++) {
+        if (peers[i].active && nowMs - peers[i].receivedAt < COINCIDENCE_PEER_TIMEOUT_MS) active++;
+    }
+    portEXIT_CRITICAL(&lock);
+    return active;
+}
@@ -0,0 +1,127 @@
+#ifndef COINCIDENCE_TRIGGER_H
+#define COINCIDENCE_TRIGGER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "config.h"
+
+// Outcome of the coincidence check for one local event
+struct CoincidenceResult {
+    bool evaluated;        // False without disciplined UTC (or coincidence disabled)
+    int stations;          // Stations with an onset inside the window, this one included
+    int required;          // k
+    bool confirmed;        // stations >= required
+    uint64_t onsetMs;      // Local onset, UTC ms
+    String peers;          // Comma-separated ids of the contributing peers
+};
+
+// Network coincidence trigger. Each station announces its trigger on/off
+// transitions; an event is confirmed when at least k stations (this one
+// included) report an onset within COINCIDENCE_WINDOW_MS of each other.
+// The last few onsets of every peer are kept, so a peer that re-triggers
+// during an event still matches with its first onset.
+//
+// The class holds no transport: local transitions queue up in an outbox
+// that the MQTT loop drains (popOutgoing), and received peer messages are
+// passed to handlePeerMessage. Messages are one compact CSV line,
+// "<station>,<1|0>,<utc_ms>,<sta_lta_ratio>", so any broker stand-in can
+// drive several instances on the host.
+class CoincidenceTrigger {
+public:
+    bool detailedLoggingEnabled;
+
+    static const int MAX_STATION_ID = 24;
+    static const int OUTBOX_SIZE = 4;
+    static const int SENT_HISTORY = 8;
+
+private:
+    struct PeerTrigger {
+        char id[MAX_STATION_ID];
+        bool active;               // Last message was a trigger-on
+        uint64_t onsets[COINCIDENCE_ONSET_HISTORY];  // Recent onsets, UTC ms (0 = unused)
+        int onsetIndex;            // Next slot to overwrite
+        uint64_t offMs;            // Last trigger-off, UTC ms
+        float ratio;
+        unsigned long receivedAt;  // Caller clock (millis) of the last message
+    };
+
+    struct Transition {
+        bool on;
+        uint64_t utcMs;
+        float ratio;
+    };
+
+    char stationId[MAX_STATION_ID];
+    char topic[MAX_STATION_ID + 16];
+    int requiredStations;
+    uint32_t windowMs;
+
+    PeerTrigger peers[COINCIDENCE_MAX_PEERS];
+    int peerCount;
+
+    Transition outbox[OUTBOX_SIZE];
+    int outboxHead;
+    int outboxCount;
+
+    // Our last published transitions, to tell the broker echo of our own
+    // messages from another station using the same id
+    uint64_t sentMs[SENT_HISTORY];
+    int sentIndex;
+
+    portMUX_TYPE lock;
+
+    unsigned long messagesSent;
+    unsigned long messagesReceived;
+    unsigned long messagesRejected;
+    unsigned long outboxOverflows;
+    unsigned long confirmedEvents;
+    unsigned long unconfirmedEvents;
+    unsigned long idCollisions;
+    unsigned long lastCollisionWarning;
+
+    void queueTransition(bool on, uint64_t utcMs, float ratio);
+    PeerTrigger* findPeer(const char* id);
+    bool wasSent(uint64_t utcMs);
+    int countPeersInWindow(uint64_t startMs, uint64_t endMs, char contributing[][MAX_STATION_ID]);
+
+public:
+    CoincidenceTrigger(const char* id = COINCIDENCE_STATION_ID,
+                       int required = COINCIDENCE_MIN_STATIONS,
+                       uint32_t window = COINCIDENCE_WINDOW_MS);
+
+    // Station id and the topic derived from it (TOPIC_TRIGGER_FORMAT); set
+    // before the MQTT connection when COINCIDENCE_STATION_ID is empty
+    void setStationId(const char* id);
+
+    // Sensor task: local trigger transitions in UTC ms
+    void localTriggerOn(uint64_t utcMs, float ratio);
+    void localTriggerOff(uint64_t utcMs);
+
+    // Transport side (MQTT loop): next message to publish on getTopic()
+    bool popOutgoing(String& payload);
+    // A message from TOPIC_TRIGGER_PEERS. The echo of our own messages is
+    // ignored; any other message carrying our id is counted as a collision.
+    bool handlePeerMessage(const char* payload, unsigned int length, unsigned long nowMs);
+
+    // Largest set of stations, this one included, with one onset each inside
+    // a common window of windowMs around onsetMs. Decide no earlier than
+    // confirmationDeadline() so late peers are counted.
+    CoincidenceResult evaluate(uint64_t onsetMs);
+    uint64_t confirmationDeadline(uint64_t onsetMs) const { return onsetMs + windowMs; }
+
+    // Status
+    int getActivePeers(unsigned long nowMs);
+    int getKnownPeers() { return peerCount; }
+    const char* getStationId() const { return stationId; }
+    const char* getTopic() const { return topic; }
+    int getRequiredStations() const { return requiredStations; }
+    uint32_t getWindowMs() const { return windowMs; }
+    unsigned long getMessagesSent() { return messagesSent; }
+    unsigned long getMessagesReceived() { return messagesReceived; }
+    unsigned long getMessagesRejected() { return messagesRejected; }
+    unsigned long getConfirmedEvents() { return confirmedEvents; }
+    unsigned long getUnconfirmedEvents() { return unconfirmedEvents; }
+    unsigned long getIdCollisions() { return idCollisions; }
+};
+
+#endif // COINCIDENCE_TRIGGER_H
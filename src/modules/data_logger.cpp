@@ -169,6 +169,17 @@ bool DataLogger::logSeismicEvent(const SeismicEventData& eventData) {
     classification["richter_range"] = eventData.richterRange;
     classification["confidence"] = eventData.confidence;
     
+    // Coincidence section (network confirmation)
+    JsonObject coincidence = doc["coincidence"].to<JsonObject>();
+    coincidence["evaluated"] = eventData.coincidenceEvaluated;
+    coincidence["stations"] = eventData.coincidenceStations;
+    coincidence["required"] = eventData.coincidenceRequired;
+    coincidence["confirmed"] = eventData.coincidenceConfirmed;
+    if (eventData.coincidenceEvaluated) {
+        coincidence["onset_utc_ms"] = eventData.onsetUtcMs;
+        coincidence["peers"] = eventData.coincidencePeers;
+    }
+    
     // Measurements section
     JsonObject measurements = doc["measurements"].to<JsonObject>();
     measurements["pga_g"] = eventData.pgaG;
@@ -183,6 +194,13 @@ bool DataLogger::logSeismicEvent(const SeismicEventData& eventData) {
     sensorData["max_accel_x"] = eventData.maxAccelX;
     sensorData["max_accel_y"] = eventData.maxAccelY;
     sensorData["max_accel_z"] = eventData.maxAccelZ;
+    sensorData["accel_range_g"] = eventData.accelRangeG;
+    sensorData["clipped"] = eventData.clipped;
+#if GYRO_CHANNELS_ENABLED
+    sensorData["max_rate_x_dps"] = eventData.maxRateX;
+    sensorData["max_rate_y_dps"] = eventData.maxRateY;
+    sensorData["max_rate_z_dps"] = eventData.maxRateZ;
+#endif
     sensorData["vector_magnitude"] = eventData.vectorMagnitude;
     sensorData["calibration_valid"] = eventData.calibrationValid;
     sensorData["calibration_age_hours"] = eventData.calibrationAgeHours;
@@ -293,7 +311,8 @@ bool DataLogger::logSystemEvent(const String& eventType, const String& descripti
     return true;
 }
 
-bool DataLogger::logSensorData(float accelX, float accelY, float accelZ, float magnitude) {
+bool DataLogger::logSensorData(float accelX, float accelY, float accelZ, float magnitude, const float* rates,
+                               float rangeG) {
     if (!initialized) return false;
     
     // Only log sensor data periodically to avoid filling storage
@@ -311,6 +330,12 @@ bool DataLogger::logSensorData(float accelX, float accelY, float accelZ, float m
     doc["accel_y"] = accelY;
     doc["accel_z"] = accelZ;
     doc["magnitude"] = magnitude;
+    if (rangeG > 0.0f) doc["range_g"] = rangeG;
+    if (rates != nullptr) {
+        doc["gyro_x"] = rates[0];
+        doc["gyro_y"] = rates[1];
+        doc["gyro_z"] = rates[2];
+    }
     
     String jsonString;
     serializeJson(doc, jsonString);
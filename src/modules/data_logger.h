@@ -30,6 +30,14 @@ struct SeismicEventData {
     String richterRange;
     float confidence;
     
+    // Multi-station coincidence
+    bool coincidenceEvaluated;
+    int coincidenceStations;
+    int coincidenceRequired;
+    bool coincidenceConfirmed;
+    String coincidencePeers;
+    uint64_t onsetUtcMs;
+    
     // Measurements
     float pgaG;
     float richterMagnitude;
@@ -42,6 +50,13 @@ struct SeismicEventData {
     float maxAccelX;
     float maxAccelY;
     float maxAccelZ;
+    float accelRangeG;           // Highest accelerometer range during the event
+    bool clipped;                // Sensor clipped: peaks are lower bounds
+#if GYRO_CHANNELS_ENABLED
+    float maxRateX;              // Peak |rate| per axis (deg/s), 0 with gyro off
+    float maxRateY;
+    float maxRateZ;
+#endif
     float vectorMagnitude;
     bool calibrationValid;
     float calibrationAgeHours;
@@ -87,7 +102,10 @@ public:
     bool logEvent(const String& eventType, const String& description, float magnitude);
     bool logSeismicEvent(const SeismicEventData& eventData);
     bool logSystemEvent(const String& eventType, const String& description, float value);
-    bool logSensorData(float accelX, float accelY, float accelZ, float magnitude);
+    // rates: angular rate X/Y/Z in deg/s, or nullptr without gyro channels
+    // rangeG: accelerometer range the sample was read with (0 = not recorded)
+    bool logSensorData(float accelX, float accelY, float accelZ, float magnitude, const float* rates = nullptr,
+                       float rangeG = 0.0f);
     String getEventsJson(int maxEvents = 50);
     String getSeismicEventsJson(int maxEvents = 50);
     String getSystemEventsJson(int maxEvents = 50);
@@ -1,27 +1,97 @@
 #include "dual_core_manager.h"
+#include <esp_timer.h>
 #include "seismograph.h"
 #include "data_logger.h"
 #include "mqtt_handler.h"
 #include "web_server.h"
+#include "amplitude_monitor.h"
+#include "helicorder_recorder.h"
+#include "waveform_recorder.h"
+#include "event_finalizer.h"
+#include "latency_tracer.h"
+#include "power_manager.h"
 
 // Global instance for task access
 DualCoreManager* globalCoreManager = nullptr;
 
+// Sample clock ISR state: timestamp of the latest tick and the task to wake
+static portMUX_TYPE sampleTickLock = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint64_t sampleTickUs = 0;
+static TaskHandle_t volatile sampleTaskHandle = nullptr;
+
+#if LOW_POWER_MODE
+// FIFO batch buffers (sensor task): raw reads per sensor and the calibrated
+// samples they produce
+static const size_t FIFO_CAPACITY_READS = I2cSensorBus::MPU6050_FIFO_BYTES / 6;
+static int16_t fifoRaw[3 * SENSOR_COUNT * FIFO_CAPACITY_READS];
+static SensorData fifoSamples[FIFO_CAPACITY_READS];
+#endif
+
+static void IRAM_ATTR onSampleTimer() {
+    portENTER_CRITICAL_ISR(&sampleTickLock);
+    sampleTickUs = (uint64_t)esp_timer_get_time();
+    portEXIT_CRITICAL_ISR(&sampleTickLock);
+    
+    BaseType_t woken = pdFALSE;
+    if (sampleTaskHandle != nullptr) vTaskNotifyGiveFromISR(sampleTaskHandle, &woken);
+    if (woken == pdTRUE) portYIELD_FROM_ISR();
+}
+
 DualCoreManager::DualCoreManager() {
     detailedLoggingEnabled = false;
     sensorTaskHandle = nullptr;
     backgroundTaskHandle = nullptr;
+    topology = configuredTopology();
+    stopTasks = false;
+    sampleTimer = nullptr;
+    missedSampleTicks = 0;
+    sampleTimerStalls = 0;
+    maxWakeLatencyUs = 0;
     sensorDataQueue = nullptr;
     eventQueue = nullptr;
+    alertQueue = nullptr;
     
     sensorTaskCount = 0;
     backgroundTaskCount = 0;
     lastStatsUpdate = 0;
     
+    lastSensorWakeUs = 0;
+    maxSensorPeriodUs = 0;
+    maxSensorProcessingUs = 0;
+    minSensorPeriodUs = UINT32_MAX;
+    sensorJitterSumUs = 0;
+    sensorPeriods = 0;
+    sensorBusyUs = 0;
+    sensorTimingStartUs = 0;
+    sensorTimingEndUs = 0;
+    lateSensorIterations = 0;
+    sensorQueueDrops = 0;
+    maxEventPeriodUs = 0;
+    maxEventProcessingUs = 0;
+    lateEventIterations = 0;
+    eventIterations = 0;
+    eventQueueDrops = 0;
+    alertQueueDrops = 0;
+    alertsPublished = 0;
+    samplesSinceNotify = 0;
+    backgroundIdleWakeups = 0;
+    backgroundIdle = false;
+    lastBatchUs = 0;
+    nextBatchT0Us = 0;
+    lastFifoRestarts = 0;
+    sampleClockGaps = 0;
+    calibrationState = CALIBRATION_IDLE;
+    
     seismographRef = nullptr;
     dataLoggerRef = nullptr;
     mqttHandlerRef = nullptr;
     webServerRef = nullptr;
+    amplitudeMonitorRef = nullptr;
+    helicorderRef = nullptr;
+    waveformRef = nullptr;
+    eventFinalizerRef = nullptr;
+    latencyTracerRef = nullptr;
+    powerManagerRef = nullptr;
     
     initialized = false;
     globalCoreManager = this;
@@ -44,53 +114,155 @@ bool DualCoreManager::begin() {
         return false;
     }
     
-    // Create sensor task on Core 0 (high priority)
+    alertQueue = xQueueCreate(ALERT_QUEUE_SIZE, sizeof(AlertPacket));
+    if (alertQueue == nullptr) {
+        Serial.println("ERROR: Failed to create alert queue");
+        vQueueDelete(sensorDataQueue);
+        vQueueDelete(eventQueue);
+        return false;
+    }
+    
+    topology = configuredTopology();
+    if (!startTasks()) {
+        vQueueDelete(sensorDataQueue);
+        vQueueDelete(eventQueue);
+        vQueueDelete(alertQueue);
+        return false;
+    }
+    
+    initialized = true;
+    if (detailedLoggingEnabled) {
+        Serial.println("Dual Core Manager initialized successfully");
+        Serial.printf("Sensor task running on Core %d, priority %d\n", (int)topology.sensorCore, (int)topology.sensorPriority);
+        Serial.printf("Background task running on Core %d, priority %d\n", (int)topology.backgroundCore, (int)topology.backgroundPriority);
+    }
+    
+    return true;
+}
+
+bool DualCoreManager::startTasks() {
+    stopTasks = false;
+    if (!startSensorTask()) return false;
+    if (!startBackgroundTask()) {
+        vTaskDelete(sensorTaskHandle);
+        sensorTaskHandle = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool DualCoreManager::startSensorTask() {
+    // Sensor task: sample clock and detection, above everything on its core
     BaseType_t result = xTaskCreatePinnedToCore(
         sensorTask,                 // Task function
         "SensorTask",               // Task name
         SENSOR_TASK_STACK_SIZE,     // Stack size
         this,                       // Parameter
-        SENSOR_TASK_PRIORITY,       // Priority
-        &sensorTaskHandle,          // Task handle
-        0                           // Core 0
+        topology.sensorPriority,    // Priority
+        (TaskHandle_t*)&sensorTaskHandle, // Task handle
+        topology.sensorCore         // Core
     );
     
     if (result != pdPASS) {
         Serial.println("ERROR: Failed to create sensor task");
-        vQueueDelete(sensorDataQueue);
-        vQueueDelete(eventQueue);
+        sensorTaskHandle = nullptr;
         return false;
     }
-    
-    // Create background task on Core 1 (lower priority)
-    result = xTaskCreatePinnedToCore(
+    return true;
+}
+
+bool DualCoreManager::startBackgroundTask() {
+    // Background task: logging, publishing, event finalization
+    BaseType_t result = xTaskCreatePinnedToCore(
         backgroundTask,             // Task function
         "BackgroundTask",           // Task name
         BACKGROUND_TASK_STACK_SIZE, // Stack size
         this,                       // Parameter
-        BACKGROUND_TASK_PRIORITY,   // Priority
-        &backgroundTaskHandle,      // Task handle
-        1                           // Core 1
+        topology.backgroundPriority, // Priority
+        (TaskHandle_t*)&backgroundTaskHandle, // Task handle
+        topology.backgroundCore     // Core
     );
     
     if (result != pdPASS) {
         Serial.println("ERROR: Failed to create background task");
-        vTaskDelete(sensorTaskHandle);
-        vQueueDelete(sensorDataQueue);
-        vQueueDelete(eventQueue);
+        backgroundTaskHandle = nullptr;
         return false;
     }
+    return true;
+}
+
+bool DualCoreManager::restartMissingTasks() {
+    // Whichever task already exited is recreated on the current topology;
+    // one that is still running carries on now that stopTasks is clear
+    stopTasks = false;
+    bool ok = true;
+    if (sensorTaskHandle == nullptr) {
+        resetSensorTiming();
+        ok = startSensorTask() && ok;
+    }
+    if (backgroundTaskHandle == nullptr) ok = startBackgroundTask() && ok;
+    return ok;
+}
+
+bool DualCoreManager::applyTopology(const TaskTopology& newTopology) {
+    if (!initialized) return false;
     
-    initialized = true;
-    if (detailedLoggingEnabled) {
-        Serial.println("Dual Core Manager initialized successfully");
-        Serial.printf("Sensor task running on Core 0, priority %d\n", SENSOR_TASK_PRIORITY);
-        Serial.printf("Background task running on Core 1, priority %d\n", BACKGROUND_TASK_PRIORITY);
+    // Both tasks leave their loops at the next iteration and delete themselves,
+    // so neither is stopped halfway through an I2C read or a flash write
+    stopTasks = true;
+    notifyBackground(NOTIFY_SAMPLES);
+    unsigned long waitStart = millis();
+    while (sensorTaskHandle != nullptr || backgroundTaskHandle != nullptr) {
+        if (millis() - waitStart > 1000) {
+            // One task may have exited already: bring it back as it was
+            bool restored = restartMissingTasks();
+            Serial.printf("ERROR: Tasks did not stop - topology '%s' kept%s\n",
+                          topology.name, restored ? "" : ", task restart FAILED");
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    
+    TaskTopology previous = topology;
+    topology = newTopology;
+    resetSensorTiming();
+    if (!startTasks()) {
+        // startTasks() leaves no task behind: restart both on the old layout
+        topology = previous;
+        bool restored = restartMissingTasks();
+        Serial.printf("ERROR: Topology '%s' could not be started - back to '%s'%s\n",
+                      newTopology.name, topology.name, restored ? "" : ", task restart FAILED");
+        return false;
     }
     
+    Serial.printf("Task topology '%s': sensor core %d prio %d, background core %d prio %d\n",
+                  topology.name, (int)topology.sensorCore, (int)topology.sensorPriority,
+                  (int)topology.backgroundCore, (int)topology.backgroundPriority);
     return true;
 }
 
+const TaskTopology& DualCoreManager::configuredTopology() {
+    static const TaskTopology configured = {
+        "configured", SENSOR_TASK_CORE, SENSOR_TASK_PRIORITY, BACKGROUND_TASK_CORE, BACKGROUND_TASK_PRIORITY
+    };
+    return configured;
+}
+
+const TaskTopology* DualCoreManager::getTopologyPresets(int& count) {
+    static const TaskTopology presets[] = {
+        // Original layout: acquisition shares core 0 with Wi-Fi/lwIP
+        { "legacy_pro_core",     0, 3,  1, 1 },
+        // Acquisition alone on the application core above the loop task
+        { "app_core",            1, 10, 0, 2 },
+        // Both manager tasks on the application core
+        { "app_core_shared",     1, 10, 1, 2 },
+        // Acquisition on core 0 above lwIP (18) but below the Wi-Fi driver (23)
+        { "pro_core_above_lwip", 0, 19, 1, 1 }
+    };
+    count = sizeof(presets) / sizeof(presets[0]);
+    return presets;
+}
+
 void DualCoreManager::setReferences(Seismograph* seismo, DataLogger* logger, MQTTHandler* mqtt) {
     seismographRef = seismo;
     dataLoggerRef = logger;
@@ -101,6 +273,30 @@ void DualCoreManager::setWebServerReference(WebServerManager* webServer) {
     webServerRef = webServer;
 }
 
+void DualCoreManager::setAmplitudeMonitorReference(AmplitudeMonitor* monitor) {
+    amplitudeMonitorRef = monitor;
+}
+
+void DualCoreManager::setHelicorderReference(HelicorderRecorder* helicorder) {
+    helicorderRef = helicorder;
+}
+
+void DualCoreManager::setWaveformReference(WaveformRecorder* waveform) {
+    waveformRef = waveform;
+}
+
+void DualCoreManager::setEventFinalizerReference(EventFinalizer* finalizer) {
+    eventFinalizerRef = finalizer;
+}
+
+void DualCoreManager::setLatencyTracerReference(LatencyTracer* tracer) {
+    latencyTracerRef = tracer;
+}
+
+void DualCoreManager::setPowerManagerReference(PowerManager* power) {
+    powerManagerRef = power;
+}
+
 void DualCoreManager::sensorTask(void* parameter) {
     DualCoreManager* manager = static_cast<DualCoreManager*>(parameter);
     manager->runSensorTask();
@@ -112,103 +308,498 @@ void DualCoreManager::backgroundTask(void* parameter) {
 }
 
 void DualCoreManager::runSensorTask() {
-    if (detailedLoggingEnabled) Serial.println("Sensor task started on Core 0");
+    if (detailedLoggingEnabled) Serial.printf("Sensor task started on Core %d\n", xPortGetCoreID());
     
-    TickType_t lastWakeTime = xTaskGetTickCount();
-    const TickType_t frequency = pdMS_TO_TICKS(SAMPLING_INTERVAL);
+    // The sensor task alone talks to the sensors from here on
+    if (seismographRef != nullptr) seismographRef->getSensorBus().setOwner(xTaskGetCurrentTaskHandle());
     
-    while (true) {
-        sensorTaskCount++;
-        
-        // Read sensor data if seismograph is available
-        if (seismographRef != nullptr) {
-            SensorData data = seismographRef->readSensor();
+#if LOW_POWER_MODE
+    if (powerManagerRef != nullptr && seismographRef != nullptr && seismographRef->startFifo()) {
+        // Low power: the sensors pace and buffer the reads, the task wakes
+        // (from light sleep between uplink windows) once per batch
+        lastBatchUs = (uint64_t)esp_timer_get_time();
+        nextBatchT0Us = 0;
+        lastFifoRestarts = seismographRef->getFifoRestarts();
+        while (!stopTasks) {
+            serviceCalibration();
+            acquireBatch();
+        }
+        seismographRef->stopFifo();
+        seismographRef->getSensorBus().setOwner(nullptr);
+        sensorTaskHandle = nullptr;
+        vTaskDelete(NULL);
+        return;
+    }
+    if (powerManagerRef != nullptr) Serial.println("WARNING: MPU6050 FIFO unavailable - sampling without low-power mode");
+#endif
+    
+    if (SAMPLING_CLOCK_TIMER && startSampleTimer()) {
+        // Hardware clock: the ISR timestamps the tick, the task reads the sensor
+        while (!stopTasks) {
+            // Ticks that fired during a calibration are not missed samples
+            if (serviceCalibration()) ulTaskNotifyTake(pdTRUE, 0);
+            uint32_t ticks = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SAMPLING_TIMER_STALL_MS));
+            if (ticks == 0) {
+                sampleTimerStalls++;
+                continue;
+            }
+            uint64_t wakeUs = (uint64_t)esp_timer_get_time();
+            if (ticks > 1) missedSampleTicks += ticks - 1;
             
-            // Process the data
-            seismographRef->processData(data);
+            portENTER_CRITICAL(&sampleTickLock);
+            uint64_t tickUs = sampleTickUs;
+            portEXIT_CRITICAL(&sampleTickLock);
             
-            // Send data to background task via queue
-            SensorDataPacket packet;
-            packet.accelX = data.accelX;
-            packet.accelY = data.accelY;
-            packet.accelZ = data.accelZ;
-            packet.magnitude = data.magnitude;
-            packet.timestamp = data.timestamp;
+            uint32_t latencyUs = (uint32_t)(wakeUs - tickUs);
+            if (latencyUs > maxWakeLatencyUs) maxWakeLatencyUs = latencyUs;
+            acquireSample(wakeUs, tickUs);
+        }
+        stopSampleTimer();
+    } else {
+        // Tick clock: whole milliseconds only, jitters by up to one tick
+        TickType_t lastWakeTime = xTaskGetTickCount();
+        const TickType_t frequency = pdMS_TO_TICKS(SAMPLING_INTERVAL);
+        
+        while (!stopTasks) {
+            // Resume on the current tick, not with a burst of catch-up reads
+            if (serviceCalibration()) lastWakeTime = xTaskGetTickCount();
+            uint64_t wakeUs = (uint64_t)esp_timer_get_time();
+            acquireSample(wakeUs, wakeUs);
             
-            sendSensorData(packet);
+            // Wait for next sampling interval
+            vTaskDelayUntil(&lastWakeTime, frequency);
         }
+    }
+    
+    if (seismographRef != nullptr) seismographRef->getSensorBus().setOwner(nullptr);
+    sensorTaskHandle = nullptr;
+    vTaskDelete(NULL);
+}
+
+bool DualCoreManager::serviceCalibration() {
+    // Between blocks, so no block is read or processed with half-updated
+    // calibration; an event in progress finishes first
+    if (calibrationState != CALIBRATION_REQUESTED || seismographRef == nullptr) return false;
+    if (seismographRef->isEventActive()) return false;
+    calibrationState = CALIBRATION_RUNNING;
+    bool ok = seismographRef->calibrate();
+    calibrationState = ok ? CALIBRATION_PASSED : CALIBRATION_FAILED;
+    lastSensorWakeUs = 0;   // The pause is not a late sample period
+    return true;
+}
+
+bool DualCoreManager::calibrateSensors() {
+    if (seismographRef == nullptr) return false;
+    if (sensorTaskHandle == nullptr) return seismographRef->calibrate();
+    if (calibrationState == CALIBRATION_REQUESTED || calibrationState == CALIBRATION_RUNNING) {
+        Serial.println("WARNING: Calibration already in progress");
+        return false;
+    }
+    
+    calibrationState = CALIBRATION_REQUESTED;
+    unsigned long waitStart = millis();
+    while (calibrationState == CALIBRATION_REQUESTED || calibrationState == CALIBRATION_RUNNING) {
+        if (millis() - waitStart > CALIBRATION_REQUEST_TIMEOUT_MS) {
+            Serial.println("ERROR: Sensor task did not complete the calibration in time");
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+    return calibrationState == CALIBRATION_PASSED;
+}
+
+void DualCoreManager::acquireSample(uint64_t wakeUs, uint64_t sampleUs) {
+    sensorTaskCount++;
+    bool duringEvent = false;
+    
+    // Read sensor data if seismograph is available (one triple per array sensor)
+    int16_t xyz[3 * SENSOR_COUNT];
+    int16_t* gyro = nullptr;
+#if GYRO_CHANNELS_ENABLED
+    int16_t gyroRaw[3 * SENSOR_COUNT];
+    if (seismographRef != nullptr && seismographRef->isGyroEnabled()) gyro = gyroRaw;
+#endif
+    uint8_t sensorMask = seismographRef != nullptr ? seismographRef->readRawSample(xyz, gyro) : 0;
+    if (sensorMask != 0) {
+        // Synthetic test waveform, if one is armed, rides on the real sample
+        seismographRef->injectSynthetic(xyz, 1);
+        
+        // An event ending in this sample still counts as during the event
+        duringEvent = seismographRef->isEventActive();
         
-        // Wait for next sampling interval
-        vTaskDelayUntil(&lastWakeTime, frequency);
+        // Process the read (block of one until burst reads are available);
+        // with oversampling only every OVERSAMPLE_FACTOR-th read yields a sample
+        size_t produced = seismographRef->processBlock(xyz, 1, sampleUs, sensorMask, gyro);
+        duringEvent |= seismographRef->isEventActive();
+        if (produced == 0) {
+            recordSensorTiming(wakeUs, (uint64_t)esp_timer_get_time(), duringEvent);
+            return;
+        }
+        sendSample(seismographRef->getLastSample(), duringEvent, gyro != nullptr);
+    }
+    
+    recordSensorTiming(wakeUs, (uint64_t)esp_timer_get_time(), duringEvent);
+}
+
+void DualCoreManager::sendSample(const SensorData& data, bool duringEvent, bool hasRates) {
+    // Send data to background task via queue
+    SensorDataPacket packet;
+    packet.accelX = data.accelX;
+    packet.accelY = data.accelY;
+    packet.accelZ = data.accelZ;
+    packet.rangeShift = data.rangeShift;
+    packet.eventActive = duringEvent;
+#if GYRO_CHANNELS_ENABLED
+    packet.rateX = data.rateX;
+    packet.rateY = data.rateY;
+    packet.rateZ = data.rateZ;
+    packet.hasRates = hasRates;
+#endif
+    packet.timestamp = data.timestamp;
+    
+    if (!sendSensorData(packet)) sensorQueueDrops++;
+}
+
+#if LOW_POWER_MODE
+void DualCoreManager::acquireBatch() {
+    // Wait until the FIFO holds a batch: light sleep while the uplink is
+    // closed and the background task has drained the previous batch, a task
+    // delay otherwise
+    uint64_t dueUs = lastBatchUs + LOW_POWER_BATCH_SAMPLES * (uint64_t)ACQUISITION_PERIOD_US;
+    int64_t waitUs = (int64_t)(dueUs - (uint64_t)esp_timer_get_time());
+    if (waitUs > 0) {
+        if (powerManagerRef->canSleep() && waitForBackground()) {
+            powerManagerRef->lightSleep((uint64_t)waitUs);
+        } else {
+            if (powerManagerRef->canSleep()) powerManagerRef->recordSkippedSleep();
+            waitUs = (int64_t)(dueUs - (uint64_t)esp_timer_get_time());
+            if (waitUs > 0) vTaskDelay(pdMS_TO_TICKS(waitUs / 1000) > 0 ? pdMS_TO_TICKS(waitUs / 1000) : 1);
+        }
+    }
+    
+    uint64_t wakeUs = (uint64_t)esp_timer_get_time();
+    lastBatchUs = wakeUs;
+    sensorTaskCount++;
+    
+    uint8_t sensorMask;
+    bool overflow;
+    size_t count = seismographRef->readFifoBatch(fifoRaw, FIFO_CAPACITY_READS, sensorMask, overflow);
+    
+    // A FIFO restart (overflow, resync, failed read) loses reads: the batch
+    // read before it still follows on, the next one starts a new sequence
+    bool restarted = seismographRef->getFifoRestarts() != lastFifoRestarts;
+    lastFifoRestarts = seismographRef->getFifoRestarts();
+    if (restarted) sampleClockGaps++;
+    if (count == 0) {
+        if (restarted) nextBatchT0Us = 0;
+        return;
+    }
+    powerManagerRef->recordBatch(count);
+    
+    // Batches are contiguous on a running sample clock, however late the
+    // task woke. The wake time (the newest read is at most one period old)
+    // only slews it against the sensor's clock error, or re-anchors it
+    // after lost reads.
+    const uint64_t batchUs = count * (uint64_t)ACQUISITION_PERIOD_US;
+    uint64_t anchorUs = wakeUs - batchUs;
+    uint64_t t0 = nextBatchT0Us;
+    int64_t errorUs = (int64_t)(anchorUs - t0);
+    if (t0 == 0 || errorUs > LOW_POWER_CLOCK_STEP_MS * 1000LL || errorUs < -LOW_POWER_CLOCK_STEP_MS * 1000LL) {
+        if (t0 != 0) sampleClockGaps++;
+        t0 = anchorUs;
+    } else {
+        t0 += errorUs / 16;
+    }
+    nextBatchT0Us = restarted ? 0 : t0 + batchUs;
+    
+    seismographRef->injectSynthetic(fifoRaw, count);
+    bool duringEvent = seismographRef->isEventActive();
+    size_t produced = seismographRef->processBlock(fifoRaw, count, t0, sensorMask, nullptr, fifoSamples);
+    duringEvent |= seismographRef->isEventActive();
+    
+    for (size_t i = 0; i < produced; i++) {
+        sendSample(fifoSamples[i], duringEvent, false);
+    }
+    samplesSinceNotify = 0;
+    notifyBackground(NOTIFY_SAMPLES);
+    
+    // Alerts and the event record need the uplink
+    if (duringEvent) powerManagerRef->requestUplink();
+    
+    // Batch period and jitter are the sensor's; only the load is tracked
+    uint64_t doneUs = (uint64_t)esp_timer_get_time();
+    if (sensorTimingStartUs == 0) sensorTimingStartUs = wakeUs;
+    sensorBusyUs += doneUs - wakeUs;
+    sensorTimingEndUs = doneUs;
+}
+
+bool DualCoreManager::waitForBackground() {
+    // Light sleep stalls core 0 as well: let the background task finish the
+    // batch (queue empty, task back in its notification wait) first
+    uint64_t deadlineUs = (uint64_t)esp_timer_get_time() + LOW_POWER_DRAIN_TIMEOUT_MS * 1000ULL;
+    while (uxQueueMessagesWaiting(sensorDataQueue) > 0 || !backgroundIdle) {
+        if ((uint64_t)esp_timer_get_time() >= deadlineUs) return false;
+        vTaskDelay(1);
+    }
+    return true;
+}
+#endif
+
+bool DualCoreManager::startSampleTimer() {
+    // 1 MHz timer (80 MHz APB / 80); the interrupt is allocated on the
+    // calling core, i.e. next to the sensor task
+    sampleTaskHandle = xTaskGetCurrentTaskHandle();
+    sampleTimer = timerBegin(SAMPLING_TIMER_NUMBER, 80, true);
+    if (sampleTimer == nullptr) {
+        Serial.println("ERROR: Sample timer unavailable - falling back to the tick clock");
+        sampleTaskHandle = nullptr;
+        return false;
+    }
+    timerAttachInterrupt(sampleTimer, &onSampleTimer, true);
+    timerAlarmWrite(sampleTimer, ACQUISITION_PERIOD_US, true);
+    timerAlarmEnable(sampleTimer);
+    return true;
+}
+
+void DualCoreManager::stopSampleTimer() {
+    if (sampleTimer == nullptr) return;
+    
+    timerAlarmDisable(sampleTimer);
+    timerDetachInterrupt(sampleTimer);
+    timerEnd(sampleTimer);
+    sampleTimer = nullptr;
+    sampleTaskHandle = nullptr;
+}
+
+void DualCoreManager::recordSensorTiming(uint64_t wakeUs, uint64_t doneUs, bool duringEvent) {
+    uint32_t processingUs = (uint32_t)(doneUs - wakeUs);
+    uint32_t periodUs = lastSensorWakeUs != 0 ? (uint32_t)(wakeUs - lastSensorWakeUs) : 0;
+    lastSensorWakeUs = wakeUs;
+    bool late = periodUs > SENSOR_LATE_THRESHOLD_US;
+    
+    // Busy share of the sensor core since the last reset
+    if (sensorTimingStartUs == 0) sensorTimingStartUs = wakeUs;
+    sensorBusyUs += processingUs;
+    sensorTimingEndUs = doneUs;
+    
+    if (periodUs != 0) {
+        sensorJitterSumUs += periodUs > ACQUISITION_PERIOD_US ? periodUs - ACQUISITION_PERIOD_US : ACQUISITION_PERIOD_US - periodUs;
+        sensorPeriods++;
+        if (periodUs < minSensorPeriodUs) minSensorPeriodUs = periodUs;
+    }
+    if (periodUs > maxSensorPeriodUs) maxSensorPeriodUs = periodUs;
+    if (processingUs > maxSensorProcessingUs) maxSensorProcessingUs = processingUs;
+    if (late) lateSensorIterations++;
+    
+    if (duringEvent) {
+        eventIterations++;
+        if (periodUs > maxEventPeriodUs) maxEventPeriodUs = periodUs;
+        if (processingUs > maxEventProcessingUs) maxEventProcessingUs = processingUs;
+        if (late) lateEventIterations++;
     }
 }
 
+void DualCoreManager::resetSensorTiming() {
+    lastSensorWakeUs = 0;
+    maxSensorPeriodUs = 0;
+    maxSensorProcessingUs = 0;
+    minSensorPeriodUs = UINT32_MAX;
+    sensorJitterSumUs = 0;
+    sensorPeriods = 0;
+    sensorBusyUs = 0;
+    sensorTimingStartUs = 0;
+    sensorTimingEndUs = 0;
+    lateSensorIterations = 0;
+    sensorQueueDrops = 0;
+    missedSampleTicks = 0;
+    maxWakeLatencyUs = 0;
+}
+
 void DualCoreManager::runBackgroundTask() {
-    if (detailedLoggingEnabled) Serial.println("Background task started on Core 1");
+    if (detailedLoggingEnabled) Serial.printf("Background task started on Core %d\n", xPortGetCoreID());
     
     SensorDataPacket sensorData;
-    EventPacket eventData;
     
-    while (true) {
+    while (!stopTasks) {
+        // Sleep until a producer signals work: alerts and events immediately,
+        // samples once per BACKGROUND_NOTIFY_BATCH. The timeout only covers
+        // finalizer deadlines and a stalled sensor task.
+        uint32_t bits = 0;
+        backgroundIdle = true;
+        if (xTaskNotifyWait(0, UINT32_MAX, &bits, pdMS_TO_TICKS(BACKGROUND_IDLE_WAKE_MS)) != pdTRUE) {
+            backgroundIdleWakeups++;
+        }
+        backgroundIdle = false;
         backgroundTaskCount++;
         
-        // Process sensor data from queue
-        if (receiveSensorData(sensorData, pdMS_TO_TICKS(10))) {
-            // Log sensor data if data logger is available
-            if (dataLoggerRef != nullptr) {
-                dataLoggerRef->logSensorData(sensorData.accelX, sensorData.accelY, 
-                                           sensorData.accelZ, sensorData.magnitude);
+        // Early-warning alerts go out ahead of all other outbound traffic,
+        // ended events right after them
+        serviceAlerts();
+        serviceEvents();
+        
+        // Drain the sensor queue: every sample feeds the amplitude channels, the
+        // helicorder and the waveform archive, only the newest one goes to the
+        // logger, MQTT and WebSocket
+        bool haveSample = false;
+        while (receiveSensorData(sensorData, 0)) {
+            haveSample = true;
+            float vertical = SampleFormat::toG(sensorData.accelZ);
+            if (helicorderRef != nullptr) {
+                helicorderRef->addSample(vertical, sensorData.timestamp);
             }
-            
-            // Send data via MQTT if handler is available (using scheduled intervals)
-            if (mqttHandlerRef != nullptr && mqttHandlerRef->isConnected()) {
-                String dataJson = mqttHandlerRef->createDataJson(sensorData.accelX, sensorData.accelY,
-                                                                sensorData.accelZ, sensorData.magnitude);
-                mqttHandlerRef->publishDataSummary(dataJson);
+            if (waveformRef != nullptr) {
+                waveformRef->addSample(SampleFormat::toG(sensorData.accelX), SampleFormat::toG(sensorData.accelY),
+                                       vertical, sensorData.timestamp, sensorData.eventActive);
             }
-            
-            // Update WebSocket clients with real-time sensor data
-            if (webServerRef != nullptr) {
-                webServerRef->updateSensorData(sensorData.accelX, sensorData.accelY, 
-                                             sensorData.accelZ, sensorData.magnitude);
+            if (amplitudeMonitorRef != nullptr &&
+                amplitudeMonitorRef->addSample(vertical, sensorData.timestamp)) {
+                RsamRecord record;
+                if (mqttHandlerRef != nullptr && mqttHandlerRef->isConnected() &&
+                    amplitudeMonitorRef->getLatest(record)) {
+                    mqttHandlerRef->publish(TOPIC_RSAM, amplitudeMonitorRef->createRecordJson(record));
+                }
             }
+            serviceAlerts();
+            serviceEvents();
         }
         
-        // Process events from queue
-        if (receiveEvent(eventData, pdMS_TO_TICKS(10))) {
-            // Log event if data logger is available
+        if (haveSample) {
+            float accelX = SampleFormat::toG(sensorData.accelX);
+            float accelY = SampleFormat::toG(sensorData.accelY);
+            float accelZ = SampleFormat::toG(sensorData.accelZ);
+            float magnitude = sqrtf(accelX * accelX + accelY * accelY + accelZ * accelZ);
+            
+            // Rotational channels ride along only while the gyro is read
+            const float* rates = nullptr;
+#if GYRO_CHANNELS_ENABLED
+            float rateValues[3] = { sensorData.rateX, sensorData.rateY, sensorData.rateZ };
+            if (sensorData.hasRates) rates = rateValues;
+#endif
+            
+            // Log sensor data if data logger is available
             if (dataLoggerRef != nullptr) {
-                dataLoggerRef->logEvent(eventData.eventType, "Seismic event detected", eventData.magnitude);
+                dataLoggerRef->logSensorData(accelX, accelY, accelZ, magnitude, rates, (float)(2 << sensorData.rangeShift));
             }
             
-            // Send event via MQTT if handler is available
+            // Send data via MQTT if handler is available (using scheduled intervals)
             if (mqttHandlerRef != nullptr && mqttHandlerRef->isConnected()) {
-                String eventJson = mqttHandlerRef->createEventJson(eventData.eventType, 
-                                                                 eventData.magnitude, eventData.level);
-                mqttHandlerRef->publishEvent(eventJson);
+                String dataJson = mqttHandlerRef->createDataJson(accelX, accelY, accelZ, magnitude, rates);
+                mqttHandlerRef->publishDataSummary(dataJson);
             }
             
-            // Send seismic event to WebSocket clients
+            // Update WebSocket clients with real-time sensor data, slowed
+            // down with the archive while no detector is active
             if (webServerRef != nullptr) {
-                webServerRef->sendSeismicEvent(eventData.eventType, eventData.magnitude, eventData.level);
+                if (waveformRef != nullptr) webServerRef->setFullRateStreaming(waveformRef->isFullRate());
+                webServerRef->updateSensorData(accelX, accelY, accelZ, magnitude, rates);
             }
         }
         
-        // Small delay to prevent watchdog issues
-        vTaskDelay(pdMS_TO_TICKS(1));
+        // Events held for their coincidence deadline
+        if (eventFinalizerRef != nullptr) {
+            eventFinalizerRef->loop();
+        }
+    }
+    
+    backgroundTaskHandle = nullptr;
+    vTaskDelete(NULL);
+}
+
+void DualCoreManager::notifyBackground(uint32_t bits) {
+    if (backgroundTaskHandle != nullptr) {
+        xTaskNotify(backgroundTaskHandle, bits, eSetBits);
+    }
+}
+
+void DualCoreManager::serviceEvents() {
+    // Ended events from the sensor core: the finalizer classifies, logs,
+    // publishes and broadcasts them once their coincidence deadline passed
+    if (eventFinalizerRef == nullptr) return;
+    
+    EventPacket event;
+    while (receiveEvent(event, 0)) {
+        eventFinalizerRef->submit(event);
+    }
+}
+
+void DualCoreManager::serviceAlerts() {
+    AlertPacket alert;
+    while (receiveAlert(alert, 0)) {
+        publishAlert(alert);
+    }
+}
+
+void DualCoreManager::publishAlert(const AlertPacket& alert) {
+    static const char* const kinds[] = { "trigger_on", "update", "summary" };
+    
+    // Compact, fixed layout; snprintf keeps the fast path free of JSON documents
+    char buffer[420];
+    snprintf(buffer, sizeof(buffer),
+        "{\"type\":\"alert\",\"kind\":\"%s\",\"device_id\":\"%s\",\"trace_id\":%lu,\"seq\":%u,"
+        "\"onset_utc_ms\":%llu,\"elapsed_ms\":%lu,\"pga_g\":%.5f,\"magnitude\":%.2f,"
+        "\"magnitude_method\":\"%s\",\"tau_c\":%.3f,\"pd_cm\":%.5f,\"p_window_ms\":%u,"
+        "\"level\":%d,\"sta_lta\":%.2f,\"injected\":%s}",
+        kinds[alert.kind], MQTT_CLIENT_ID, (unsigned long)alert.traceId, alert.sequence,
+        (unsigned long long)alert.onsetUtcMs, (unsigned long)alert.elapsedMs, alert.pgaG, alert.magnitude,
+        alert.earlyMagnitude ? "tau_c_pd" : "pga", alert.tauC, alert.pdCm, alert.pWindowMs,
+        alert.level, alert.triggerRatio, alert.injected ? "true" : "false");
+    String payload = buffer;
+    
+    bool published = false;
+    if (mqttHandlerRef != nullptr && mqttHandlerRef->isConnected()) {
+        published = mqttHandlerRef->publish(TOPIC_ALERT, payload);
+    }
+    if (webServerRef != nullptr && webServerRef->broadcastAlert(payload)) {
+        published = true;
+    }
+    
+    if (published) {
+        alertsPublished++;
+        if (alert.kind == ALERT_TRIGGER_ON && latencyTracerRef != nullptr && alert.triggerUs != 0) {
+            latencyTracerRef->recordAlert((uint32_t)((uint64_t)esp_timer_get_time() - alert.triggerUs));
+        }
     }
 }
 
 bool DualCoreManager::sendSensorData(const SensorDataPacket& data) {
     if (sensorDataQueue == nullptr) return false;
     
-    return xQueueSend(sensorDataQueue, &data, 0) == pdTRUE;
+    bool sent = xQueueSend(sensorDataQueue, &data, 0) == pdTRUE;
+    
+    // One wake-up per batch; a full queue wakes the consumer at once
+    if (++samplesSinceNotify >= BACKGROUND_NOTIFY_BATCH || !sent) {
+        samplesSinceNotify = 0;
+        notifyBackground(NOTIFY_SAMPLES);
+    }
+    return sent;
 }
 
 bool DualCoreManager::sendEvent(const EventPacket& event) {
     if (eventQueue == nullptr) return false;
     
-    return xQueueSend(eventQueue, &event, 0) == pdTRUE;
+    if (xQueueSend(eventQueue, &event, 0) != pdTRUE) {
+        eventQueueDrops++;
+        return false;
+    }
+    notifyBackground(NOTIFY_EVENT);
+    return true;
+}
+
+bool DualCoreManager::sendAlert(const AlertPacket& alert) {
+    if (alertQueue == nullptr) return false;
+    
+    if (xQueueSend(alertQueue, &alert, 0) != pdTRUE) {
+        alertQueueDrops++;
+        return false;
+    }
+    notifyBackground(NOTIFY_ALERT);
+    return true;
+}
+
+bool DualCoreManager::receiveAlert(AlertPacket& alert, TickType_t timeout) {
+    if (alertQueue == nullptr) return false;
+    
+    return xQueueReceive(alertQueue, &alert, timeout) == pdTRUE;
 }
 
 bool DualCoreManager::receiveSensorData(SensorDataPacket& data, TickType_t timeout) {
@@ -242,7 +833,7 @@ void DualCoreManager::printStats() {
         
         if (backgroundTaskCount > 0) {
             float backgroundRate = (float)backgroundTaskCount / (currentTime / 1000.0f);
-            Serial.printf("Background task rate: %.2f Hz\n", backgroundRate);
+            Serial.printf("Background task rate: %.2f Hz (%lu idle wake-ups)\n", backgroundRate, backgroundIdleWakeups);
         }
         
         // Queue statistics
@@ -252,12 +843,29 @@ void DualCoreManager::printStats() {
             Serial.printf("Sensor queue: %d waiting, %d free\n", sensorQueueWaiting, sensorQueueSpaces);
         }
         
+        if (alertQueue != nullptr) {
+            Serial.printf("Alert queue: %d waiting, %lu published, %lu dropped\n",
+                          uxQueueMessagesWaiting(alertQueue), alertsPublished, alertQueueDrops);
+        }
+        
         if (eventQueue != nullptr) {
             UBaseType_t eventQueueWaiting = uxQueueMessagesWaiting(eventQueue);
             UBaseType_t eventQueueSpaces = uxQueueSpacesAvailable(eventQueue);
             Serial.printf("Event queue: %d waiting, %d free\n", eventQueueWaiting, eventQueueSpaces);
         }
         
+        // Sensor task timing (continuity during events)
+        Serial.printf("Sensor timing (%s, %d Hz reads): max period %lu us, mean jitter %.1f us, max processing %lu us, load %.1f%%, %lu late, %lu queue drops\n",
+                      topology.name, ACQUISITION_RATE, (unsigned long)maxSensorPeriodUs, getMeanSensorJitterUs(),
+                      (unsigned long)maxSensorProcessingUs, getSensorLoadPercent(), lateSensorIterations, sensorQueueDrops);
+        if (sampleTimer != nullptr) {
+            Serial.printf("Sample clock: hardware timer, max wake latency %lu us, %lu missed ticks, %lu stalls\n",
+                          (unsigned long)maxWakeLatencyUs, missedSampleTicks, sampleTimerStalls);
+        }
+        Serial.printf("During events: %lu iterations, max period %lu us, max processing %lu us, %lu late, %lu event drops\n",
+                      eventIterations, (unsigned long)maxEventPeriodUs, (unsigned long)maxEventProcessingUs,
+                      lateEventIterations, eventQueueDrops);
+        
         // Task stack usage
         if (sensorTaskHandle != nullptr) {
             UBaseType_t sensorStackHighWater = uxTaskGetStackHighWaterMark(sensorTaskHandle);
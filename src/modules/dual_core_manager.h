@@ -6,50 +6,182 @@
 #include <freertos/task.h>
 #include <freertos/queue.h>
 #include "config.h"
+#include "../utils/sample_format.h"
 
 // Forward declarations
 class Seismograph;
 class DataLogger;
 class MQTTHandler;
 class WebServerManager;
+class AmplitudeMonitor;
+class HelicorderRecorder;
+class WaveformRecorder;
+class EventFinalizer;
+class LatencyTracer;
+class PowerManager;
+struct SensorData;
 
+// Queue item in SampleFormat units - converted to g on the consumer core
 struct SensorDataPacket {
-    float accelX;
-    float accelY;
-    float accelZ;
-    float magnitude;
+    SampleFormat::Sample accelX;
+    SampleFormat::Sample accelY;
+    SampleFormat::Sample accelZ;
+    uint8_t rangeShift;          // Accel range of the sample's block (±2 g << shift)
+    bool eventActive;            // A detector was active for this sample
+#if GYRO_CHANNELS_ENABLED
+    float rateX;                 // Angular rate, Z-up frame (deg/s); 0 with gyro off
+    float rateY;
+    float rateZ;
+    bool hasRates;
+#endif
     unsigned long timestamp;
 };
 
+// Raw state of an ended event, handed from the sensor task to the event
+// finalizer in the background task. Plain data only: the queue copies it bytewise.
 struct EventPacket {
-    String eventType;
-    float magnitude;
+    unsigned long startMs;       // Trigger sample on the boot clock (ms)
+    unsigned long durationMs;
+    float maxMagnitude;          // Peak vector magnitude (g)
+    float avgMagnitude;
+    int sampleCount;
+    float peakAccel[3];          // Peak |a| per axis, Z-up frame (g)
+    float accelRangeG;           // Highest accelerometer range used during the event
+    bool clipped;                // A sensor clipped: peaks are lower bounds
+#if GYRO_CHANNELS_ENABLED
+    float peakRate[3];           // Peak |rate| per axis (deg/s); 0 with gyro off
+#endif
+    float triggerRatio;          // STA/LTA ratio at the end of the event
+    float backgroundNoise;
+    bool calibrationValid;
+    float calibrationAgeHours;
+    uint64_t onsetUtcMs;         // 0 without disciplined UTC (or simulated)
+    bool injected;               // Triggered by a synthetic waveform
+    
+    // Latency trace (esp_timer us), see LatencyTracer
+    uint32_t traceId;
+    uint64_t triggerUs;          // Trigger sample
+    uint64_t handoffUs;          // Queued by the sensor task
+    uint64_t dequeueUs;          // Taken by the background task
+};
+
+// Early-warning alert, sent on the alert queue ahead of everything else
+enum AlertKind : uint8_t {
+    ALERT_TRIGGER_ON = 0,   // First sample over the trigger
+    ALERT_UPDATE,           // Running values while the event is active
+    ALERT_SUMMARY           // Event ended (the full record follows from the finalizer)
+};
+
+struct AlertPacket {
+    AlertKind kind;
+    bool injected;
+    uint16_t sequence;           // Per event, starting at 0 with the trigger-on
+    uint32_t traceId;            // Same id as the event's latency trace
+    uint64_t onsetUtcMs;         // 0 without disciplined UTC
+    uint64_t triggerUs;          // esp_timer time of the trigger sample
+    uint32_t elapsedMs;          // Since the onset
+    float pgaG;                  // Running peak vector acceleration
+    float magnitude;             // Preliminary magnitude (tau_c/Pd when earlyMagnitude, else PGA)
     int level;
-    unsigned long timestamp;
+    float triggerRatio;
+    bool earlyMagnitude;
+    uint16_t pWindowMs;          // P wave analysed for tau_c/Pd
+    float tauC;                  // Predominant period (s)
+    float pdCm;                  // Peak vertical displacement (cm)
+};
+
+// Core and priority of the two manager tasks
+struct TaskTopology {
+    const char* name;
+    BaseType_t sensorCore;
+    UBaseType_t sensorPriority;
+    BaseType_t backgroundCore;
+    UBaseType_t backgroundPriority;
 };
 
+// Direct-to-task notification bits for the background task
+#define NOTIFY_ALERT   (1UL << 0)
+#define NOTIFY_EVENT   (1UL << 1)
+#define NOTIFY_SAMPLES (1UL << 2)
+
 class DualCoreManager {
 public:
     bool detailedLoggingEnabled;
 private:
-    // Task handles
-    TaskHandle_t sensorTaskHandle;
-    TaskHandle_t backgroundTaskHandle;
+    // Task handles (cleared by the tasks themselves when they stop)
+    TaskHandle_t volatile sensorTaskHandle;
+    TaskHandle_t volatile backgroundTaskHandle;
+    TaskTopology topology;
+    volatile bool stopTasks;
+    
+    // Calibration requested from another task, run by the sensor task
+    // between blocks (it owns the sensor bus and the calibration state)
+    enum CalibrationState : uint8_t {
+        CALIBRATION_IDLE = 0,
+        CALIBRATION_REQUESTED,
+        CALIBRATION_RUNNING,
+        CALIBRATION_PASSED,
+        CALIBRATION_FAILED
+    };
+    volatile uint8_t calibrationState;
+    
+    // Hardware sample clock (SAMPLING_CLOCK_TIMER)
+    hw_timer_t* sampleTimer;
+    unsigned long missedSampleTicks;  // Ticks that fired while the previous sample was still running
+    unsigned long sampleTimerStalls;
+    uint32_t maxWakeLatencyUs;        // Timer ISR to sensor task running
     
     // Queues for inter-core communication
     QueueHandle_t sensorDataQueue;
     QueueHandle_t eventQueue;
+    QueueHandle_t alertQueue;
     
     // Task statistics
     unsigned long sensorTaskCount;
     unsigned long backgroundTaskCount;
     unsigned long lastStatsUpdate;
     
+    // Sensor task timing (esp_timer µs); the event figures cover only
+    // iterations while an event is active, to verify sample continuity
+    uint64_t lastSensorWakeUs;
+    uint32_t maxSensorPeriodUs;
+    uint32_t maxSensorProcessingUs;
+    uint32_t minSensorPeriodUs;
+    uint64_t sensorJitterSumUs;       // Sum of |period - ACQUISITION_PERIOD_US|
+    unsigned long sensorPeriods;
+    uint64_t sensorBusyUs;            // Wake to done, summed (core load)
+    uint64_t sensorTimingStartUs;
+    uint64_t sensorTimingEndUs;
+    unsigned long lateSensorIterations;
+    unsigned long sensorQueueDrops;
+    uint32_t maxEventPeriodUs;
+    uint32_t maxEventProcessingUs;
+    unsigned long lateEventIterations;
+    unsigned long eventIterations;
+    unsigned long eventQueueDrops;
+    unsigned long alertQueueDrops;
+    unsigned long alertsPublished;
+    
+    // Background task wake-ups (notification driven)
+    uint32_t samplesSinceNotify;      // Sensor task side
+    unsigned long backgroundIdleWakeups;
+    volatile bool backgroundIdle;     // In its notification wait (low-power mode sleeps only then)
+    uint64_t lastBatchUs;             // Low-power mode: last FIFO batch
+    uint64_t nextBatchT0Us;           // Running sample clock: time of the next FIFO read, 0 = unanchored
+    unsigned long lastFifoRestarts;
+    unsigned long sampleClockGaps;    // FIFO restarts and clock errors beyond LOW_POWER_CLOCK_STEP_MS
+    
     // References to other modules
     Seismograph* seismographRef;
     DataLogger* dataLoggerRef;
     MQTTHandler* mqttHandlerRef;
     WebServerManager* webServerRef;
+    AmplitudeMonitor* amplitudeMonitorRef;
+    HelicorderRecorder* helicorderRef;
+    WaveformRecorder* waveformRef;
+    EventFinalizer* eventFinalizerRef;
+    LatencyTracer* latencyTracerRef;
+    PowerManager* powerManagerRef;
     
     bool initialized;
     
@@ -60,23 +192,86 @@ private:
     // Instance methods called by static functions
     void runSensorTask();
     void runBackgroundTask();
+    void recordSensorTiming(uint64_t wakeUs, uint64_t doneUs, bool duringEvent);
+    void acquireSample(uint64_t wakeUs, uint64_t sampleUs);
+    void sendSample(const SensorData& data, bool duringEvent, bool hasRates);
+#if LOW_POWER_MODE
+    void acquireBatch();
+    bool waitForBackground();
+#endif
+    bool startSampleTimer();
+    void stopSampleTimer();
+    bool startTasks();
+    bool startSensorTask();
+    bool startBackgroundTask();
+    bool restartMissingTasks();
+    void notifyBackground(uint32_t bits);
+    bool serviceCalibration();
+    void serviceAlerts();
+    void serviceEvents();
+    void publishAlert(const AlertPacket& alert);
 
 public:
     DualCoreManager();
     bool begin();
     void setReferences(Seismograph* seismo, DataLogger* logger, MQTTHandler* mqtt);
     void setWebServerReference(WebServerManager* webServer);
+    void setAmplitudeMonitorReference(AmplitudeMonitor* monitor);
+    void setHelicorderReference(HelicorderRecorder* helicorder);
+    void setWaveformReference(WaveformRecorder* waveform);
+    void setEventFinalizerReference(EventFinalizer* finalizer);
+    void setLatencyTracerReference(LatencyTracer* tracer);
+    void setPowerManagerReference(PowerManager* power);
     
     // Queue operations
     bool sendSensorData(const SensorDataPacket& data);
     bool sendEvent(const EventPacket& event);
     bool receiveSensorData(SensorDataPacket& data, TickType_t timeout = 0);
     bool receiveEvent(EventPacket& event, TickType_t timeout = 0);
+    bool sendAlert(const AlertPacket& alert);
+    bool receiveAlert(AlertPacket& alert, TickType_t timeout = 0);
     
     // Statistics
     void printStats();
     unsigned long getSensorTaskCount() { return sensorTaskCount; }
     unsigned long getBackgroundTaskCount() { return backgroundTaskCount; }
+    uint32_t getMaxSensorPeriodUs() { return maxSensorPeriodUs; }
+    uint32_t getMaxSensorProcessingUs() { return maxSensorProcessingUs; }
+    unsigned long getLateSensorIterations() { return lateSensorIterations; }
+    unsigned long getSensorQueueDrops() { return sensorQueueDrops; }
+    uint32_t getMaxEventPeriodUs() { return maxEventPeriodUs; }
+    uint32_t getMaxEventProcessingUs() { return maxEventProcessingUs; }
+    unsigned long getLateEventIterations() { return lateEventIterations; }
+    unsigned long getEventIterations() { return eventIterations; }
+    unsigned long getEventQueueDrops() { return eventQueueDrops; }
+    unsigned long getAlertQueueDrops() { return alertQueueDrops; }
+    unsigned long getAlertsPublished() { return alertsPublished; }
+    unsigned long getBackgroundIdleWakeups() { return backgroundIdleWakeups; }
+    unsigned long getSampleClockGaps() { return sampleClockGaps; }
+    uint32_t getMinSensorPeriodUs() { return sensorPeriods > 0 ? minSensorPeriodUs : 0; }
+    unsigned long getSensorPeriods() { return sensorPeriods; }
+    float getMeanSensorJitterUs() { return sensorPeriods > 0 ? (float)sensorJitterSumUs / sensorPeriods : 0.0f; }
+    float getSensorLoadPercent() {
+        uint64_t elapsedUs = sensorTimingEndUs - sensorTimingStartUs;
+        return elapsedUs > 0 ? 100.0f * sensorBusyUs / elapsedUs : 0.0f;
+    }
+    bool isTimerClock() { return sampleTimer != nullptr; }
+    unsigned long getMissedSampleTicks() { return missedSampleTicks; }
+    unsigned long getSampleTimerStalls() { return sampleTimerStalls; }
+    uint32_t getMaxWakeLatencyUs() { return maxWakeLatencyUs; }
+    void resetSensorTiming();
+    
+    // Task topology: restarts both tasks with new cores/priorities. On false
+    // the previous topology is running again (both tasks restarted if needed)
+    bool applyTopology(const TaskTopology& newTopology);
+    const TaskTopology& getTopology() { return topology; }
+    static const TaskTopology& configuredTopology();
+    static const TaskTopology* getTopologyPresets(int& count);
+    
+    // Calibrates the sensor array: through the sensor task while it runs
+    // (blocks the caller up to CALIBRATION_REQUEST_TIMEOUT_MS), directly
+    // otherwise. Samples pause for the calibration.
+    bool calibrateSensors();
     
     // Task management
     void suspendSensorTask();
@@ -0,0 +1,204 @@
+#include "early_magnitude.h"
+
+const int EarlyMagnitudeEstimator::RING_SIZE;
+
+static const uint32_t RING_MASK = EarlyMagnitudeEstimator::RING_SIZE - 1;
+static const uint32_t PRETRIGGER_SAMPLES = (uint32_t)EARLY_MAG_PRETRIGGER_MS * SAMPLING_RATE / 1000;
+static const uint32_t WINDOW_SAMPLES = (uint32_t)EARLY_MAG_WINDOW_MS * SAMPLING_RATE / 1000;
+static const uint32_t MIN_WINDOW_SAMPLES = (uint32_t)EARLY_MAG_MIN_WINDOW_MS * SAMPLING_RATE / 1000;
+static const uint32_t MIN_PICK_SAMPLES = 20;   // Shorter search windows keep the trigger sample
+static const float STANDARD_GRAVITY = 9.80665f;
+
+EarlyMagnitudeEstimator::EarlyMagnitudeEstimator() {
+    lock = portMUX_INITIALIZER_UNLOCKED;
+    estimatesCompleted = 0;
+    reset();
+}
+
+void EarlyMagnitudeEstimator::reset() {
+    static_assert((RING_SIZE & (RING_SIZE - 1)) == 0, "RING_SIZE must be a power of two");
+    static_assert(PRETRIGGER_SAMPLES + PIPELINE_BLOCK_SIZE < (uint32_t)RING_SIZE,
+                  "EARLY_MAG_PRETRIGGER_MS does not fit the ring");
+
+    written = 0;
+    newestUs = 0;
+    running = false;
+    memset(&current, 0, sizeof(current));
+
+    BiquadCoefficients hp = BiquadCoefficients::highPass(SAMPLING_RATE, EARLY_MAG_HIGHPASS_HZ);
+    velocityHighPass.configure(hp);
+    displacementHighPass.configure(hp);
+    publish();
+}
+
+void EarlyMagnitudeEstimator::addBlock(const SampleFormat::Sample* z, size_t count, uint64_t t0Us) {
+    if (count == 0) return;
+
+    for (size_t i = 0; i < count; i++) {
+        ring[(written + i) & RING_MASK] = z[i];
+    }
+    written += count;
+    newestUs = t0Us + (count - 1) * (uint64_t)SAMPLING_PERIOD_US;
+
+    if (running) {
+        integrate(written < endSample ? written : endSample);
+        publish();
+    }
+}
+
+void EarlyMagnitudeEstimator::start(uint32_t traceId, uint64_t triggerUs) {
+    running = false;
+    memset(&current, 0, sizeof(current));
+    current.traceId = traceId;
+    if (written == 0) {
+        publish();
+        return;
+    }
+
+    // Trigger sample inside the ring (it has already been fed)
+    uint32_t newest = written - 1;
+    uint32_t back = triggerUs < newestUs ? (uint32_t)((newestUs - triggerUs) / SAMPLING_PERIOD_US) : 0;
+    uint32_t oldest = written > (uint32_t)RING_SIZE ? written - RING_SIZE : 0;
+    uint32_t triggerSample = back > newest - oldest ? oldest : newest - back;
+
+    uint32_t from = triggerSample - oldest > PRETRIGGER_SAMPLES ? triggerSample - PRETRIGGER_SAMPLES : oldest;
+    onsetSample = triggerSample - from >= MIN_PICK_SAMPLES ? pickOnset(from, triggerSample) : triggerSample;
+
+    // Pre-onset level (offset residue, gravity on uncompensated setups)
+    if (onsetSample > from) {
+        float sum = 0.0f;
+        for (uint32_t n = from; n < onsetSample; n++) sum += SampleFormat::toG(ring[n & RING_MASK]);
+        baseline = sum / (onsetSample - from);
+    } else {
+        baseline = SampleFormat::toG(ring[onsetSample & RING_MASK]);
+    }
+
+    lastAccel = 0.0f;
+    velocity = 0.0f;
+    lastVelocity = 0.0f;
+    displacement = 0.0f;
+    velocityHighPass.reset();
+    displacementHighPass.reset();
+    sumVelocity2 = 0.0f;
+    sumDisplacement2 = 0.0f;
+    peakDisplacement = 0.0f;
+    current.onsetLeadMs = (uint16_t)((triggerSample - onsetSample) * 1000UL / SAMPLING_RATE);
+
+    // Replay from the onset up to the newest sample, then continue per block
+    nextSample = onsetSample;
+    endSample = onsetSample + WINDOW_SAMPLES;
+    running = true;
+    integrate(written < endSample ? written : endSample);
+    publish();
+}
+
+void EarlyMagnitudeEstimator::cancel() {
+    running = false;
+    memset(&current, 0, sizeof(current));
+    publish();
+}
+
+uint32_t EarlyMagnitudeEstimator::pickOnset(uint32_t from, uint32_t to) {
+    // Akaike information criterion picker (Maeda 1985): the onset splits
+    // [from, to] into the two segments with the least combined log variance.
+    // Prefix sums of the de-meaned signal make it one pass plus one scan.
+    uint32_t length = to - from + 1;
+    float mean = 0.0f;
+    for (uint32_t n = from; n <= to; n++) mean += SampleFormat::toG(ring[n & RING_MASK]);
+    mean /= length;
+
+    float totalSum = 0.0f;
+    float totalSquares = 0.0f;
+    for (uint32_t n = from; n <= to; n++) {
+        float value = SampleFormat::toG(ring[n & RING_MASK]) - mean;
+        totalSum += value;
+        totalSquares += value * value;
+    }
+
+    const float floorVariance = 1e-12f;   // Avoids log(0) on flat (quantised) stretches
+    float bestAic = 0.0f;
+    uint32_t best = to;
+    float sum = 0.0f;
+    float squares = 0.0f;
+    for (uint32_t k = 1; k < length - 1; k++) {
+        float value = SampleFormat::toG(ring[(from + k - 1) & RING_MASK]) - mean;
+        sum += value;
+        squares += value * value;
+
+        float headVariance = squares / k - (sum / k) * (sum / k);
+        uint32_t tailLength = length - k;
+        float tailSum = totalSum - sum;
+        float tailVariance = (totalSquares - squares) / tailLength - (tailSum / tailLength) * (tailSum / tailLength);
+        float aic = k * logf(fmaxf(headVariance, floorVariance)) +
+                    (tailLength - 1) * logf(fmaxf(tailVariance, floorVariance));
+        if (k == 1 || aic < bestAic) {
+            bestAic = aic;
+            best = from + k;
+        }
+    }
+    return best;
+}
+
+void EarlyMagnitudeEstimator::integrate(uint32_t until) {
+    const float dt = 1.0f / SAMPLING_RATE;
+
+    // Trapezoidal integration, high-pass after each step to remove the drift
+    // an offset error would otherwise turn into a ramp
+    for (; nextSample < until; nextSample++) {
+        float accel = (SampleFormat::toG(ring[nextSample & RING_MASK]) - baseline) * STANDARD_GRAVITY;
+        velocity += 0.5f * (accel + lastAccel) * dt;
+        lastAccel = accel;
+        float v = velocityHighPass.process(velocity);
+
+        displacement += 0.5f * (v + lastVelocity) * dt;
+        lastVelocity = v;
+        float u = displacementHighPass.process(displacement);
+
+        sumVelocity2 += v * v;
+        sumDisplacement2 += u * u;
+        if (fabsf(u) > peakDisplacement) peakDisplacement = fabsf(u);
+    }
+
+    uint32_t analysed = nextSample - onsetSample;
+    current.windowMs = (uint16_t)(analysed * 1000UL / SAMPLING_RATE);
+    // Small events stay on the PGA magnitude: their tau_c is that of the noise
+    if (analysed >= MIN_WINDOW_SAMPLES && peakDisplacement * 100.0f >= EARLY_MAG_MIN_PD_CM &&
+        sumVelocity2 > 0.0f) {
+        current.valid = true;
+        current.tauC = 2.0f * PI * sqrtf(sumDisplacement2 / sumVelocity2);
+        current.pdCm = peakDisplacement * 100.0f;
+        current.magnitudeTauC = magnitudeFromTauC(current.tauC);
+        current.magnitudePd = magnitudeFromPd(current.pdCm, EARLY_MAG_DISTANCE_KM);
+        current.magnitude = 0.5f * (current.magnitudeTauC + current.magnitudePd);
+    }
+
+    if (nextSample >= endSample) {
+        running = false;
+        current.complete = current.valid;
+        if (current.valid) estimatesCompleted++;
+    }
+}
+
+void EarlyMagnitudeEstimator::publish() {
+    portENTER_CRITICAL(&lock);
+    shared = current;
+    portEXIT_CRITICAL(&lock);
+}
+
+void EarlyMagnitudeEstimator::getSnapshot(EarlyMagnitudeEstimate& snapshot) {
+    portENTER_CRITICAL(&lock);
+    snapshot = shared;
+    portEXIT_CRITICAL(&lock);
+}
+
+float EarlyMagnitudeEstimator::magnitudeFromTauC(float tauC) {
+    // Wu & Kanamori (2005): M = 3.373 log10(tau_c) + 5.787
+    if (tauC <= 0.0f) return -2.0f;
+    return constrain(3.373f * log10f(tauC) + 5.787f, -2.0f, 10.0f);
+}
+
+float EarlyMagnitudeEstimator::magnitudeFromPd(float pdCm, float distanceKm) {
+    // Wu & Zhao (2006): log10(Pd) = -3.463 + 0.729 M - 1.374 log10(R)
+    if (pdCm <= 0.0f || distanceKm <= 0.0f) return -2.0f;
+    return constrain((log10f(pdCm) + 3.463f + 1.374f * log10f(distanceKm)) / 0.729f, -2.0f, 10.0f);
+}
@@ -0,0 +1,90 @@
+#ifndef EARLY_MAGNITUDE_H
+#define EARLY_MAGNITUDE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "config.h"
+#include "../utils/sample_format.h"
+#include "../utils/biquad.h"
+
+// Preliminary magnitude of a running event, copied out under a spinlock
+struct EarlyMagnitudeEstimate {
+    bool valid;                // EARLY_MAG_MIN_WINDOW_MS of P wave analysed, Pd over the noise floor
+    bool complete;             // Full EARLY_MAG_WINDOW_MS analysed, values are final
+    uint32_t traceId;          // Event the estimate belongs to
+    uint16_t windowMs;         // P-wave time analysed so far
+    uint16_t onsetLeadMs;      // Refined onset ahead of the trigger sample
+    float tauC;                // Predominant period (s)
+    float pdCm;                // Peak vertical displacement (cm)
+    float magnitudeTauC;
+    float magnitudePd;
+    float magnitude;           // Mean of the two estimates
+};
+
+// Early magnitude from the first seconds of the P wave (tau_c / Pd method).
+// The sensor task feeds every calibrated vertical sample into a short ring;
+// on a trigger the onset is refined by an AIC pick over the ring, and the
+// vertical acceleration from the onset on is integrated to velocity and
+// displacement, each followed by a 0.075 Hz Butterworth high-pass. Over the
+// window tau_c = 2 pi sqrt(sum u^2 / sum v^2) and Pd = max |u|.
+//
+// Idle cost is one ring write per sample; the integration only runs for
+// EARLY_MAG_WINDOW_MS after a trigger.
+class EarlyMagnitudeEstimator {
+public:
+    static const int RING_SIZE = 1024;   // Power of two, > pre-trigger + one block
+
+private:
+    SampleFormat::Sample ring[RING_SIZE];
+    uint32_t written;                // Samples written since reset
+    uint64_t newestUs;               // Time of the newest sample in the ring
+
+    // Running window
+    bool running;
+    uint32_t nextSample;             // Absolute index of the next sample to integrate
+    uint32_t endSample;              // One past the last sample of the window
+    uint32_t onsetSample;
+    float baseline;                  // Pre-onset mean removed from the acceleration (g)
+    float lastAccel;
+    float velocity;
+    float lastVelocity;
+    float displacement;
+    Biquad<FloatSampleFormat> velocityHighPass;
+    Biquad<FloatSampleFormat> displacementHighPass;
+    float sumVelocity2;
+    float sumDisplacement2;
+    float peakDisplacement;
+
+    EarlyMagnitudeEstimate current;  // Sensor task
+    EarlyMagnitudeEstimate shared;   // Published copy for other cores
+    portMUX_TYPE lock;
+    unsigned long estimatesCompleted;
+
+    uint32_t pickOnset(uint32_t from, uint32_t to);
+    void integrate(uint32_t until);
+    void publish();
+
+public:
+    EarlyMagnitudeEstimator();
+    void reset();
+
+    // Sensor task: calibrated vertical samples (Z-up frame), t0Us = first sample time
+    void addBlock(const SampleFormat::Sample* z, size_t count, uint64_t t0Us);
+
+    // Sensor task: event opened by the sample at triggerUs (already fed)
+    void start(uint32_t traceId, uint64_t triggerUs);
+    void cancel();
+
+    // Sensor task: latest values for the running event
+    const EarlyMagnitudeEstimate& estimate() const { return current; }
+
+    // Any core: consistent copy
+    void getSnapshot(EarlyMagnitudeEstimate& snapshot);
+    unsigned long getEstimatesCompleted() { return estimatesCompleted; }
+
+    // Empirical relations (Wu & Kanamori 2005, Wu & Zhao 2006)
+    static float magnitudeFromTauC(float tauC);
+    static float magnitudeFromPd(float pdCm, float distanceKm);
+};
+
+#endif // EARLY_MAGNITUDE_H
@@ -0,0 +1,259 @@
+#include "event_finalizer.h"
+#include "seismograph.h"
+#include "data_logger.h"
+#include "mqtt_handler.h"
+#include "web_server.h"
+#include "time_manager.h"
+#include <esp_timer.h>
+
+EventFinalizer::EventFinalizer() {
+    detailedLoggingEnabled = false;
+    seismographRef = nullptr;
+    dataLoggerRef = nullptr;
+    mqttHandlerRef = nullptr;
+    webServerRef = nullptr;
+    timeManagerRef = nullptr;
+    latencyTracerRef = nullptr;
+
+    pendingCount = 0;
+    eventsFinalized = 0;
+    eventsRejected = 0;
+    eventsForced = 0;
+}
+
+void EventFinalizer::setReferences(Seismograph* seismo, DataLogger* logger, MQTTHandler* mqtt, TimeManager* timeManager) {
+    seismographRef = seismo;
+    dataLoggerRef = logger;
+    mqttHandlerRef = mqtt;
+    timeManagerRef = timeManager;
+}
+
+void EventFinalizer::setWebServerReference(WebServerManager* webServer) {
+    webServerRef = webServer;
+}
+
+void EventFinalizer::setLatencyTracerReference(LatencyTracer* tracer) {
+    latencyTracerRef = tracer;
+}
+
+void EventFinalizer::submit(const EventPacket& event) {
+    EventPacket packet = event;
+    packet.dequeueUs = (uint64_t)esp_timer_get_time();
+    
+    // Without a UTC onset there is nothing to wait for
+    if (packet.onsetUtcMs == 0) {
+        finalize(packet);
+        return;
+    }
+
+    if (pendingCount == EVENT_FINALIZER_SLOTS) {
+        // A previous event still waiting for peers is recorded with what it has
+        finalize(pending[0]);
+        removePending(0);
+        eventsForced++;
+    }
+    pending[pendingCount++] = packet;
+}
+
+void EventFinalizer::loop() {
+    if (pendingCount == 0 || seismographRef == nullptr) return;
+
+    uint64_t nowUtcMs;
+    bool utcValid = TimeManager::getEpochTimeMs(nowUtcMs);
+    CoincidenceTrigger& coincidence = seismographRef->getCoincidenceTrigger();
+
+    int i = 0;
+    while (i < pendingCount) {
+        // Peers up to one window behind the onset still count
+        if (!utcValid || nowUtcMs >= coincidence.confirmationDeadline(pending[i].onsetUtcMs)) {
+            finalize(pending[i]);
+            removePending(i);
+        } else {
+            i++;
+        }
+    }
+}
+
+void EventFinalizer::removePending(int index) {
+    for (int i = index; i < pendingCount - 1; i++) {
+        pending[i] = pending[i + 1];
+    }
+    pendingCount--;
+}
+
+void EventFinalizer::finalize(const EventPacket& packet) {
+    EventTrace trace;
+    memset(&trace, 0, sizeof(trace));
+    trace.id = packet.traceId;
+    trace.injected = packet.injected;
+    trace.hopUs[HOP_TRIGGER] = packet.triggerUs;
+    trace.hopUs[HOP_HANDOFF] = packet.handoffUs;
+    trace.hopUs[HOP_DEQUEUE] = packet.dequeueUs;
+    trace.hopUs[HOP_FINALIZE] = (uint64_t)esp_timer_get_time();
+    
+    finalizeEvent(packet, trace);
+    
+    if (latencyTracerRef != nullptr) latencyTracerRef->record(trace);
+    if (detailedLoggingEnabled && packet.triggerUs != 0) {
+        Serial.printf("Event trace %lu: handoff +%lu us, finalize +%lu us, ws +%lu us\n",
+                      (unsigned long)trace.id,
+                      (unsigned long)(trace.hopUs[HOP_HANDOFF] - packet.triggerUs),
+                      (unsigned long)(trace.hopUs[HOP_FINALIZE] - packet.triggerUs),
+                      trace.hopUs[HOP_WEBSOCKET] != 0 ? (unsigned long)(trace.hopUs[HOP_WEBSOCKET] - packet.triggerUs) : 0UL);
+    }
+}
+
+void EventFinalizer::finalizeEvent(const EventPacket& packet, EventTrace& trace) {
+    if (seismographRef == nullptr) return;
+
+    float richter = seismographRef->calculateRichterMagnitude(packet.maxMagnitude);
+    int level = seismographRef->getIntensityLevelFromRichter(richter);
+    String eventType = seismographRef->getEventTypeFromRichter(richter);
+
+    Serial.printf("Event ended. Duration: %lu ms, Max: %.4f g, Avg: %.4f g, Level: %d\n",
+                  packet.durationMs, packet.maxMagnitude, packet.avgMagnitude, level);
+
+    // Network coincidence verdict for this event
+    CoincidenceResult coincidenceResult;
+    if (packet.onsetUtcMs != 0) {
+        CoincidenceTrigger& coincidence = seismographRef->getCoincidenceTrigger();
+        coincidenceResult = coincidence.evaluate(packet.onsetUtcMs);
+        Serial.printf("Coincidence: %d/%d stations within %lu ms -> %s\n",
+                      coincidenceResult.stations, coincidenceResult.required,
+                      (unsigned long)coincidence.getWindowMs(),
+                      coincidenceResult.confirmed ? "CONFIRMED" : "unconfirmed");
+    } else {
+        coincidenceResult.evaluated = false;
+        coincidenceResult.stations = 1;
+        coincidenceResult.required = COINCIDENCE_MIN_STATIONS;
+        coincidenceResult.confirmed = false;
+        coincidenceResult.onsetMs = 0;
+    }
+
+    if (detailedLoggingEnabled) {
+        Serial.printf("=== EVENT VALIDATION ===\n");
+        Serial.printf("Event Type: %s\n", eventType.c_str());
+        Serial.printf("Max Magnitude: %.6f g\n", packet.maxMagnitude);
+        Serial.printf("Avg Magnitude: %.6f g\n", packet.avgMagnitude);
+        Serial.printf("Duration: %lu ms\n", packet.durationMs);
+        Serial.printf("Sample Count: %d\n", packet.sampleCount);
+        Serial.printf("Classification Level: %d\n", level);
+    }
+
+    // Events are only recorded with a valid NTP time
+    bool ntpTimeValid = timeManagerRef != nullptr && timeManagerRef->isTimeValid();
+    if (detailedLoggingEnabled) Serial.printf("NTP Time Validation: %s\n", ntpTimeValid ? "VALID" : "INVALID");
+
+    if (!ntpTimeValid) {
+        eventsRejected++;
+        Serial.println(">>> EVENT REJECTED: NTP time not valid <<<");
+        if (detailedLoggingEnabled) {
+            Serial.println("Reasons for NTP time invalidity:");
+            Serial.printf("  - System may not be synchronized with NTP server\n");
+            Serial.printf("  - Network connectivity issues\n");
+            Serial.printf("  - Time integrity requirements not met\n");
+            Serial.printf("Event details: %s, Magnitude: %.6f g, Duration: %lu ms\n",
+                          eventType.c_str(), packet.maxMagnitude, packet.durationMs);
+            Serial.printf("Boot time would be: %lu ms\n", packet.startMs);
+            Serial.println("=== EVENT VALIDATION FAILED ===\n");
+        }
+        return;
+    }
+
+    // Complete SeismicEventData record
+    SeismicEventData eventData;
+
+    // Detection info
+    eventData.timestamp = timeManagerRef->getEpochTime();
+    eventData.datetimeISO = timeManagerRef->getFormattedDateTime();
+    eventData.ntpValidated = true;
+    eventData.bootTimeMs = packet.startMs;
+
+    // Classification
+    eventData.eventType = eventType;
+    eventData.intensityLevel = level;
+    eventData.richterRange = seismographRef->getRichterRangeFromType(eventType);
+    eventData.confidence = 0.95f; // High confidence for detected events
+
+    // Multi-station coincidence
+    eventData.coincidenceEvaluated = coincidenceResult.evaluated;
+    if (coincidenceResult.evaluated) {
+        eventData.coincidenceStations = coincidenceResult.stations;
+        eventData.coincidenceRequired = coincidenceResult.required;
+        eventData.coincidenceConfirmed = coincidenceResult.confirmed;
+        eventData.coincidencePeers = coincidenceResult.peers;
+        eventData.onsetUtcMs = coincidenceResult.onsetMs;
+        // A single-station trigger the network did not see is likely local
+        if (!coincidenceResult.confirmed) eventData.confidence = 0.5f;
+    } else {
+        eventData.coincidenceStations = 1;
+        eventData.coincidenceRequired = COINCIDENCE_MIN_STATIONS;
+        eventData.coincidenceConfirmed = false;
+        eventData.onsetUtcMs = 0;
+    }
+
+    // Measurements
+    eventData.pgaG = packet.maxMagnitude;
+    eventData.richterMagnitude = richter;
+    eventData.localMagnitude = seismographRef->calculateLocalMagnitude(packet.maxMagnitude);
+    eventData.durationMs = packet.durationMs;
+    eventData.peakFrequencyHz = seismographRef->calculatePeakFrequency(packet.maxMagnitude);
+    eventData.energyJoules = seismographRef->calculateEnergyJoules(richter);
+
+    // Sensor data (per-axis peaks tracked on the sensor core during the event)
+    eventData.maxAccelX = packet.peakAccel[0];
+    eventData.maxAccelY = packet.peakAccel[1];
+    eventData.maxAccelZ = packet.peakAccel[2];
+    eventData.accelRangeG = packet.accelRangeG;
+    eventData.clipped = packet.clipped;
+#if GYRO_CHANNELS_ENABLED
+    eventData.maxRateX = packet.peakRate[0];
+    eventData.maxRateY = packet.peakRate[1];
+    eventData.maxRateZ = packet.peakRate[2];
+#endif
+    eventData.vectorMagnitude = packet.maxMagnitude;
+    eventData.calibrationValid = packet.calibrationValid;
+    eventData.calibrationAgeHours = packet.calibrationAgeHours;
+
+    // Algorithm data
+    eventData.detectionMethod = "STA_LTA";
+    eventData.triggerRatio = packet.triggerRatio;
+    eventData.staWindowSamples = STA_WINDOW;
+    eventData.ltaWindowSamples = LTA_WINDOW;
+    eventData.backgroundNoise = packet.backgroundNoise;
+
+    // Metadata
+    eventData.source = packet.injected ? "synthetic_injection" : "seismograph_detection";
+    eventData.processingVersion = "v1.0";
+    eventData.sampleRateHz = SAMPLING_RATE;
+    eventData.filterApplied = "bandpass_1-30hz";
+    eventData.dataQuality = packet.calibrationValid ? "excellent" : "good";
+
+    // Permanent storage (also publishes the full event on MQTT)
+    if (dataLoggerRef != nullptr) {
+        bool success = dataLoggerRef->logSeismicEvent(eventData);
+        if (detailedLoggingEnabled) {
+            Serial.printf("Seismic event logged: %s (Success: %s)\n",
+                          eventData.eventType.c_str(), success ? "YES" : "NO");
+        }
+        dataLoggerRef->logEvent(eventType, "Seismic event detected", packet.maxMagnitude);
+        trace.hopUs[HOP_LOG] = (uint64_t)esp_timer_get_time();
+    }
+
+    if (mqttHandlerRef != nullptr && mqttHandlerRef->isConnected()) {
+        if (mqttHandlerRef->publishEvent(mqttHandlerRef->createEventJson(eventType, packet.maxMagnitude, level))) {
+            trace.hopUs[HOP_MQTT] = (uint64_t)esp_timer_get_time();
+        }
+    }
+
+    if (webServerRef != nullptr) {
+        webServerRef->sendSeismicEvent(eventType, packet.maxMagnitude, level);
+        trace.hopUs[HOP_WEBSOCKET] = (uint64_t)esp_timer_get_time();
+    }
+
+    eventsFinalized++;
+    if (detailedLoggingEnabled) {
+        Serial.printf("Current NTP time: %s\n", timeManagerRef->getFormattedDateTime().c_str());
+        Serial.println("=== EVENT VALIDATION COMPLETE ===\n");
+    }
+}
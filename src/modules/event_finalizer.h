@@ -0,0 +1,64 @@
+#ifndef EVENT_FINALIZER_H
+#define EVENT_FINALIZER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "dual_core_manager.h"
+#include "latency_tracer.h"
+
+// Forward declarations
+class Seismograph;
+class DataLogger;
+class MQTTHandler;
+class WebServerManager;
+class TimeManager;
+
+// Background-task stage that turns the raw state of an ended event (EventPacket
+// from the sensor task) into a recorded event: coincidence verdict, magnitude
+// classification, flash log, MQTT publish and WebSocket broadcast. The
+// sensor task only fills and queues the packet, so none of the String,
+// flash or network work happens between two samples.
+//
+// Events with a UTC onset are held until their coincidence deadline so late
+// peer triggers still count; the oldest is finalized early if all slots are
+// taken.
+class EventFinalizer {
+public:
+    bool detailedLoggingEnabled;
+
+private:
+    Seismograph* seismographRef;
+    DataLogger* dataLoggerRef;
+    MQTTHandler* mqttHandlerRef;
+    WebServerManager* webServerRef;
+    TimeManager* timeManagerRef;
+    LatencyTracer* latencyTracerRef;
+
+    EventPacket pending[EVENT_FINALIZER_SLOTS];
+    int pendingCount;
+
+    unsigned long eventsFinalized;
+    unsigned long eventsRejected;   // Dropped for lack of valid NTP time
+    unsigned long eventsForced;     // Finalized before their deadline (slots full)
+
+    void finalize(const EventPacket& packet);
+    void finalizeEvent(const EventPacket& packet, EventTrace& trace);
+    void removePending(int index);
+
+public:
+    EventFinalizer();
+    void setReferences(Seismograph* seismo, DataLogger* logger, MQTTHandler* mqtt, TimeManager* timeManager);
+    void setWebServerReference(WebServerManager* webServer);
+    void setLatencyTracerReference(LatencyTracer* tracer);
+
+    // Background task: accept an ended event, then finalize those past their deadline
+    void submit(const EventPacket& packet);
+    void loop();
+
+    int getPendingCount() { return pendingCount; }
+    unsigned long getEventsFinalized() { return eventsFinalized; }
+    unsigned long getEventsRejected() { return eventsRejected; }
+    unsigned long getEventsForced() { return eventsForced; }
+};
+
+#endif // EVENT_FINALIZER_H
@@ -0,0 +1,213 @@
+#include "helicorder_recorder.h"
+#include <ArduinoJson.h>
+#include "time_manager.h"
+
+static const unsigned long COLUMN_MS = HELICORDER_COLUMN_S * 1000UL;
+
+const int HelicorderRecorder::ROWS;
+const int HelicorderRecorder::COLUMNS_PER_ROW;
+const int HelicorderRecorder::COLUMNS_PER_DAY;
+const int16_t HelicorderRecorder::EMPTY_MIN;
+const int16_t HelicorderRecorder::EMPTY_MAX;
+
+HelicorderRecorder::HelicorderRecorder() : retention("/heli", HELICORDER_RETENTION_DAYS) {
+    detailedLoggingEnabled = false;
+    initialized = false;
+    timeManagerRef = nullptr;
+    dcBlocker.configure(BiquadCoefficients::dcBlocker(SAMPLING_RATE, HELICORDER_DC_CUTOFF_HZ));
+
+    anchored = false;
+    currentDay = 0;
+    currentColumn = 0;
+    columnEnd = 0;
+    columnMin = 0.0f;
+    columnMax = 0.0f;
+    columnSamples = 0;
+
+    pendingStart = 0;
+    pendingCount = 0;
+
+    columnsWritten = 0;
+    writeErrors = 0;
+}
+
+bool HelicorderRecorder::begin() {
+    if (!LittleFS.exists("/heli") && !LittleFS.mkdir("/heli")) {
+        Serial.println("ERROR: Failed to create /heli directory");
+        return false;
+    }
+    initialized = true;
+    if (detailedLoggingEnabled) {
+        Serial.printf("Helicorder initialized (%d rows x %d columns, %d s per column)\n",
+                      ROWS, COLUMNS_PER_ROW, HELICORDER_COLUMN_S);
+    }
+    return true;
+}
+
+void HelicorderRecorder::setTimeManagerReference(TimeManager* timeManager) {
+    timeManagerRef = timeManager;
+}
+
+void HelicorderRecorder::addSample(float accelZ, unsigned long timestampMs) {
+    // The filter runs even before anchoring so it has settled by then
+    float v = dcBlocker.process(accelZ);
+
+    if (!anchored) {
+        if (!anchor(timestampMs)) return;
+    } else {
+        // Close every column that ended; a stall leaves empty columns behind
+        while (anchored && (long)(timestampMs - columnEnd) >= 0) {
+            closeColumn();
+            currentColumn++;
+            columnEnd += COLUMN_MS;
+            if (currentColumn == COLUMNS_PER_DAY) {
+                // Day complete: flush and re-anchor to pick up NTP corrections
+                flush();
+                anchored = false;
+                if (!anchor(timestampMs)) return;
+                retention.cleanup(currentDay, detailedLoggingEnabled);
+            }
+        }
+    }
+
+    if (columnSamples == 0) {
+        columnMin = v;
+        columnMax = v;
+    } else {
+        if (v < columnMin) columnMin = v;
+        if (v > columnMax) columnMax = v;
+    }
+    columnSamples++;
+}
+
+bool HelicorderRecorder::anchor(unsigned long timestampMs) {
+    if (timeManagerRef == nullptr || !timeManagerRef->isTimeValid()) return false;
+
+    uint32_t epoch = timeManagerRef->getEpochTime();
+    uint32_t secondOfDay = epoch % 86400;
+    currentDay = epoch / 86400;
+    currentColumn = secondOfDay / HELICORDER_COLUMN_S;
+    columnEnd = timestampMs + (HELICORDER_COLUMN_S - secondOfDay % HELICORDER_COLUMN_S) * 1000UL;
+    columnSamples = 0;
+    pendingStart = currentColumn;
+    pendingCount = 0;
+    anchored = true;
+
+    if (detailedLoggingEnabled) {
+        Serial.printf("Helicorder anchored: day %lu, column %d\n", (unsigned long)currentDay, currentColumn);
+    }
+    return true;
+}
+
+void HelicorderRecorder::closeColumn() {
+    Column& column = pending[pendingCount++];
+    if (columnSamples == 0) {
+        column.min = EMPTY_MIN;
+        column.max = EMPTY_MAX;
+    } else {
+        column.min = toUnits(columnMin);
+        column.max = toUnits(columnMax);
+    }
+    columnSamples = 0;
+
+    if (pendingCount == HELICORDER_FLUSH_COLUMNS) flush();
+}
+
+void HelicorderRecorder::flush() {
+    if (pendingCount == 0) return;
+    if (initialized) {
+        if (appendColumns(currentDay, pendingStart, pending, pendingCount)) {
+            columnsWritten += pendingCount;
+        } else {
+            writeErrors++;
+        }
+    }
+    pendingStart += pendingCount;
+    pendingCount = 0;
+}
+
+bool HelicorderRecorder::appendColumns(uint32_t epochDay, int startColumn, const Column* columns, int count) {
+    File file = LittleFS.open(getArchivePath(epochDay), "a");
+    if (!file) return false;
+
+    // Columns are positional: skip what is already on flash (restart within
+    // the same column span), pad gaps (reboot, NTP loss) with empty columns
+    int stored = file.size() / sizeof(Column);
+    if (stored > startColumn) {
+        int overlap = stored - startColumn;
+        if (overlap >= count) {
+            file.close();
+            return true;
+        }
+        columns += overlap;
+        count -= overlap;
+    } else if (stored < startColumn) {
+        static const Column empty[16] = {
+            {EMPTY_MIN, EMPTY_MAX}, {EMPTY_MIN, EMPTY_MAX}, {EMPTY_MIN, EMPTY_MAX}, {EMPTY_MIN, EMPTY_MAX},
+            {EMPTY_MIN, EMPTY_MAX}, {EMPTY_MIN, EMPTY_MAX}, {EMPTY_MIN, EMPTY_MAX}, {EMPTY_MIN, EMPTY_MAX},
+            {EMPTY_MIN, EMPTY_MAX}, {EMPTY_MIN, EMPTY_MAX}, {EMPTY_MIN, EMPTY_MAX}, {EMPTY_MIN, EMPTY_MAX},
+            {EMPTY_MIN, EMPTY_MAX}, {EMPTY_MIN, EMPTY_MAX}, {EMPTY_MIN, EMPTY_MAX}, {EMPTY_MIN, EMPTY_MAX}
+        };
+        int gap = startColumn - stored;
+        while (gap > 0) {
+            int chunk = gap < 16 ? gap : 16;
+            size_t bytes = chunk * sizeof(Column);
+            if (file.write((const uint8_t*)empty, bytes) != bytes) {
+                file.close();
+                return false;
+            }
+            gap -= chunk;
+        }
+    }
+
+    size_t bytes = count * sizeof(Column);
+    size_t written = file.write((const uint8_t*)columns, bytes);
+    file.close();
+    return written == bytes;
+}
+
+int16_t HelicorderRecorder::toUnits(float g) {
+    float units = g * (1e6f / HELICORDER_UNIT_UG);
+    // EMPTY_MIN/EMPTY_MAX stay reserved for "no data"
+    if (units >= 32766.0f) return 32766;
+    if (units <= -32767.0f) return -32767;
+    return (int16_t)lroundf(units);
+}
+
+String HelicorderRecorder::getArchivePath(uint32_t epochDay) {
+    return "/heli/" + String(epochDay) + ".bin";
+}
+
+String HelicorderRecorder::getInfoJson() {
+    JsonDocument doc;
+    doc["rows"] = ROWS;
+    doc["columns_per_row"] = COLUMNS_PER_ROW;
+    doc["row_minutes"] = HELICORDER_ROW_MINUTES;
+    doc["column_s"] = HELICORDER_COLUMN_S;
+    doc["unit_ug"] = HELICORDER_UNIT_UG;
+    doc["empty_min"] = EMPTY_MIN;
+    doc["empty_max"] = EMPTY_MAX;
+    doc["recording"] = anchored;
+    if (anchored) {
+        doc["today"] = TimeManager::formatEpochDay(currentDay);
+        doc["flushed_columns"] = pendingStart;
+    }
+    doc["columns_written"] = columnsWritten;
+    doc["write_errors"] = writeErrors;
+
+    JsonArray days = doc["days"].to<JsonArray>();
+    File dir = LittleFS.open("/heli");
+    if (dir && dir.isDirectory()) {
+        File file = dir.openNextFile();
+        while (file) {
+            String fileName = file.name();
+            fileName = fileName.substring(fileName.lastIndexOf('/') + 1);
+            days.add(TimeManager::formatEpochDay(fileName.substring(0, fileName.indexOf('.')).toInt()));
+            file = dir.openNextFile();
+        }
+    }
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
@@ -0,0 +1,83 @@
+#ifndef HELICORDER_RECORDER_H
+#define HELICORDER_RECORDER_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "config.h"
+#include "../utils/archive_retention.h"
+#include "../utils/biquad.h"
+
+// Forward declarations
+class TimeManager;
+
+// Daily helicorder (drum recorder) data built incrementally in the background task. The
+// vertical channel is reduced to min/max per pixel column as samples arrive
+// and appended to /heli/<days since 1970>.bin, so serving a day is a file
+// send instead of a scan over raw samples.
+//
+// File layout: COLUMNS_PER_DAY columns of { int16 min, int16 max } in
+// HELICORDER_UNIT_UG, little-endian, row-major (column 0 = 00:00:00 UTC).
+// Columns without samples hold EMPTY_MIN/EMPTY_MAX; a file shorter than a
+// full day ends at the last flushed column.
+class HelicorderRecorder {
+public:
+    bool detailedLoggingEnabled;
+
+    static const int ROWS = 24 * 60 / HELICORDER_ROW_MINUTES;
+    static const int COLUMNS_PER_ROW = HELICORDER_ROW_MINUTES * 60 / HELICORDER_COLUMN_S;
+    static const int COLUMNS_PER_DAY = ROWS * COLUMNS_PER_ROW;
+    static const int16_t EMPTY_MIN = 32767;
+    static const int16_t EMPTY_MAX = -32768;
+
+private:
+    struct __attribute__((packed)) Column {
+        int16_t min;
+        int16_t max;
+    };
+
+    bool initialized;
+    TimeManager* timeManagerRef;
+    Biquad<FloatSampleFormat> dcBlocker;
+
+    // Current column, anchored to wall-clock time once NTP is valid
+    bool anchored;
+    uint32_t currentDay;
+    int currentColumn;
+    unsigned long columnEnd;
+    float columnMin;
+    float columnMax;
+    unsigned long columnSamples;
+
+    // Closed columns waiting for the next flash append
+    Column pending[HELICORDER_FLUSH_COLUMNS];
+    int pendingStart;
+    int pendingCount;
+
+    unsigned long columnsWritten;
+    unsigned long writeErrors;
+    ArchiveRetention retention;
+
+    bool anchor(unsigned long timestampMs);
+    void closeColumn();
+    void flush();
+    bool appendColumns(uint32_t epochDay, int startColumn, const Column* columns, int count);
+    static int16_t toUnits(float g);
+
+public:
+    HelicorderRecorder();
+    bool begin();
+    void setTimeManagerReference(TimeManager* timeManager);
+
+    // Background task: feed one calibrated vertical sample (g)
+    void addSample(float accelZ, unsigned long timestampMs);
+
+    // Any core
+    String getInfoJson();
+    String getArchivePath(uint32_t epochDay);
+
+    bool isRecording() { return anchored; }
+    unsigned long getColumnsWritten() { return columnsWritten; }
+    unsigned long getWriteErrors() { return writeErrors; }
+};
+
+#endif // HELICORDER_RECORDER_H
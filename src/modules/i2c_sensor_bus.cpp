@@ -0,0 +1,234 @@
+#include "i2c_sensor_bus.h"
+#include <esp_timer.h>
+
+// MPU6050 register map
+static const uint8_t MPU6050_REG_SMPLRT_DIV = 0x19;
+static const uint8_t MPU6050_REG_ACCEL_CONFIG = 0x1C;
+static const uint8_t MPU6050_REG_FIFO_EN = 0x23;
+static const uint8_t MPU6050_REG_INT_PIN_CFG = 0x37;
+static const uint8_t MPU6050_REG_INT_ENABLE = 0x38;
+static const uint8_t MPU6050_REG_INT_STATUS = 0x3A;
+static const uint8_t MPU6050_REG_ACCEL_XOUT_H = 0x3B;
+static const uint8_t MPU6050_REG_TEMP_OUT_H = 0x41;
+static const uint8_t MPU6050_REG_USER_CTRL = 0x6A;
+static const uint8_t MPU6050_REG_FIFO_COUNTH = 0x72;
+static const uint8_t MPU6050_REG_FIFO_R_W = 0x74;
+
+static const uint8_t FIFO_EN_ACCEL = 0x08;
+static const uint8_t USER_CTRL_FIFO_EN = 0x40;
+static const uint8_t USER_CTRL_FIFO_RESET = 0x04;
+static const uint8_t INT_PIN_CFG_LATCH = 0x20;       // INT held until INT_STATUS is read
+static const uint8_t INT_FIFO_OFLOW = 0x10;
+static const size_t FIFO_CHUNK_READS = 16;           // 96 bytes, ~2.2 ms at 400 kHz
+
+// START, address+W, register, repeated START, address+R, read, STOP
+static const size_t READ_LINK_SIZE = I2C_LINK_RECOMMENDED_SIZE(3);
+static const size_t WRITE_LINK_SIZE = I2C_LINK_RECOMMENDED_SIZE(1);
+
+const uint16_t I2cSensorBus::MPU6050_FIFO_BYTES;
+
+I2cSensorBus::I2cSensorBus() {
+    port = I2C_NUM_0;
+    active = false;
+    frequencyHz = 0;
+    statsLock = portMUX_INITIALIZER_UNLOCKED;
+    owner = nullptr;
+    resetStats();
+}
+
+bool I2cSensorBus::begin(i2c_port_t busPort, int sdaPin, int sclPin, uint32_t clockHz) {
+    end();
+    port = busPort;
+
+    i2c_config_t config = {};
+    config.mode = I2C_MODE_MASTER;
+    config.sda_io_num = sdaPin;
+    config.scl_io_num = sclPin;
+    config.sda_pullup_en = GPIO_PULLUP_ENABLE;
+    config.scl_pullup_en = GPIO_PULLUP_ENABLE;
+    config.master.clk_speed = clockHz;
+
+    esp_err_t result = i2c_param_config(port, &config);
+    if (result == ESP_OK) result = i2c_driver_install(port, I2C_MODE_MASTER, 0, 0, 0);
+    if (result != ESP_OK) {
+        Serial.printf("ERROR: I2C driver install failed: %s\n", esp_err_to_name(result));
+        return false;
+    }
+
+    active = true;
+    frequencyHz = clockHz;
+    return true;
+}
+
+void I2cSensorBus::end() {
+    if (!active) return;
+    i2c_driver_delete(port);
+    active = false;
+}
+
+esp_err_t I2cSensorBus::execute(i2c_cmd_handle_t cmd) {
+    if (owner != nullptr && xTaskGetCurrentTaskHandle() != owner) {
+        portENTER_CRITICAL(&statsLock);
+        stats.foreignCalls++;
+        portEXIT_CRITICAL(&statsLock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    uint64_t start = (uint64_t)esp_timer_get_time();
+    esp_err_t result = i2c_master_cmd_begin(port, cmd, pdMS_TO_TICKS(I2C_TRANSACTION_TIMEOUT_MS));
+    record(result, (uint32_t)((uint64_t)esp_timer_get_time() - start));
+    return result;
+}
+
+void I2cSensorBus::record(esp_err_t result, uint32_t elapsedUs) {
+    portENTER_CRITICAL(&statsLock);
+    stats.transactions++;
+    stats.sumTransactionUs += elapsedUs;
+    if (elapsedUs > stats.maxTransactionUs) stats.maxTransactionUs = elapsedUs;
+    if (result != ESP_OK) {
+        if (result == ESP_FAIL) stats.errors++;
+        else if (result == ESP_ERR_TIMEOUT) stats.timeouts++;
+        else stats.otherErrors++;
+        stats.lastError = result;
+        stats.lastErrorMs = millis();
+    }
+    portEXIT_CRITICAL(&statsLock);
+}
+
+bool I2cSensorBus::readRegisters(uint8_t address, uint8_t reg, uint8_t* data, size_t length) {
+    if (!active || length == 0) return false;
+
+    uint8_t linkBuffer[READ_LINK_SIZE];
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(linkBuffer, sizeof(linkBuffer));
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_write_byte(cmd, reg, true);
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_READ, true);
+    i2c_master_read(cmd, data, length, I2C_MASTER_LAST_NACK);
+    i2c_master_stop(cmd);
+
+    esp_err_t result = execute(cmd);
+    i2c_cmd_link_delete_static(cmd);
+    return result == ESP_OK;
+}
+
+bool I2cSensorBus::writeRegister(uint8_t address, uint8_t reg, uint8_t value) {
+    if (!active) return false;
+
+    uint8_t payload[2] = { reg, value };
+    uint8_t linkBuffer[WRITE_LINK_SIZE];
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(linkBuffer, sizeof(linkBuffer));
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_write(cmd, payload, sizeof(payload), true);
+    i2c_master_stop(cmd);
+
+    esp_err_t result = execute(cmd);
+    i2c_cmd_link_delete_static(cmd);
+    return result == ESP_OK;
+}
+
+bool I2cSensorBus::readAccel(uint8_t address, int16_t* xyz) {
+    uint8_t data[6];
+    if (!readRegisters(address, MPU6050_REG_ACCEL_XOUT_H, data, sizeof(data))) return false;
+
+    // Big-endian register pairs
+    xyz[0] = (int16_t)((data[0] << 8) | data[1]);
+    xyz[1] = (int16_t)((data[2] << 8) | data[3]);
+    xyz[2] = (int16_t)((data[4] << 8) | data[5]);
+    return true;
+}
+
+bool I2cSensorBus::readMotion(uint8_t address, int16_t* accel, int16_t* gyro) {
+    uint8_t data[14];
+    if (!readRegisters(address, MPU6050_REG_ACCEL_XOUT_H, data, sizeof(data))) return false;
+
+    // Accel 0..5, temperature 6..7, gyro 8..13
+    for (int axis = 0; axis < 3; axis++) {
+        accel[axis] = (int16_t)((data[2 * axis] << 8) | data[2 * axis + 1]);
+        gyro[axis] = (int16_t)((data[8 + 2 * axis] << 8) | data[8 + 2 * axis + 1]);
+    }
+    return true;
+}
+
+bool I2cSensorBus::readTemperatureRaw(uint8_t address, int16_t& raw) {
+    uint8_t data[2];
+    if (!readRegisters(address, MPU6050_REG_TEMP_OUT_H, data, sizeof(data))) return false;
+
+    raw = (int16_t)((data[0] << 8) | data[1]);
+    return true;
+}
+
+bool I2cSensorBus::setAccelRange(uint8_t address, uint8_t afsSel) {
+    uint8_t config;
+    if (!readRegisters(address, MPU6050_REG_ACCEL_CONFIG, &config, 1)) return false;
+
+    // AFS_SEL is bits 4:3
+    config = (config & ~0x18) | ((afsSel & 0x03) << 3);
+    return writeRegister(address, MPU6050_REG_ACCEL_CONFIG, config);
+}
+
+bool I2cSensorBus::beginFifo(uint8_t address, uint8_t sampleRateDivider, bool overflowInterrupt) {
+    // Reads paced by the sensor: 8 kHz / (1 + divider) with the DLPF off
+    return writeRegister(address, MPU6050_REG_SMPLRT_DIV, sampleRateDivider) &&
+           writeRegister(address, MPU6050_REG_FIFO_EN, FIFO_EN_ACCEL) &&
+           writeRegister(address, MPU6050_REG_INT_PIN_CFG, INT_PIN_CFG_LATCH) &&
+           writeRegister(address, MPU6050_REG_INT_ENABLE, overflowInterrupt ? INT_FIFO_OFLOW : 0) &&
+           resetFifo(address);
+}
+
+bool I2cSensorBus::endFifo(uint8_t address) {
+    return writeRegister(address, MPU6050_REG_INT_ENABLE, 0) &&
+           writeRegister(address, MPU6050_REG_USER_CTRL, 0) &&
+           writeRegister(address, MPU6050_REG_FIFO_EN, 0) &&
+           writeRegister(address, MPU6050_REG_SMPLRT_DIV, 0);
+}
+
+bool I2cSensorBus::resetFifo(uint8_t address) {
+    // Reset with the FIFO disabled, then enable it again
+    return writeRegister(address, MPU6050_REG_USER_CTRL, USER_CTRL_FIFO_RESET) &&
+           writeRegister(address, MPU6050_REG_USER_CTRL, USER_CTRL_FIFO_EN);
+}
+
+bool I2cSensorBus::readFifoStatus(uint8_t address, uint16_t& bytes, bool& overflow) {
+    uint8_t status;
+    uint8_t count[2];
+    // INT_STATUS first: reading it clears the latched interrupt
+    if (!readRegisters(address, MPU6050_REG_INT_STATUS, &status, 1)) return false;
+    if (!readRegisters(address, MPU6050_REG_FIFO_COUNTH, count, sizeof(count))) return false;
+
+    bytes = (uint16_t)((count[0] << 8) | count[1]);
+    overflow = (status & INT_FIFO_OFLOW) != 0 || bytes >= MPU6050_FIFO_BYTES;
+    return true;
+}
+
+bool I2cSensorBus::readFifoAccel(uint8_t address, int16_t* xyz, size_t count) {
+    // Bursts from FIFO_R_W (the register does not auto-increment), short
+    // enough to stay inside I2C_TRANSACTION_TIMEOUT_MS
+    uint8_t* data = (uint8_t*)xyz;
+    for (size_t done = 0; done < count; done += FIFO_CHUNK_READS) {
+        size_t reads = count - done < FIFO_CHUNK_READS ? count - done : FIFO_CHUNK_READS;
+        if (!readRegisters(address, MPU6050_REG_FIFO_R_W, data + 6 * done, 6 * reads)) return false;
+    }
+
+    // Big-endian pairs, swapped in place
+    for (size_t i = 0; i < 3 * count; i++) {
+        uint8_t high = data[2 * i];
+        uint8_t low = data[2 * i + 1];
+        xyz[i] = (int16_t)((high << 8) | low);
+    }
+    return true;
+}
+
+void I2cSensorBus::getStats(I2cBusStats& snapshot) {
+    portENTER_CRITICAL(&statsLock);
+    snapshot = stats;
+    portEXIT_CRITICAL(&statsLock);
+}
+
+void I2cSensorBus::resetStats() {
+    portENTER_CRITICAL(&statsLock);
+    memset(&stats, 0, sizeof(stats));
+    stats.lastError = ESP_OK;
+    portEXIT_CRITICAL(&statsLock);
+}
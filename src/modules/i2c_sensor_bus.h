@@ -0,0 +1,85 @@
+#ifndef I2C_SENSOR_BUS_H
+#define I2C_SENSOR_BUS_H
+
+#include <Arduino.h>
+#include <driver/i2c.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "config.h"
+
+// Transaction counters, copied out under the lock
+struct I2cBusStats {
+    unsigned long transactions;
+    unsigned long errors;         // NACK / arbitration lost (ESP_FAIL)
+    unsigned long timeouts;       // Bus held or clock stretched past I2C_TRANSACTION_TIMEOUT_MS
+    unsigned long otherErrors;    // Driver state errors
+    unsigned long foreignCalls;   // Rejected: not called from the owning task
+    esp_err_t lastError;
+    unsigned long lastErrorMs;
+    uint32_t maxTransactionUs;
+    uint64_t sumTransactionUs;
+};
+
+// Sensor reads through the ESP-IDF I2C master driver. Each read is one
+// command link (START, register address, repeated START, burst read, STOP)
+// handed to the driver as a single transaction; the driver runs it from the
+// I2C interrupt and the calling task blocks on the driver's event queue, so
+// the core is free for other work while the bytes are on the bus.
+//
+// Takes over the port from Wire once the MPU6050 library has configured the
+// sensor. The driver serialises single transactions only: sequences such as
+// setAccelRange() (read-modify-write), beginFifo()/resetFifo() or
+// readFifoStatus() then readFifoAccel() are not atomic. The bus therefore
+// has one owner, the sensor task while it runs (setOwner()); transactions
+// from any other task are rejected and counted. Without an owner (before
+// the tasks start) any task may call. The command link lives on the
+// caller's stack.
+class I2cSensorBus {
+private:
+    i2c_port_t port;
+    bool active;
+    uint32_t frequencyHz;
+
+    I2cBusStats stats;
+    portMUX_TYPE statsLock;
+    TaskHandle_t volatile owner;
+
+    esp_err_t execute(i2c_cmd_handle_t cmd);
+    void record(esp_err_t result, uint32_t elapsedUs);
+
+public:
+    I2cSensorBus();
+
+    // Install the driver on the pins Wire used; call after Wire.end()
+    bool begin(i2c_port_t busPort, int sdaPin, int sclPin, uint32_t clockHz);
+    void end();
+    bool isActive() { return active; }
+    // nullptr releases the bus (the owning task is about to exit)
+    void setOwner(TaskHandle_t task) { owner = task; }
+    uint32_t getFrequency() { return frequencyHz; }
+
+    bool readRegisters(uint8_t address, uint8_t reg, uint8_t* data, size_t length);
+    bool writeRegister(uint8_t address, uint8_t reg, uint8_t value);
+
+    // MPU6050: ACCEL_XOUT_H..ACCEL_ZOUT_L only (6 bytes, no gyro/temperature)
+    bool readAccel(uint8_t address, int16_t* xyz);
+    // ACCEL_XOUT_H..GYRO_ZOUT_L in one 14-byte burst (temperature skipped)
+    bool readMotion(uint8_t address, int16_t* accel, int16_t* gyro);
+    bool readTemperatureRaw(uint8_t address, int16_t& raw);
+    // ACCEL_CONFIG AFS_SEL (0..3 = ±2/4/8/16 g), other bits preserved
+    bool setAccelRange(uint8_t address, uint8_t afsSel);
+
+    // FIFO of accelerometer reads (6 bytes each), paced by SMPLRT_DIV; the
+    // overflow interrupt is latched on INT until readFifoStatus()
+    static const uint16_t MPU6050_FIFO_BYTES = 1024;
+    bool beginFifo(uint8_t address, uint8_t sampleRateDivider, bool overflowInterrupt);
+    bool endFifo(uint8_t address);
+    bool resetFifo(uint8_t address);
+    bool readFifoStatus(uint8_t address, uint16_t& bytes, bool& overflow);
+    bool readFifoAccel(uint8_t address, int16_t* xyz, size_t count);
+
+    void getStats(I2cBusStats& snapshot);
+    void resetStats();
+};
+
+#endif // I2C_SENSOR_BUS_H
@@ -0,0 +1,180 @@
+#include "latency_tracer.h"
+#include <ArduinoJson.h>
+
+const int LatencyTracer::BUCKETS;
+const int LatencyTracer::RECENT;
+
+LatencyTracer::LatencyTracer() {
+    lock = portMUX_INITIALIZER_UNLOCKED;
+    reset();
+}
+
+void LatencyTracer::reset() {
+    portENTER_CRITICAL(&lock);
+    memset(hops, 0, sizeof(hops));
+    memset(&alerts, 0, sizeof(alerts));
+    for (int hop = 0; hop < HOP_COUNT; hop++) hops[hop].minUs = UINT32_MAX;
+    alerts.minUs = UINT32_MAX;
+    recentIndex = 0;
+    recentCount = 0;
+    traces = 0;
+    portEXIT_CRITICAL(&lock);
+}
+
+int LatencyTracer::bucketOf(uint32_t us) {
+    int bucket = 0;
+    while (us > 1 && bucket < BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void LatencyTracer::addSample(HopStats& stats, uint32_t us) {
+    stats.count++;
+    stats.sumUs += us;
+    if (us < stats.minUs) stats.minUs = us;
+    if (us > stats.maxUs) stats.maxUs = us;
+    stats.histogram[bucketOf(us)]++;
+}
+
+void LatencyTracer::record(const EventTrace& trace) {
+    if (trace.hopUs[HOP_TRIGGER] == 0) return;
+
+    portENTER_CRITICAL(&lock);
+    uint64_t previous = trace.hopUs[HOP_TRIGGER];
+    for (int hop = HOP_TRIGGER + 1; hop < HOP_COUNT; hop++) {
+        uint64_t at = trace.hopUs[hop];
+        if (at == 0) continue;
+        addSample(hops[hop], (uint32_t)(at - previous));
+        previous = at;
+    }
+    // End to end: trigger sample to the last hop reached
+    addSample(hops[HOP_TRIGGER], (uint32_t)(previous - trace.hopUs[HOP_TRIGGER]));
+
+    recent[recentIndex] = trace;
+    recentIndex = (recentIndex + 1) % RECENT;
+    if (recentCount < RECENT) recentCount++;
+    traces++;
+    portEXIT_CRITICAL(&lock);
+}
+
+void LatencyTracer::recordAlert(uint32_t us) {
+    portENTER_CRITICAL(&lock);
+    addSample(alerts, us);
+    portEXIT_CRITICAL(&lock);
+}
+
+uint32_t LatencyTracer::percentile(const HopStats& stats, float fraction) {
+    if (stats.count == 0) return 0;
+    // Interpolated inside the bucket holding the requested rank, clamped to
+    // the observed range
+    unsigned long rank = (unsigned long)ceilf(stats.count * fraction);
+    if (rank == 0) rank = 1;
+    unsigned long seen = 0;
+    for (int bucket = 0; bucket < BUCKETS; bucket++) {
+        uint32_t inBucket = stats.histogram[bucket];
+        if (seen + inBucket >= rank) {
+            uint32_t lower = bucket == 0 ? 0 : 1UL << bucket;
+            uint32_t width = bucket == 0 ? 2 : 1UL << bucket;
+            uint32_t estimate = lower + (uint32_t)((uint64_t)width * (rank - seen) / inBucket);
+            if (estimate < stats.minUs) estimate = stats.minUs;
+            if (estimate > stats.maxUs) estimate = stats.maxUs;
+            return estimate;
+        }
+        seen += inBucket;
+    }
+    return stats.maxUs;
+}
+
+void LatencyTracer::getEndToEnd(uint32_t& p50Us, uint32_t& p95Us, uint32_t& maxUs) {
+    HopStats stats;
+    portENTER_CRITICAL(&lock);
+    stats = hops[HOP_TRIGGER];
+    portEXIT_CRITICAL(&lock);
+    p50Us = percentile(stats, 0.5f);
+    p95Us = percentile(stats, 0.95f);
+    maxUs = stats.maxUs;
+}
+
+const char* LatencyTracer::hopName(int hop) {
+    switch (hop) {
+        case HOP_TRIGGER: return "trigger";
+        case HOP_HANDOFF: return "handoff";
+        case HOP_DEQUEUE: return "dequeue";
+        case HOP_FINALIZE: return "finalize";
+        case HOP_LOG: return "log";
+        case HOP_MQTT: return "mqtt_publish";
+        case HOP_WEBSOCKET: return "ws_enqueue";
+    }
+    return "unknown";
+}
+
+String LatencyTracer::getPerfJson() {
+    // Copy one hop at a time so the finalizer is never held up for long
+    JsonDocument doc;
+    doc["traces"] = traces;
+    doc["bucket_unit"] = "us, bucket i = [2^i, 2^(i+1))";
+
+    JsonArray hopList = doc["hops"].to<JsonArray>();
+    for (int hop = 0; hop < HOP_COUNT; hop++) {
+        HopStats stats;
+        portENTER_CRITICAL(&lock);
+        stats = hops[hop];
+        portEXIT_CRITICAL(&lock);
+
+        JsonObject hopJson = hop == HOP_TRIGGER ? doc["end_to_end"].to<JsonObject>() : hopList.add<JsonObject>();
+        if (hop != HOP_TRIGGER) hopJson["name"] = hopName(hop);
+        hopJson["count"] = stats.count;
+        if (stats.count == 0) continue;
+        hopJson["min_us"] = stats.minUs;
+        hopJson["avg_us"] = (uint32_t)(stats.sumUs / stats.count);
+        hopJson["p50_us"] = percentile(stats, 0.5f);
+        hopJson["p95_us"] = percentile(stats, 0.95f);
+        hopJson["max_us"] = stats.maxUs;
+        JsonArray histogram = hopJson["histogram"].to<JsonArray>();
+        int last = BUCKETS - 1;
+        while (last > 0 && stats.histogram[last] == 0) last--;
+        for (int bucket = 0; bucket <= last; bucket++) histogram.add(stats.histogram[bucket]);
+    }
+
+    HopStats alertStats;
+    portENTER_CRITICAL(&lock);
+    alertStats = alerts;
+    portEXIT_CRITICAL(&lock);
+    JsonObject alertJson = doc["alert"].to<JsonObject>();
+    alertJson["count"] = alertStats.count;
+    if (alertStats.count > 0) {
+        alertJson["min_us"] = alertStats.minUs;
+        alertJson["avg_us"] = (uint32_t)(alertStats.sumUs / alertStats.count);
+        alertJson["p50_us"] = percentile(alertStats, 0.5f);
+        alertJson["p95_us"] = percentile(alertStats, 0.95f);
+        alertJson["max_us"] = alertStats.maxUs;
+    }
+
+    // Newest first, hop times relative to the trigger sample
+    JsonArray recentList = doc["recent"].to<JsonArray>();
+    portENTER_CRITICAL(&lock);
+    int count = recentCount;
+    int newest = recentIndex;
+    portEXIT_CRITICAL(&lock);
+    for (int i = 1; i <= count; i++) {
+        EventTrace trace;
+        portENTER_CRITICAL(&lock);
+        trace = recent[(newest + RECENT - i) % RECENT];
+        portEXIT_CRITICAL(&lock);
+
+        JsonObject traceJson = recentList.add<JsonObject>();
+        traceJson["id"] = trace.id;
+        traceJson["injected"] = trace.injected;
+        JsonObject offsets = traceJson["hops_us"].to<JsonObject>();
+        for (int hop = HOP_TRIGGER + 1; hop < HOP_COUNT; hop++) {
+            if (trace.hopUs[hop] == 0) continue;
+            offsets[hopName(hop)] = (uint32_t)(trace.hopUs[hop] - trace.hopUs[HOP_TRIGGER]);
+        }
+    }
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
@@ -0,0 +1,77 @@
+#ifndef LATENCY_TRACER_H
+#define LATENCY_TRACER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "config.h"
+
+// Hops of an event from the trigger sample to subscriber delivery
+enum TraceHop {
+    HOP_TRIGGER = 0,    // Trigger sample (sensor task)
+    HOP_HANDOFF,        // Event packet queued by the sensor task
+    HOP_DEQUEUE,        // Packet taken by the background task
+    HOP_FINALIZE,       // Finalizer starts (after the coincidence deadline)
+    HOP_LOG,            // Written to flash
+    HOP_MQTT,           // Event published on MQTT
+    HOP_WEBSOCKET,      // Event queued for WebSocket clients
+    HOP_COUNT
+};
+
+// Monotonic (esp_timer) timestamps of one event; 0 = hop not reached
+struct EventTrace {
+    uint32_t id;
+    bool injected;
+    uint64_t hopUs[HOP_COUNT];
+};
+
+// Per-hop latency histograms over all traced events. Each hop is measured
+// from the previous hop the event reached, plus trigger-to-last-hop as the
+// end-to-end figure. Buckets are powers of two in microseconds, so one table
+// covers sub-millisecond queue hops and multi-second event durations.
+//
+// record() runs in the background task (event finalizer); readers take a copy under the
+// lock.
+class LatencyTracer {
+public:
+    static const int BUCKETS = 28;   // 1 us .. 2^27 us (~134 s)
+    static const int RECENT = 8;     // Full traces kept for /api/perf
+
+    struct HopStats {
+        unsigned long count;
+        uint32_t minUs;
+        uint32_t maxUs;
+        uint64_t sumUs;
+        uint32_t histogram[BUCKETS];
+    };
+
+private:
+    portMUX_TYPE lock;
+    HopStats hops[HOP_COUNT];        // Index 0 holds the end-to-end figure
+    HopStats alerts;                 // Trigger sample to trigger-on alert sent
+    EventTrace recent[RECENT];
+    int recentIndex;
+    int recentCount;
+    unsigned long traces;
+
+    static void addSample(HopStats& stats, uint32_t us);
+    static uint32_t percentile(const HopStats& stats, float fraction);
+    static int bucketOf(uint32_t us);
+
+public:
+    LatencyTracer();
+
+    // Background task: account one finished (or rejected) event
+    void record(const EventTrace& trace);
+    // Background task: trigger sample to the early-warning alert leaving the device
+    void recordAlert(uint32_t us);
+    void reset();
+
+    // Any task
+    String getPerfJson();
+    unsigned long getTraceCount() { return traces; }
+    void getEndToEnd(uint32_t& p50Us, uint32_t& p95Us, uint32_t& maxUs);
+
+    static const char* hopName(int hop);
+};
+
+#endif // LATENCY_TRACER_H
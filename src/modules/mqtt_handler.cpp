@@ -35,8 +35,9 @@ bool MQTTHandler::begin() {
         initialized = true;
         if (detailedLoggingEnabled) Serial.println("MQTT Handler initialized successfully");
         
-        // Subscribe to command topics
+        // Subscribe to command topics and peer station triggers
         subscribe(String(TOPIC_COMMAND) + "#");
+        if (COINCIDENCE_ENABLED) subscribe(TOPIC_TRIGGER_PEERS);
         
         // Send initial status
         publishStatus("{\"status\":\"online\",\"message\":\"MQTT connected\"}");
@@ -62,6 +63,15 @@ void MQTTHandler::loop() {
     } else {
         mqttClient.loop();
         
+        // Local trigger on/off transitions for the peer stations
+        if (seismographRef != nullptr) {
+            CoincidenceTrigger& coincidence = seismographRef->getCoincidenceTrigger();
+            String payload;
+            while (coincidence.popOutgoing(payload)) {
+                publish(coincidence.getTopic(), payload);
+            }
+        }
+        
         // Check scheduled publishing
         checkScheduledPublishing();
     }
@@ -113,6 +123,17 @@ bool MQTTHandler::publishSeismicEvent(const SeismicEventData& eventData) {
     classification["richter_range"] = eventData.richterRange;
     classification["confidence"] = eventData.confidence;
     
+    // Coincidence section (network confirmation)
+    JsonObject coincidence = doc["coincidence"].to<JsonObject>();
+    coincidence["evaluated"] = eventData.coincidenceEvaluated;
+    coincidence["stations"] = eventData.coincidenceStations;
+    coincidence["required"] = eventData.coincidenceRequired;
+    coincidence["confirmed"] = eventData.coincidenceConfirmed;
+    if (eventData.coincidenceEvaluated) {
+        coincidence["onset_utc_ms"] = eventData.onsetUtcMs;
+        coincidence["peers"] = eventData.coincidencePeers;
+    }
+    
     // Measurements section
     JsonObject measurements = doc["measurements"].to<JsonObject>();
     measurements["pga_g"] = eventData.pgaG;
@@ -127,6 +148,13 @@ bool MQTTHandler::publishSeismicEvent(const SeismicEventData& eventData) {
     sensorData["max_accel_x"] = eventData.maxAccelX;
     sensorData["max_accel_y"] = eventData.maxAccelY;
     sensorData["max_accel_z"] = eventData.maxAccelZ;
+    sensorData["accel_range_g"] = eventData.accelRangeG;
+    sensorData["clipped"] = eventData.clipped;
+#if GYRO_CHANNELS_ENABLED
+    sensorData["max_rate_x_dps"] = eventData.maxRateX;
+    sensorData["max_rate_y_dps"] = eventData.maxRateY;
+    sensorData["max_rate_z_dps"] = eventData.maxRateZ;
+#endif
     sensorData["vector_magnitude"] = eventData.vectorMagnitude;
     sensorData["calibration_valid"] = eventData.calibrationValid;
     sensorData["calibration_age_hours"] = eventData.calibrationAgeHours;
@@ -226,6 +254,7 @@ bool MQTTHandler::reconnect() {
         
         // Resubscribe to topics
         subscribe(String(TOPIC_COMMAND) + "#");
+        if (COINCIDENCE_ENABLED) subscribe(TOPIC_TRIGGER_PEERS);
         
         // Announce connection
         publishStatus("{\"status\":\"online\",\"message\":\"MQTT reconnected\"}");
@@ -244,6 +273,16 @@ void MQTTHandler::staticMessageCallback(char* topic, byte* payload, unsigned int
 }
 
 void MQTTHandler::onMessageReceived(char* topic, byte* payload, unsigned int length) {
+    // Peer trigger messages are frequent during events - handle them before
+    // building any Strings
+    size_t topicLength = strlen(topic);
+    if (topicLength > 8 && strcmp(topic + topicLength - 8, "/trigger") == 0) {
+        if (seismographRef != nullptr) {
+            seismographRef->getCoincidenceTrigger().handlePeerMessage((const char*)payload, length, millis());
+        }
+        return;
+    }
+    
     // Convert payload to string
     String message;
     for (unsigned int i = 0; i < length; i++) {
@@ -273,7 +312,9 @@ void MQTTHandler::processCommand(const String& command, const String& payload) {
         Serial.println("Calibrate command received via MQTT");
         if (seismographRef != nullptr) {
             publishStatus("{\"status\":\"calibrating\",\"message\":\"Calibration started\"}");
-            bool success = seismographRef->calibrate();
+            // Run by the sensor task between blocks, never beside it
+            bool success = globalCoreManager != nullptr ? globalCoreManager->calibrateSensors()
+                                                        : seismographRef->calibrate();
             if (success) {
                 publishStatus("{\"status\":\"calibrated\",\"message\":\"Sensor calibration successful\"}");
                 Serial.println("MQTT calibration command completed successfully");
@@ -300,6 +341,17 @@ void MQTTHandler::processCommand(const String& command, const String& payload) {
         publishStatus("{\"status\":\"debug\",\"message\":\"Debug mode " + status + "\"}");
         Serial.printf("MQTT debug mode %s\n", status.c_str());
     }
+#if GYRO_CHANNELS_ENABLED
+    else if (command == "gyro") {
+        if (seismographRef != nullptr) {
+            seismographRef->setGyroEnabled(payload == "on" || payload == "1");
+            String status = seismographRef->isGyroEnabled() ? "enabled" : "disabled";
+            publishStatus("{\"status\":\"gyro\",\"message\":\"Gyro channels " + status + "\"}");
+        } else {
+            publishStatus("{\"status\":\"error\",\"message\":\"Seismograph not available\"}");
+        }
+    }
+#endif
     else if (command == "status") {
         Serial.println("Status request received via MQTT");
         // Send detailed status
@@ -344,15 +396,35 @@ void MQTTHandler::setLastWillTestament() {
     if (detailedLoggingEnabled) Serial.println("LWT configuration skipped - not supported by current PubSubClient version");
 }
 
-String MQTTHandler::createDataJson(float accelX, float accelY, float accelZ, float magnitude) {
+String MQTTHandler::createDataJson(float accelX, float accelY, float accelZ, float magnitude, const float* rates) {
     JsonDocument doc;
     doc["timestamp"] = millis();
     doc["accel_x"] = accelX;
     doc["accel_y"] = accelY;
     doc["accel_z"] = accelZ;
     doc["magnitude"] = magnitude;
+    if (rates != nullptr) {
+        doc["gyro_x"] = rates[0];
+        doc["gyro_y"] = rates[1];
+        doc["gyro_z"] = rates[2];
+    }
     doc["device_id"] = MQTT_CLIENT_ID;
     
+    // Per-band energies of the last Goertzel window
+    if (seismographRef != nullptr) {
+        BandEnergyMonitor& monitor = seismographRef->getBandEnergyMonitor();
+        BandEnergySnapshot bands;
+        monitor.getSnapshot(bands);
+        JsonObject bandsJson = doc["bands"].to<JsonObject>();
+        for (int band = 0; band < monitor.getBandCount(); band++) {
+            JsonObject bandJson = bandsJson[monitor.getBandName(band)].to<JsonObject>();
+            bandJson["rms_g"] = bands.rms[band];
+            bandJson["background_g"] = bands.background[band];
+        }
+        doc["band_trigger"] = bands.triggered;
+        doc["band_veto"] = bands.vetoed;
+    }
+    
     // Add NTP timestamp if available
     if (timeManagerRef != nullptr) {
         doc["ntp_valid"] = timeManagerRef->isTimeValid();
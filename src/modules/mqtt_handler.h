@@ -53,7 +53,7 @@ public:
     
     // Utility methods
     void setLastWillTestament();
-    String createDataJson(float accelX, float accelY, float accelZ, float magnitude);
+    String createDataJson(float accelX, float accelY, float accelZ, float magnitude, const float* rates = nullptr);
     String createEventJson(const String& eventType, float magnitude, int level);
     
     // Scheduled publishing methods
@@ -0,0 +1,201 @@
+#include "power_manager.h"
+#include <WiFi.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <driver/gpio.h>
+
+PowerManager::PowerManager() {
+    detailedLoggingEnabled = false;
+    active = false;
+    startUs = 0;
+
+    uplinkOpen = false;
+    uplinkRequested = false;
+    uplinkOpenedMs = 0;
+    lastRequestMs = 0;
+    lastUplinkMs = 0;
+    uplinkOpenedUs = 0;
+
+    statsLock = portMUX_INITIALIZER_UNLOCKED;
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool PowerManager::begin() {
+    // Backstop for a late timer wake-up: the MPU6050 latches INT on FIFO
+    // overflow until the next batch reads INT_STATUS
+    if (LOW_POWER_FIFO_WAKE) {
+        pinMode(MPU6050_INT_PIN, INPUT);
+        if (gpio_wakeup_enable((gpio_num_t)MPU6050_INT_PIN, GPIO_INTR_HIGH_LEVEL) != ESP_OK ||
+            esp_sleep_enable_gpio_wakeup() != ESP_OK) {
+            Serial.println("WARNING: FIFO interrupt wake-up unavailable, timer only");
+        }
+    }
+
+    unsigned long now = millis();
+    startUs = (uint64_t)esp_timer_get_time();
+    lastRequestMs = now - LOW_POWER_UPLINK_WINDOW_MS;
+    lastUplinkMs = now;
+    if (WiFi.status() == WL_CONNECTED) {
+        // Setup's connection is the first window (NTP, MQTT, OTA)
+        WiFi.setSleep(true);
+        uplinkOpenedMs = now;
+        uplinkOpenedUs = startUs;
+        uplinkOpen = true;
+    } else {
+        WiFi.mode(WIFI_OFF);
+    }
+    active = true;
+
+    Serial.printf("Low-power mode: %d reads per wake-up, uplink every %lu s for %lu s\n",
+                  LOW_POWER_BATCH_SAMPLES, (unsigned long)LOW_POWER_UPLINK_INTERVAL_MS / 1000,
+                  (unsigned long)LOW_POWER_UPLINK_WINDOW_MS / 1000);
+    return true;
+}
+
+void PowerManager::loop() {
+    if (!active) return;
+    unsigned long now = millis();
+
+    // A trigger keeps the uplink open until LOW_POWER_UPLINK_WINDOW_MS after
+    // the last batch of the event
+    if (uplinkRequested) {
+        uplinkRequested = false;
+        lastRequestMs = now;
+        if (!uplinkOpen) {
+            portENTER_CRITICAL(&statsLock);
+            stats.eventUplinks++;
+            portEXIT_CRITICAL(&statsLock);
+            openUplink();
+        }
+    }
+
+    if (!uplinkOpen) {
+        if (now - lastUplinkMs >= LOW_POWER_UPLINK_INTERVAL_MS) openUplink();
+    } else if (now - uplinkOpenedMs >= LOW_POWER_UPLINK_WINDOW_MS && now - lastRequestMs >= LOW_POWER_UPLINK_WINDOW_MS) {
+        closeUplink();
+    }
+}
+
+void PowerManager::openUplink() {
+    // Open before the radio starts, so the sensor task stops light-sleeping
+    uplinkOpen = true;
+    uplinkOpenedMs = millis();
+    lastUplinkMs = uplinkOpenedMs;
+    uplinkOpenedUs = (uint64_t)esp_timer_get_time();
+
+    WiFi.mode(WIFI_STA);
+    WiFi.setSleep(true);  // Modem sleep between DTIM beacons
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+
+    portENTER_CRITICAL(&statsLock);
+    stats.uplinkWindows++;
+    portEXIT_CRITICAL(&statsLock);
+    if (detailedLoggingEnabled) Serial.println("Uplink window opened");
+}
+
+void PowerManager::closeUplink() {
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+
+    uint64_t onUs = (uint64_t)esp_timer_get_time() - uplinkOpenedUs;
+    portENTER_CRITICAL(&statsLock);
+    stats.wifiOnUs += onUs;
+    portEXIT_CRITICAL(&statsLock);
+    uplinkOpen = false;
+    if (detailedLoggingEnabled) Serial.printf("Uplink window closed after %lu ms\n", (unsigned long)(onUs / 1000));
+}
+
+void PowerManager::lightSleep(uint64_t durationUs) {
+    esp_sleep_enable_timer_wakeup(durationUs);
+    uint64_t beforeUs = (uint64_t)esp_timer_get_time();
+    esp_err_t result = esp_light_sleep_start();
+    uint64_t sleptUs = (uint64_t)esp_timer_get_time() - beforeUs;
+    esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+
+    portENTER_CRITICAL(&statsLock);
+    if (result != ESP_OK) {
+        stats.sleepSkips++;
+    } else {
+        stats.sleeps++;
+        stats.sleepUs += sleptUs;
+        if (cause == ESP_SLEEP_WAKEUP_GPIO) stats.fifoWakeups++;
+        else stats.timerWakeups++;
+    }
+    portEXIT_CRITICAL(&statsLock);
+}
+
+void PowerManager::recordSkippedSleep() {
+    portENTER_CRITICAL(&statsLock);
+    stats.sleepSkips++;
+    portEXIT_CRITICAL(&statsLock);
+}
+
+void PowerManager::recordBatch(size_t reads) {
+    portENTER_CRITICAL(&statsLock);
+    stats.batches++;
+    stats.batchReads += reads;
+    portEXIT_CRITICAL(&statsLock);
+}
+
+void PowerManager::getStats(PowerStats& snapshot) {
+    portENTER_CRITICAL(&statsLock);
+    snapshot = stats;
+    portEXIT_CRITICAL(&statsLock);
+}
+
+float PowerManager::getSleepPercent() {
+    uint64_t elapsedUs = (uint64_t)esp_timer_get_time() - startUs;
+    if (!active || elapsedUs == 0) return 0.0f;
+    PowerStats snapshot;
+    getStats(snapshot);
+    return 100.0f * snapshot.sleepUs / elapsedUs;
+}
+
+float PowerManager::getEstimatedCurrentMa() {
+    uint64_t nowUs = (uint64_t)esp_timer_get_time();
+    uint64_t elapsedUs = nowUs - startUs;
+    if (!active || elapsedUs == 0) return 0.0f;
+
+    PowerStats snapshot;
+    getStats(snapshot);
+    uint64_t wifiUs = snapshot.wifiOnUs + (uplinkOpen ? nowUs - uplinkOpenedUs : 0);
+    float sleepShare = (float)snapshot.sleepUs / elapsedUs;
+    float wifiShare = (float)wifiUs / elapsedUs;
+    return (1.0f - sleepShare) * LOW_POWER_ACTIVE_MA + sleepShare * LOW_POWER_SLEEP_MA + wifiShare * LOW_POWER_WIFI_MA;
+}
+
+void PowerManager::toJson(JsonObject out) {
+    PowerStats snapshot;
+    getStats(snapshot);
+    uint64_t nowUs = (uint64_t)esp_timer_get_time();
+    uint64_t elapsedUs = nowUs - startUs;
+    uint64_t wifiUs = snapshot.wifiOnUs + (uplinkOpen ? nowUs - uplinkOpenedUs : 0);
+
+    out["active"] = active;
+    out["uplink_open"] = (bool)uplinkOpen;
+    out["sleep_pct"] = getSleepPercent();
+    out["wifi_on_pct"] = elapsedUs > 0 ? 100.0f * wifiUs / elapsedUs : 0.0f;
+    out["estimated_ma"] = getEstimatedCurrentMa();
+    out["sleeps"] = snapshot.sleeps;
+    out["timer_wakeups"] = snapshot.timerWakeups;
+    out["fifo_wakeups"] = snapshot.fifoWakeups;
+    out["sleep_skips"] = snapshot.sleepSkips;
+    out["mean_sleep_ms"] = snapshot.sleeps > 0 ? snapshot.sleepUs / 1000.0f / snapshot.sleeps : 0.0f;
+    out["batches"] = snapshot.batches;
+    out["mean_batch_reads"] = snapshot.batches > 0 ? (float)snapshot.batchReads / snapshot.batches : 0.0f;
+    out["uplink_windows"] = snapshot.uplinkWindows;
+    out["event_uplinks"] = snapshot.eventUplinks;
+    if (active && !uplinkOpen) {
+        unsigned long sinceMs = millis() - lastUplinkMs;
+        out["next_uplink_s"] = sinceMs < LOW_POWER_UPLINK_INTERVAL_MS ? (LOW_POWER_UPLINK_INTERVAL_MS - sinceMs) / 1000 : 0;
+    }
+}
+
+String PowerManager::getStatsJson() {
+    JsonDocument doc;
+    toJson(doc.to<JsonObject>());
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
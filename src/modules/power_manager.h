@@ -0,0 +1,73 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <ArduinoJson.h>
+#include "config.h"
+
+// Wake-up and power counters, copied out under the lock
+struct PowerStats {
+    unsigned long sleeps;
+    unsigned long timerWakeups;
+    unsigned long fifoWakeups;        // FIFO overflow interrupt on MPU6050_INT_PIN
+    unsigned long sleepSkips;         // Stayed awake: core 0 still busy or sleep refused
+    uint64_t sleepUs;                 // Time spent in light sleep
+    uint64_t wifiOnUs;                // Time with Wi-Fi on (closed windows)
+    unsigned long batches;
+    uint64_t batchReads;
+    unsigned long uplinkWindows;
+    unsigned long eventUplinks;       // Windows opened by a trigger
+};
+
+// Duty cycling for LOW_POWER_MODE. The sensor task calls lightSleep()
+// between FIFO batches; the Arduino loop task opens and closes the Wi-Fi
+// uplink windows. Light sleep is only entered with Wi-Fi off: the station
+// connection does not survive it, so the radio is in modem sleep during a
+// window and the CPU idles on FreeRTOS delays instead.
+class PowerManager {
+public:
+    bool detailedLoggingEnabled;
+
+private:
+    bool active;
+    uint64_t startUs;
+
+    // Uplink windows (loop task)
+    volatile bool uplinkOpen;
+    volatile bool uplinkRequested;    // Set from the sensor task on a trigger
+    unsigned long uplinkOpenedMs;
+    unsigned long lastRequestMs;
+    unsigned long lastUplinkMs;
+    uint64_t uplinkOpenedUs;
+
+    PowerStats stats;
+    portMUX_TYPE statsLock;
+
+    void openUplink();
+    void closeUplink();
+
+public:
+    PowerManager();
+    // Wake sources; the boot connection counts as the first uplink window
+    bool begin();
+    void loop();
+
+    // Sensor task
+    bool canSleep() { return active && !uplinkOpen; }
+    void lightSleep(uint64_t durationUs);
+    void recordSkippedSleep();
+    void recordBatch(size_t reads);
+    void requestUplink() { uplinkRequested = true; }
+
+    // Any core
+    bool isActive() { return active; }
+    bool isUplinkOpen() { return uplinkOpen; }
+    void getStats(PowerStats& snapshot);
+    float getSleepPercent();
+    float getEstimatedCurrentMa();
+    void toJson(JsonObject out);
+    String getStatsJson();
+};
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,271 @@
+#ifndef PROCESSING_PIPELINE_H
+#define PROCESSING_PIPELINE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "sta_lta_detector.h"
+#include "../utils/sample_format.h"
+#include "../utils/biquad.h"
+#include "../utils/running_median.h"
+
+// A block of calibrated samples in structure-of-arrays layout. Stages run
+// one tight loop per array; the filter and magnitude loops are branch-free,
+// the spike filter and STA/LTA branch per sample (a rejected sample must not
+// advance the STA/LTA windows). Flags are bytes so they clear with memset.
+template <typename Format>
+struct SampleBlock {
+    static const size_t CAPACITY = PIPELINE_BLOCK_SIZE;
+    
+    typename Format::Sample x[PIPELINE_BLOCK_SIZE];
+    typename Format::Sample y[PIPELINE_BLOCK_SIZE];
+    typename Format::Sample z[PIPELINE_BLOCK_SIZE];
+    typename Format::MagnitudeSq magnitudeSq[PIPELINE_BLOCK_SIZE];      // Detector input |a|^2, rewritten by MagnitudeStage
+    typename Format::MagnitudeSq inputMagnitudeSq[PIPELINE_BLOCK_SIZE]; // Calibrated |a|^2 before any stage
+    uint8_t rejected[PIPELINE_BLOCK_SIZE];   // Dropped by a stage, detectors skip it
+    uint8_t triggered[PIPELINE_BLOCK_SIZE];  // Detector output per sample
+};
+
+// ---------------------------------------------------------------------------
+// Stages. Each stage is a class template on the sample format providing
+// reset() and processBlock(block, count); the chain calls them with no
+// virtual dispatch.
+// ---------------------------------------------------------------------------
+
+// Removes the residual DC level per axis (thermal drift, slow tilt)
+template <typename Format>
+class DcRemovalStage {
+private:
+    Biquad<Format> axis[3];
+
+public:
+    DcRemovalStage() { reset(); }
+
+    void reset() {
+        BiquadCoefficients c = BiquadCoefficients::dcBlocker(SAMPLING_RATE, DC_REMOVAL_CUTOFF_HZ);
+        for (int i = 0; i < 3; i++) axis[i].configure(c);
+    }
+
+    inline void processBlock(SampleBlock<Format>& block, size_t count) {
+        axis[0].processBlock(block.x, count);
+        axis[1].processBlock(block.y, count);
+        axis[2].processBlock(block.z, count);
+    }
+};
+
+// Band-pass per axis as a high-pass/low-pass biquad cascade
+template <typename Format>
+class BandPassStage {
+private:
+    Biquad<Format> highPass[3];
+    Biquad<Format> lowPass[3];
+
+public:
+    BandPassStage() { reset(); }
+
+    void reset() {
+        BiquadCoefficients hp = BiquadCoefficients::highPass(SAMPLING_RATE, BANDPASS_LOW_HZ);
+        BiquadCoefficients lp = BiquadCoefficients::lowPass(SAMPLING_RATE, BANDPASS_HIGH_HZ);
+        for (int i = 0; i < 3; i++) {
+            highPass[i].configure(hp);
+            lowPass[i].configure(lp);
+        }
+    }
+
+    inline void processBlock(SampleBlock<Format>& block, size_t count) {
+        highPass[0].processBlock(block.x, count);
+        lowPass[0].processBlock(block.x, count);
+        highPass[1].processBlock(block.y, count);
+        lowPass[1].processBlock(block.y, count);
+        highPass[2].processBlock(block.z, count);
+        lowPass[2].processBlock(block.z, count);
+    }
+};
+
+// Recomputes |a|^2 after axis filters. Profiles without axis filters omit it
+// and use the squared magnitude computed during calibration.
+template <typename Format>
+class MagnitudeStage {
+public:
+    void reset() {}
+
+    inline void processBlock(SampleBlock<Format>& block, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            block.magnitudeSq[i] = Format::magnitudeSquared(block.x[i], block.y[i], block.z[i]);
+        }
+    }
+};
+
+// Hampel-style spike filter: a sample is a spike when it exceeds both the
+// absolute threshold and SPIKE_MEDIAN_MULTIPLIER times the running median.
+// Every sample enters the median window, so a sustained onset lifts the
+// median within half a window and stops being flagged. Spikes are either
+// dropped or replaced by the median (SPIKE_FILTER_REPLACE_WITH_MEDIAN).
+// Works on |a|^2: squaring is monotonic, so the median and both criteria
+// (with squared threshold and multiplier) decide exactly as on |a|.
+template <typename Format>
+class SpikeFilterStage {
+public:
+    typedef typename Format::MagnitudeSq MagnitudeSq;
+    typedef typename Format::Sum Sum;
+
+private:
+    RunningMedian<MagnitudeSq, SPIKE_FILTER_BUFFER_SIZE> window;
+    MagnitudeSq spikeThresholdSq;
+    unsigned long spikesFiltered;
+
+public:
+    SpikeFilterStage() : spikesFiltered(0) {
+        setThreshold(THRESHOLD_MICRO);
+    }
+
+    void reset() { window.reset(); }
+
+    // Micro threshold in g; the absolute spike criterion is SPIKE_THRESHOLD_MULTIPLIER times it
+    void setThreshold(float thresholdMicroG) {
+        spikeThresholdSq = Format::magnitudeSqFromG(thresholdMicroG * SPIKE_THRESHOLD_MULTIPLIER);
+    }
+
+    inline void processBlock(SampleBlock<Format>& block, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            MagnitudeSq magnitudeSq = block.magnitudeSq[i];
+            bool active = window.isFull();
+            MagnitudeSq median = window.median();
+            window.insert(magnitudeSq);
+
+            if (active && magnitudeSq > spikeThresholdSq &&
+                (Sum)magnitudeSq * 1000 > (Sum)median * (Sum)(SPIKE_MEDIAN_MULTIPLIER * SPIKE_MEDIAN_MULTIPLIER * 1000)) {
+                spikesFiltered++;
+#if SPIKE_FILTER_REPLACE_WITH_MEDIAN
+                block.magnitudeSq[i] = median;
+                block.inputMagnitudeSq[i] = median;
+#else
+                block.rejected[i] = 1;
+#endif
+            }
+        }
+    }
+
+    bool isActive() const { return window.isFull(); }
+    float getMedian() const { return Format::magnitudeSqToG(window.median()); }
+    unsigned long getSpikesFiltered() const { return spikesFiltered; }
+};
+
+// STA/LTA trigger on the block's squared magnitude
+template <typename Format>
+class StaLtaStage {
+public:
+    typedef StaLtaDetector<Format, STA_WINDOW, LTA_WINDOW> Detector;
+
+private:
+    Detector staLta;
+
+public:
+    void reset() { staLta.reset(); }
+
+    inline void processBlock(SampleBlock<Format>& block, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            if (block.rejected[i]) continue;
+            staLta.update(block.magnitudeSq[i]);
+            block.triggered[i] = staLta.isTriggered(STA_LTA_RATIO);
+        }
+    }
+
+    const Detector& detector() const { return staLta; }
+};
+
+// ---------------------------------------------------------------------------
+// Chain composition. Pipeline<Format, A, B, C> inherits Pipeline<Format, B, C>
+// and holds an A, so processBlock() is a fully inlined A -> B -> C sequence
+// of per-stage loops over the block.
+// ---------------------------------------------------------------------------
+
+// Tag type used to look up a stage by its template
+template <template <typename> class Stage>
+struct StageTag {};
+
+template <typename Format, template <typename> class... Stages>
+class Pipeline;
+
+template <typename Format>
+class Pipeline<Format> {
+public:
+    typedef Format SampleFormatType;
+    typedef SampleBlock<Format> Block;
+
+    static const int STAGE_COUNT = 0;
+
+    void reset() {}
+    void stage() {}  // Anchor for the using-declaration chain
+
+protected:
+    inline void run(Block&, size_t) {}
+};
+
+template <typename Format, template <typename> class Head, template <typename> class... Tail>
+class Pipeline<Format, Head, Tail...> : public Pipeline<Format, Tail...> {
+private:
+    typedef Pipeline<Format, Tail...> Next;
+    Head<Format> head;
+
+protected:
+    inline void run(SampleBlock<Format>& block, size_t count) {
+        head.processBlock(block, count);
+        Next::run(block, count);
+    }
+
+public:
+    typedef SampleBlock<Format> Block;
+
+    static const int STAGE_COUNT = 1 + Next::STAGE_COUNT;
+
+    void reset() {
+        head.reset();
+        Next::reset();
+    }
+
+    // Runs every stage over the first count samples (count <= Block::CAPACITY)
+    void processBlock(Block& block, size_t count) {
+        memset(block.rejected, 0, count);
+        memset(block.triggered, 0, count);
+        run(block, count);
+    }
+
+    using Next::stage;
+    Head<Format>& stage(StageTag<Head>) { return head; }
+    const Head<Format>& stage(StageTag<Head>) const { return head; }
+};
+
+// ---------------------------------------------------------------------------
+// Station profiles
+// ---------------------------------------------------------------------------
+
+// Calibrated |a|^2 -> spike filter -> STA/LTA (the classic chain)
+typedef Pipeline<SampleFormat, SpikeFilterStage, StaLtaStage> StandardStationProfile;
+
+// Drift-prone installations: remove residual DC before the magnitude
+typedef Pipeline<SampleFormat, DcRemovalStage, MagnitudeStage,
+                 SpikeFilterStage, StaLtaStage> DriftTolerantStationProfile;
+
+// Noisy sites: restrict the trigger to the seismic band
+typedef Pipeline<SampleFormat, DcRemovalStage, BandPassStage, MagnitudeStage,
+                 SpikeFilterStage, StaLtaStage> UrbanStationProfile;
+
+#if STATION_PROFILE == STATION_PROFILE_URBAN
+typedef UrbanStationProfile StationPipeline;
+#elif STATION_PROFILE == STATION_PROFILE_DRIFT_TOLERANT
+typedef DriftTolerantStationProfile StationPipeline;
+#else
+typedef StandardStationProfile StationPipeline;
+#endif
+
+inline const char* stationProfileName() {
+#if STATION_PROFILE == STATION_PROFILE_URBAN
+    return "urban";
+#elif STATION_PROFILE == STATION_PROFILE_DRIFT_TOLERANT
+    return "drift-tolerant";
+#else
+    return "standard";
+#endif
+}
+
+#endif // PROCESSING_PIPELINE_H
@@ -1,29 +1,58 @@
 #include "seismograph.h"
 #include "dual_core_manager.h"
 #include "time_manager.h"
-#include "data_logger.h"
+#include <esp_timer.h>
 
-// Externe Referenz auf TimeManager
-extern TimeManager timeManager;
-// Externe Referenz auf DataLogger
-extern DataLogger* globalDataLogger;
-
-Seismograph::Seismograph() : mpu() {
+Seismograph::Seismograph() {
     initialized = false;
     calibrated = false;
     
-    // Initialize calibration offsets
-    offsetX = 0.0f;
-    offsetY = 0.0f;
-    offsetZ = 0.0f;
-    
-    // Initialize STA/LTA buffers
-    staIndex = 0;
-    ltaIndex = 0;
-    staSum = 0.0f;
-    ltaSum = 0.0f;
-    staFull = false;
-    ltaFull = false;
+    // Initialize the sensor array (no offsets, identity orientation)
+    const uint8_t addresses[] = SENSOR_ADDRESSES;
+    for (int s = 0; s < SENSOR_COUNT; s++) {
+        ArraySensor& sensor = sensors[s];
+        sensor.address = addresses[s];
+        sensor.present = false;
+        sensor.calibrated = false;
+        for (int axis = 0; axis < 3; axis++) {
+            sensor.offset[axis] = 0.0f;
+            sensor.lastCalibrationOffsets[axis] = 0.0f;
+            sensor.tempAxisSum[axis] = 0;
+        }
+        sensor.tempAxisCount = 0;
+        sensor.rangeShift = 0;
+        sensor.rangeQuietSinceMs = 0;
+        sensor.clippedBlocks = 0;
+        sensor.rangeSwitches = 0;
+#if GYRO_CHANNELS_ENABLED
+        sensor.gyroBias[0] = sensor.gyroBias[1] = sensor.gyroBias[2] = 0.0f;
+#endif
+        resetOrientation(sensor);
+        sensor.readErrors = 0;
+        sensor.outvoted = 0;
+    }
+    consistencyTolerance = SampleFormat::fromG(ARRAY_CONSISTENCY_G);
+    consistencyRelative = SampleFormat::coefficient(ARRAY_CONSISTENCY_RELATIVE);
+    lastCombined[0] = lastCombined[1] = lastCombined[2] = 0;
+    arrayDisagreements = 0;
+    maxReadSkewUs = 0;
+    fifoMode = false;
+    fifoOverflows = 0;
+    fifoResyncs = 0;
+    fifoRestarts = 0;
+#if GYRO_CHANNELS_ENABLED
+    gyroEnabled = GYRO_DEFAULT_ON;
+    blockHasRates = false;
+    eventPeakRate[0] = eventPeakRate[1] = eventPeakRate[2] = 0.0f;
+#endif
+    
+    // Initialize temperature compensation
+    lastTempSample = 0;
+    rebuildParameterBlock();
+    
+    // Initialize band energy monitoring
+    bandTriggers = 0;
+    vetoedTriggers = 0;
     
     // Initialize event detection
     eventActive = false;
@@ -31,6 +60,19 @@ Seismograph::Seismograph() : mpu() {
     eventMaxMagnitude = 0.0f;
     eventSumMagnitude = 0.0f;
     eventSampleCount = 0;
+    eventDuration = 0;
+    eventPeakAccel[0] = eventPeakAccel[1] = eventPeakAccel[2] = 0.0f;
+    eventRangeShift = 0;
+    eventClipped = false;
+    blockRangeShift = 0;
+    blockClipped = false;
+    eventInjected = false;
+    eventTraceId = 0;
+    eventTriggerUs = 0;
+    blockStartUs = 0;
+    alertSequence = 0;
+    lastAlertUs = 0;
+    eventOnsetUtcMs = 0;
     
     // Initialize adaptive thresholds (disabled by default)
     adaptiveThresholdMicro = THRESHOLD_MICRO;
@@ -40,53 +82,64 @@ Seismograph::Seismograph() : mpu() {
     lastAdaptiveUpdate = 0;
     adaptiveThresholdEnabled = true; // Enabled by default
     
-    // Initialize spike filtering
-    magnitudeIndex = 0;
-    magnitudeBufferFull = false;
-    for (int i = 0; i < 5; i++) {
-        lastMagnitudes[i] = 0.0f;
-    }
-    
     // Initialize statistics
     totalSamples = 0;
     eventsDetected = 0;
-    spikesFiltered = 0;
-    lastMagnitude = 0.0f;
+    lastSample.accelX = lastSample.accelY = lastSample.accelZ = 0;
+    lastSample.timestamp = 0;
+    lastSample.rangeShift = 0;
+#if GYRO_CHANNELS_ENABLED
+    lastSample.rateX = lastSample.rateY = lastSample.rateZ = 0.0f;
+#endif
+    publishedSample = lastSample;
+    sampleLock = portMUX_INITIALIZER_UNLOCKED;
+    lastRaw[0] = lastRaw[1] = lastRaw[2] = 0;
+    lastRawShift = 0;
     
     // Initialize detailed logging
     detailedLoggingInterval = 5000; // Default: 5 seconds
     detailedLoggingEnabled = false;  // Disabled by default
     
     // Initialize enhanced calibration monitoring
-    lastCalibrationOffsets[0] = 0.0f; // X
-    lastCalibrationOffsets[1] = 0.0f; // Y
-    lastCalibrationOffsets[2] = 0.0f; // Z
     lastCalibrationTime = 0;
     baselineLTA = 0.0f;
     lastDriftCheck = 0;
     calibrationValid = false;
-    
-    // Clear buffers
-    for (int i = 0; i < STA_WINDOW; i++) {
-        staBuffer[i] = 0.0f;
-    }
-    for (int i = 0; i < LTA_WINDOW; i++) {
-        ltaBuffer[i] = 0.0f;
-    }
 }
 
 bool Seismograph::begin() {
-    Serial.println("Initializing MPU6050...");
-    
-    mpu.initialize();
-    
-    if (!mpu.testConnection()) {
+    Serial.printf("Initializing MPU6050 array (%d sensor%s)...\n", SENSOR_COUNT, SENSOR_COUNT > 1 ? "s" : "");
+    
+    int presentCount = 0;
+    for (int s = 0; s < SENSOR_COUNT; s++) {
+        // Same library defaults on every sensor, so all run the same DLPF and rate
+        MPU6050 device(sensors[s].address);
+        device.initialize();
+        sensors[s].present = device.testConnection();
+        if (sensors[s].present) {
+            presentCount++;
+        } else {
+            Serial.printf("ERROR: MPU6050 at 0x%02X connection failed\n", sensors[s].address);
+        }
+    }
+    if (presentCount == 0) {
         Serial.println("ERROR: MPU6050 connection failed");
         return false;
     }
     
-    Serial.println("MPU6050 found, performing automatic sensor calibration...");
-    Serial.println("Please ensure the sensor is on a stable, level surface during calibration...");
+    // The library has configured the sensors; runtime reads go through the
+    // IDF I2C master (interrupt-driven, accel-only bursts, I2C_BUS_FREQUENCY_HZ)
+    Wire.end();
+    if (sensorBus.begin(I2C_BUS_PORT, I2C_SDA_PIN, I2C_SCL_PIN, I2C_BUS_FREQUENCY_HZ)) {
+        Serial.printf("I2C sensor bus: IDF master at %lu kHz\n", (unsigned long)I2C_BUS_FREQUENCY_HZ / 1000);
+    } else {
+        Serial.println("WARNING: IDF I2C master unavailable, staying on Wire");
+        Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
+        Wire.setClock(I2C_BUS_FREQUENCY_HZ);
+    }
+    
+    Serial.printf("%d of %d MPU6050 found, performing automatic sensor calibration...\n", presentCount, SENSOR_COUNT);
+    Serial.println("Please ensure the sensor is on a stable surface during calibration (any mounting orientation)...");
     
     // Wait a moment for sensor to stabilize
     delay(1000);
@@ -94,15 +147,20 @@ bool Seismograph::begin() {
     // Perform automatic calibration
     if (!calibrate()) {
         Serial.println("WARNING: Automatic sensor calibration failed");
-        Serial.println("System will continue with default calibration (no offsets)");
-        Serial.println("Event detection may be less accurate until proper calibration");
-        
-        // Set default calibration values
-        offsetX = 0.0f;
-        offsetY = 0.0f;
-        offsetZ = 0.0f;
-        calibrated = false;
-        calibrationValid = false;
+        if (calibrated) {
+            Serial.println("Sensors that failed calibration are left out of the combined channel");
+        } else {
+            Serial.println("System will continue with default calibration (no offsets)");
+            Serial.println("Event detection may be less accurate until proper calibration");
+            
+            // Set default calibration values
+            for (int s = 0; s < SENSOR_COUNT; s++) {
+                for (int axis = 0; axis < 3; axis++) sensors[s].offset[axis] = 0.0f;
+                resetOrientation(sensors[s]);
+            }
+            rebuildParameterBlock();
+            calibrationValid = false;
+        }
     }
     
     initialized = true;
@@ -122,28 +180,90 @@ bool Seismograph::begin() {
 bool Seismograph::calibrate() {
     Serial.println("Starting automatic sensor calibration...");
     
+    // Each sensor on its own, so a failed one does not void the others
+    bool allPassed = true;
+    calibrated = false;
+    for (int s = 0; s < SENSOR_COUNT; s++) {
+        if (!sensors[s].present) continue;
+        if (SENSOR_COUNT > 1) Serial.printf("Calibrating MPU6050 at 0x%02X...\n", sensors[s].address);
+        if (!calibrateSensor(sensors[s])) allPassed = false;
+        calibrated |= sensors[s].calibrated;
+    }
+    calibrationValid = allPassed;
+    if (!calibrated) return false;
+    
+    lastTempSample = millis();
+    lastCalibrationTime = millis();
+    rebuildParameterBlock();
+    
+    // The FIFOs kept filling (and overflowed) meanwhile: restart them
+    if (fifoMode) resetFifos();
+    
+    if (allPassed) Serial.println(">>> CALIBRATION SUCCESSFUL <<<");
+    
+    // Test calibration by taking a few test readings of the combined channel
+    if (detailedLoggingEnabled) Serial.println("Phase 4: Testing calibration...");
+    float testSumMagnitude = 0;
+    for (int i = 0; i < 10; i++) {
+        testSumMagnitude += readSensor().magnitudeG();
+        delay(10);
+    }
+    
+    float avgTestMagnitude = testSumMagnitude / 10;
+    baselineLTA = avgTestMagnitude; // Store baseline for drift detection
+    
+    if (detailedLoggingEnabled) {
+        Serial.printf("Post-calibration test magnitude: %.6f g\n", avgTestMagnitude);
+    
+        if (avgTestMagnitude > 0.1f) {
+            Serial.println(">>> WARNING: High post-calibration magnitude <<<");
+            Serial.printf("Expected: <0.1g, Measured: %.6f g\n", avgTestMagnitude);
+            Serial.println("Calibration may not be optimal");
+        } else {
+            Serial.println("✓ Calibration test passed");
+        }
+        
+        Serial.println("=== CALIBRATION COMPLETE ===\n");
+    }
+    return allPassed;
+}
+
+bool Seismograph::calibrateSensor(ArraySensor& sensor) {
     if(detailedLoggingEnabled) {
         Serial.println("=== ENHANCED SENSOR CALIBRATION ===");
         Serial.println("Starting automatic sensor calibration with validation...");
     }
     
     // Enhanced calibration with more samples and stability checking
-    const int samples = 200; // Increased from 100
-    const int stabilityCheckSamples = 50;
-    float readings[samples][3]; // Store all readings for analysis
+    const int samples = CALIBRATION_SAMPLES;
+    const int stabilityCheckSamples = STABILITY_CHECK_SAMPLES;
     float sumX = 0, sumY = 0, sumZ = 0;
-    int16_t ax, ay, az, gx, gy, gz;
+    int16_t ax, ay, az;
+    
+    // Calibration works in ±2 g counts
+    if (!resetAccelRange(sensor)) {
+        Serial.printf(">>> CALIBRATION FAILED: cannot reset 0x%02X to ±2 g <<<\n", sensor.address);
+        return false;
+    }
     
     // First, check sensor stability over a short period
     if (detailedLoggingEnabled) Serial.println("Phase 1: Checking sensor stability...");
     float stabilityReadings[stabilityCheckSamples][3];
     
-    for (int i = 0; i < stabilityCheckSamples; i++) {
-        mpu.getMotion6(&ax, &ay, &az, &gx, &gy, &gz);
-        stabilityReadings[i][0] = (float)ax / 16384.0f;
-        stabilityReadings[i][1] = (float)ay / 16384.0f;
-        stabilityReadings[i][2] = (float)az / 16384.0f;
+    // A failed read is skipped and taken again; stale or uninitialised
+    // values must not reach the statistics
+    int failedReads = 0;
+    for (int i = 0; i < stabilityCheckSamples; ) {
+        bool ok = readAccelRaw(sensor, ax, ay, az);
         delay(20); // Longer delay for stability
+        if (!ok) {
+            if (tooManyFailedReads(++failedReads, stabilityCheckSamples)) return false;
+            continue;
+        }
+        stabilityReadings[i][0] = (float)ax / MPU6050_ACCEL_SCALE;
+        stabilityReadings[i][1] = (float)ay / MPU6050_ACCEL_SCALE;
+        stabilityReadings[i][2] = (float)az / MPU6050_ACCEL_SCALE;
+        i++;
     }
     
     // Calculate standard deviation for stability check
@@ -170,7 +290,7 @@ bool Seismograph::calibrate() {
     if (detailedLoggingEnabled) Serial.printf("Stability check - StdDev: X=%.6f, Y=%.6f, Z=%.6f g\n", stdDevX, stdDevY, stdDevZ);
     
     // Check if sensor is stable enough for calibration
-    const float maxStdDev = 0.01f; // Maximum allowed standard deviation
+    const float maxStdDev = MAX_CALIBRATION_STDDEV;
     if (stdDevX > maxStdDev || stdDevY > maxStdDev || stdDevZ > maxStdDev) {
         Serial.println(">>> CALIBRATION FAILED: Sensor too unstable <<<");
         if (detailedLoggingEnabled) {
@@ -181,7 +301,6 @@ bool Seismograph::calibrate() {
             Serial.printf("  - Required stability: <%.3f g, Current: X=%.6f, Y=%.6f, Z=%.6f g\n", 
                           maxStdDev, stdDevX, stdDevY, stdDevZ);
         }
-        calibrationValid = false;
         return false;
     }
     
@@ -190,101 +309,81 @@ bool Seismograph::calibrate() {
         Serial.println("Phase 2: Collecting calibration samples...");
     }
     
-    // Collect calibration samples
-    for (int i = 0; i < samples; i++) {
-        mpu.getMotion6(&ax, &ay, &az, &gx, &gy, &gz);
-        
-        // Convert to g units and store
-        readings[i][0] = (float)ax / 16384.0f;
-        readings[i][1] = (float)ay / 16384.0f;
-        readings[i][2] = (float)az / 16384.0f;
+    // Collect calibration samples in the raw sensor frame (at rest the
+    // gyro reads its bias, so it is calibrated in the same pass)
+    float gyroSum[3] = { 0.0f, 0.0f, 0.0f };
+    failedReads = 0;
+    for (int i = 0; i < samples; ) {
+        int16_t accel[3];
+        int16_t gyro[3];
+        bool ok = readMotionRaw(sensor, accel, GYRO_CHANNELS_ENABLED ? gyro : nullptr);
+        delay(10);
+        if (!ok) {
+            if (tooManyFailedReads(++failedReads, samples)) return false;
+            continue;
+        }
         
-        sumX += readings[i][0];
-        sumY += readings[i][1];
-        sumZ += readings[i][2];
+        sumX += (float)accel[0] / MPU6050_ACCEL_SCALE;
+        sumY += (float)accel[1] / MPU6050_ACCEL_SCALE;
+        sumZ += (float)accel[2] / MPU6050_ACCEL_SCALE;
+        if (GYRO_CHANNELS_ENABLED) {
+            for (int axis = 0; axis < 3; axis++) gyroSum[axis] += gyro[axis];
+        }
         
         if (detailedLoggingEnabled && (i % 50 == 0)) {
             Serial.printf("Progress: %d/%d samples collected\n", i, samples);
         }
-        delay(10);
+        i++;
     }
+    if (detailedLoggingEnabled && failedReads > 0) Serial.printf("%d sensor reads failed and were repeated\n", failedReads);
     
-    // Calculate proposed offsets
-    float proposedOffsetX = sumX / samples;
-    float proposedOffsetY = sumY / samples;
-    float proposedOffsetZ = sumZ / samples; // FIXED: Don't subtract 1g - we want calibrated Z to be 0g
+    // Mean acceleration at rest is the gravity vector in sensor coordinates
+    float gravityX = sumX / samples;
+    float gravityY = sumY / samples;
+    float gravityZ = sumZ / samples;
+    float measuredGravity = sqrt(gravityX * gravityX + gravityY * gravityY + gravityZ * gravityZ);
     
     if (detailedLoggingEnabled) {
-        Serial.println("Phase 3: Validating calibration values...");
-        Serial.printf("Proposed offsets: X=%.6f, Y=%.6f, Z=%.6f g\n", 
-                      proposedOffsetX, proposedOffsetY, proposedOffsetZ);
+        Serial.println("Phase 3: Estimating mounting orientation...");
+        Serial.printf("Gravity vector (sensor frame): X=%.6f, Y=%.6f, Z=%.6f g (|g|=%.6f g)\n", 
+                      gravityX, gravityY, gravityZ, measuredGravity);
     }
     
-    // Validate calibration values with separate limits for X/Y and Z axes
-    const float maxOffsetXY = 0.5f; // Maximum reasonable offset for X/Y axes
-    const float minZOffset = 0.8f;  // Minimum Z-axis offset (gravity)
-    const float maxZOffset = 1.5f;  // Maximum Z-axis offset (gravity)
-    const float minZValue = 0.8f;   // Minimum Z-axis raw value (should be close to 1g)
-    const float maxZValue = 1.5f;   // Maximum Z-axis raw value
-    
-    float rawZMean = sumZ / samples;
-    
-    // Check if X/Y offsets are reasonable (should be small)
-    if (abs(proposedOffsetX) > maxOffsetXY || abs(proposedOffsetY) > maxOffsetXY) {
-        Serial.println(">>> CALIBRATION FAILED: Unreasonable X/Y offset values <<<");
+    // Any mounting orientation is accepted, but |g| itself must be plausible
+    if (measuredGravity < MIN_GRAVITY_MAGNITUDE || measuredGravity > MAX_GRAVITY_MAGNITUDE) {
+        Serial.println(">>> CALIBRATION FAILED: Gravity magnitude unreasonable <<<");
         if (detailedLoggingEnabled) {
-            Serial.printf("Maximum allowed X/Y offset: ±%.2f g\n", maxOffsetXY);
-            Serial.printf("Calculated X/Y offsets: X=%.6f, Y=%.6f g\n", 
-                          proposedOffsetX, proposedOffsetY);
+            Serial.printf("Expected |g|: %.1f-%.1f g, Measured: %.6f g\n", 
+                          MIN_GRAVITY_MAGNITUDE, MAX_GRAVITY_MAGNITUDE, measuredGravity);
             Serial.println("Possible causes:");
-            Serial.println("  - Sensor not level/horizontal");
-            Serial.println("  - Sensor orientation incorrect");
+            Serial.println("  - Wrong accelerometer full-scale range");
+            Serial.println("  - Sensor accelerating during calibration");
             Serial.println("  - Hardware malfunction");
         }
-        calibrationValid = false;
         return false;
     }
     
-    // Check if Z offset is reasonable (should be close to 1g for gravity)
-    if (abs(proposedOffsetZ) < minZOffset || abs(proposedOffsetZ) > maxZOffset) {
-        Serial.println(">>> CALIBRATION FAILED: Unreasonable Z-axis offset value <<<");
-        if (detailedLoggingEnabled) {
-            Serial.printf("Expected Z-axis offset: %.1f-%.1f g (gravity), Calculated: %.6f g\n", 
-                          minZOffset, maxZOffset, proposedOffsetZ);
-            Serial.printf("Raw Z-axis reading: %.6f g\n", rawZMean);
-            Serial.println("Possible causes:");
-            Serial.println("  - Sensor not horizontal (Z-axis not pointing up/down)");
-            Serial.println("  - Wrong sensor orientation");
-            Serial.println("  - Gravity vector not aligned with Z-axis");
-            Serial.println("  - Hardware malfunction");
-        }
-        calibrationValid = false;
-        return false;
-    }
+    // Build the rotation into the Z-up frame; rotated gravity becomes (0, 0, |g|)
+    computeOrientation(sensor, gravityX, gravityY, gravityZ);
     
-    // Check if Z-axis reading is reasonable (should be close to 1g when level)
-    if (rawZMean < minZValue || rawZMean > maxZValue) {
-        Serial.println(">>> CALIBRATION FAILED: Z-axis reading unreasonable <<<");
-        if (detailedLoggingEnabled) {
-            Serial.printf("Expected Z-axis: %.1f-%.1f g, Measured: %.6f g\n", minZValue, maxZValue, rawZMean);
-            Serial.println("Possible causes:");
-            Serial.println("  - Sensor not horizontal");
-            Serial.println("  - Wrong sensor orientation");
-            Serial.println("  - Gravity vector not aligned with Z-axis");
-        }
-        calibrationValid = false;
-        return false;
+    float proposedOffsetX, proposedOffsetY, proposedOffsetZ;
+    applyOrientation(sensor, gravityX, gravityY, gravityZ, proposedOffsetX, proposedOffsetY, proposedOffsetZ);
+    
+    if (detailedLoggingEnabled) {
+        Serial.printf("Mounting tilt: %.2f deg from vertical\n", sensor.mountingTiltDeg);
+        Serial.printf("Proposed offsets (Z-up frame): X=%.6f, Y=%.6f, Z=%.6f g\n", 
+                      proposedOffsetX, proposedOffsetY, proposedOffsetZ);
     }
     
     // Compare with previous calibration if available
     if (detailedLoggingEnabled && lastCalibrationTime > 0) {
-        float deltaX = abs(proposedOffsetX - lastCalibrationOffsets[0]);
-        float deltaY = abs(proposedOffsetY - lastCalibrationOffsets[1]);
-        float deltaZ = abs(proposedOffsetZ - lastCalibrationOffsets[2]);
+        float deltaX = abs(proposedOffsetX - sensor.lastCalibrationOffsets[0]);
+        float deltaY = abs(proposedOffsetY - sensor.lastCalibrationOffsets[1]);
+        float deltaZ = abs(proposedOffsetZ - sensor.lastCalibrationOffsets[2]);
         
         Serial.println("Comparison with previous calibration:");
         Serial.printf("Previous offsets: X=%.6f, Y=%.6f, Z=%.6f g\n", 
-                      lastCalibrationOffsets[0], lastCalibrationOffsets[1], lastCalibrationOffsets[2]);
+                      sensor.lastCalibrationOffsets[0], sensor.lastCalibrationOffsets[1], sensor.lastCalibrationOffsets[2]);
         Serial.printf("Offset changes: X=%.6f, Y=%.6f, Z=%.6f g\n", deltaX, deltaY, deltaZ);
         
         const float maxDrift = 0.1f; // Maximum allowed drift
@@ -299,398 +398,987 @@ bool Seismograph::calibrate() {
     }
     
     // Apply calibration
-    offsetX = proposedOffsetX;
-    offsetY = proposedOffsetY;
-    offsetZ = proposedOffsetZ;
-    
-    // Store calibration for future comparison
-    lastCalibrationOffsets[0] = offsetX;
-    lastCalibrationOffsets[1] = offsetY;
-    lastCalibrationOffsets[2] = offsetZ;
-    lastCalibrationTime = millis();
-    
-    calibrated = true;
-    calibrationValid = true;
-    
-    Serial.println(">>> CALIBRATION SUCCESSFUL <<<");
+    sensor.offset[0] = proposedOffsetX;
+    sensor.offset[1] = proposedOffsetY;
+    sensor.offset[2] = proposedOffsetZ;
+    sensor.gravityMagnitude = measuredGravity;
+#if GYRO_CHANNELS_ENABLED
+    for (int axis = 0; axis < 3; axis++) sensor.gyroBias[axis] = gyroSum[axis] / samples;
     if (detailedLoggingEnabled) {
-        Serial.printf("Final offsets: X=%.6f, Y=%.6f, Z=%.6f g\n", offsetX, offsetY, offsetZ);
-        Serial.printf("Calibration timestamp: %lu ms\n", lastCalibrationTime);
+        Serial.printf("Gyro bias: X=%.3f, Y=%.3f, Z=%.3f deg/s\n", sensor.gyroBias[0] / MPU6050_GYRO_SCALE,
+                      sensor.gyroBias[1] / MPU6050_GYRO_SCALE, sensor.gyroBias[2] / MPU6050_GYRO_SCALE);
     }
+#endif
     
-    // Test calibration by taking a few test readings
-    if (detailedLoggingEnabled) Serial.println("Phase 4: Testing calibration...");
-    float testSumMagnitude = 0;
-    for (int i = 0; i < 10; i++) {
-        mpu.getMotion6(&ax, &ay, &az, &gx, &gy, &gz);
-        float testX = ((float)ax / 16384.0f) - offsetX;
-        float testY = ((float)ay / 16384.0f) - offsetY;
-        float testZ = ((float)az / 16384.0f) - offsetZ;
-        float testMagnitude = sqrt(testX*testX + testY*testY + testZ*testZ);
-        testSumMagnitude += testMagnitude;
-        delay(10);
-    }
+    // Store calibration for future comparison
+    for (int axis = 0; axis < 3; axis++) sensor.lastCalibrationOffsets[axis] = sensor.offset[axis];
     
-    float avgTestMagnitude = testSumMagnitude / 10;
-    baselineLTA = avgTestMagnitude; // Store baseline for drift detection
+    // Offsets are now zero at the current die temperature - restart the drift model
+    float referenceTemp;
+    if (!readTemperature(sensor, referenceTemp)) referenceTemp = sensor.tempCompensator.getReferenceTemp();
+    sensor.tempCompensator.reset(referenceTemp);
+    sensor.tempAxisSum[0] = sensor.tempAxisSum[1] = sensor.tempAxisSum[2] = 0;
+    sensor.tempAxisCount = 0;
+    sensor.calibrated = true;
     
     if (detailedLoggingEnabled) {
-        Serial.printf("Post-calibration test magnitude: %.6f g\n", avgTestMagnitude);
-    
-        if (avgTestMagnitude > 0.1f) {
-            Serial.println(">>> WARNING: High post-calibration magnitude <<<");
-            Serial.printf("Expected: <0.1g, Measured: %.6f g\n", avgTestMagnitude);
-            Serial.println("Calibration may not be optimal");
-        } else {
-            Serial.println("✓ Calibration test passed");
-        }
-        
-        Serial.println("=== CALIBRATION COMPLETE ===\n");
+        Serial.printf("Final offsets: X=%.6f, Y=%.6f, Z=%.6f g\n", sensor.offset[0], sensor.offset[1], sensor.offset[2]);
+        Serial.printf("Reference die temperature: %.2f C\n", sensor.tempCompensator.getReferenceTemp());
     }
     return true;
 }
 
+bool Seismograph::tooManyFailedReads(int failedReads, int wantedReads) {
+    if (failedReads * 100 <= wantedReads * CALIBRATION_MAX_FAILED_READS_PCT) return false;
+    Serial.printf(">>> CALIBRATION FAILED: %d sensor reads failed (limit %d%% of %d) <<<\n",
+                  failedReads, CALIBRATION_MAX_FAILED_READS_PCT, wantedReads);
+    return true;
+}
+
 SensorData Seismograph::readSensor() {
+    // Single calibrated reading (mean of the array) for the calibration
+    // check; does not feed the pipeline and must not run beside the sensor
+    // task, which owns the bus and the read counters
     SensorData data;
     data.timestamp = millis();
-    
-    if (!initialized) {
-        data.accelX = data.accelY = data.accelZ = data.magnitude = 0.0f;
+    data.rangeShift = 0;
+#if GYRO_CHANNELS_ENABLED
+    data.rateX = data.rateY = data.rateZ = 0.0f;
+#endif
+    
+    int16_t xyz[3 * SENSOR_COUNT];
+    uint8_t mask = readRawSample(xyz);
+    SampleFormat::AxisSum sum[3] = { 0, 0, 0 };
+    int members = 0;
+    for (int s = 0; s < SENSOR_COUNT; s++) {
+        if (!(mask & (1 << s)) || !isMember(sensors[s])) continue;
+        const int16_t* raw = xyz + 3 * s;
+        for (int axis = 0; axis < 3; axis++) {
+            sum[axis] += SampleFormat::subtract(SampleFormat::rotate(sensors[s].rotationCoefficients[axis], raw[0], raw[1], raw[2],
+                                                                     sensors[s].rangeShift),
+                                                sensors[s].sampleOffsets[axis]);
+        }
+        if (sensors[s].rangeShift > data.rangeShift) data.rangeShift = sensors[s].rangeShift;
+        members++;
+    }
+    if (members == 0) {
+        data.accelX = data.accelY = data.accelZ = 0;
         return data;
     }
     
-    int16_t ax, ay, az, gx, gy, gz;
-    mpu.getMotion6(&ax, &ay, &az, &gx, &gy, &gz);
-    
-    // Convert to g units using MPU6050 scale constant - RAW VALUES
-    float rawX = (float)ax / MPU6050_ACCEL_SCALE;
-    float rawY = (float)ay / MPU6050_ACCEL_SCALE;
-    float rawZ = (float)az / MPU6050_ACCEL_SCALE;
-    float rawMagnitude = sqrt(rawX*rawX + rawY*rawY + rawZ*rawZ);
+    data.accelX = SampleFormat::mean(sum[0], members);
+    data.accelY = SampleFormat::mean(sum[1], members);
+    data.accelZ = SampleFormat::mean(sum[2], members);
+    return data;
+}
+
+uint8_t Seismograph::readRawSample(int16_t* xyz, int16_t* gyro) {
+    // Back-to-back reads, all sensors stamped with the same tick
+    uint8_t mask = 0;
+    uint64_t firstUs = 0;
+    uint64_t lastUs = 0;
+    for (int s = 0; s < SENSOR_COUNT; s++) {
+        ArraySensor& sensor = sensors[s];
+        if (!sensor.present) continue;
+        
+        uint64_t startUs = (uint64_t)esp_timer_get_time();
+        if (mask == 0) firstUs = startUs;
+        lastUs = startUs;
+        if (readMotionRaw(sensor, xyz + 3 * s, gyro != nullptr ? gyro + 3 * s : nullptr)) {
+            mask |= 1 << s;
+        } else {
+            sensor.readErrors++;
+        }
+    }
     
-    // Apply calibration
-    data.accelX = rawX - offsetX;
-    data.accelY = rawY - offsetY;
-    data.accelZ = rawZ - offsetZ;
-    
-    // Calculate magnitude after calibration
-    data.magnitude = calculateMagnitude(data.accelX, data.accelY, data.accelZ);
-    
-    // Log raw vs calibrated values periodically for debugging
-    static unsigned long lastRawLog = 0;
-    if (detailedLoggingEnabled && (millis() - lastRawLog > detailedLoggingInterval)) {
-        Serial.printf("=== RAW vs CALIBRATED COMPARISON ===\n");
-        Serial.printf("RAW values: X=%.6f, Y=%.6f, Z=%.6f g (magnitude: %.6f g)\n", 
-                      rawX, rawY, rawZ, rawMagnitude);
-        Serial.printf("CALIBRATED values: X=%.6f, Y=%.6f, Z=%.6f g (magnitude: %.6f g)\n", 
-                      data.accelX, data.accelY, data.accelZ, data.magnitude);
-        Serial.printf("Applied offsets: X=%.6f, Y=%.6f, Z=%.6f g\n", 
-                      offsetX, offsetY, offsetZ);
-        Serial.printf("Magnitude reduction: %.6f g -> %.6f g (%.2f%% reduction)\n", 
-                      rawMagnitude, data.magnitude, 
-                      ((rawMagnitude - data.magnitude) / rawMagnitude) * 100.0f);
-        Serial.println("=== RAW vs CALIBRATED END ===\n");
-        lastRawLog = millis();
-    }
-    
-    lastMagnitude = data.magnitude;
-    totalSamples++;
+    uint32_t skewUs = (uint32_t)(lastUs - firstUs);
+    if (skewUs > maxReadSkewUs) maxReadSkewUs = skewUs;
+    return mask;
+}
+
+bool Seismograph::readAccelRaw(const ArraySensor& sensor, int16_t& ax, int16_t& ay, int16_t& az) {
+    int16_t xyz[3];
+    if (!readMotionRaw(sensor, xyz, nullptr)) return false;
+    ax = xyz[0];
+    ay = xyz[1];
+    az = xyz[2];
+    return true;
+}
+
+void Seismograph::updateAccelRange(ArraySensor& sensor, uint16_t rawPeak) {
+    // One step up per clipped block; down only after ACCEL_RANGE_HOLD_MS with
+    // the peak inside ACCEL_RANGE_DOWN_FRACTION of the lower range
+    unsigned long now = millis();
+    if (rawPeak >= ACCEL_CLIP_COUNTS) {
+        sensor.rangeQuietSinceMs = now;
+        if (sensor.rangeShift < ACCEL_RANGE_MAX_SHIFT) setAccelRange(sensor, sensor.rangeShift + 1);
+        return;
+    }
+    if (sensor.rangeShift == 0) return;
     
-    return data;
+    // The same acceleration reads twice the counts one range lower
+    if (2 * (uint32_t)rawPeak >= (uint32_t)(ACCEL_RANGE_DOWN_FRACTION * 32768.0f)) {
+        sensor.rangeQuietSinceMs = now;
+    } else if (now - sensor.rangeQuietSinceMs >= ACCEL_RANGE_HOLD_MS) {
+        setAccelRange(sensor, sensor.rangeShift - 1);
+    }
 }
 
-void Seismograph::processData(SensorData data) {
-    // Detailed logging for debugging
-    static unsigned long lastDetailedLog = 0;
-    static unsigned long sampleCounter = 0;
-    sampleCounter++;
-    
-    // Use configurable logging interval and enable/disable flag
-    bool shouldLogDetails = detailedLoggingEnabled && 
-                           (millis() - lastDetailedLog > detailedLoggingInterval);
-    
-    if (shouldLogDetails) {
-        Serial.printf("=== SENSOR ANALYSIS (Sample #%lu) ===\n", sampleCounter);
-        Serial.printf("Raw magnitude: %.6f g (AFTER calibration)\n", data.magnitude);
-        Serial.printf("Raw components: X=%.6f, Y=%.6f, Z=%.6f g (AFTER calibration)\n", 
-                      data.accelX, data.accelY, data.accelZ);
-        Serial.printf("Calibration offsets: X=%.6f, Y=%.6f, Z=%.6f g\n", 
-                      offsetX, offsetY, offsetZ);
-        Serial.printf("Detailed logging: %s (interval: %lu ms)\n", 
-                      detailedLoggingEnabled ? "ENABLED" : "DISABLED", detailedLoggingInterval);
-        lastDetailedLog = millis();
+bool Seismograph::setAccelRange(ArraySensor& sensor, uint8_t rangeShift) {
+    if (sensorBus.isActive()) {
+        if (!sensorBus.setAccelRange(sensor.address, rangeShift)) return false;
+    } else {
+        MPU6050 device(sensor.address);
+        device.setFullScaleAccelRange(rangeShift);
     }
     
-    // Apply spike filtering with detailed logging
-    if (isSpikeFiltered(data.magnitude)) {
-        spikesFiltered++;
-        if (shouldLogDetails) {
-            Serial.printf("SPIKE FILTERED: Magnitude %.6f g rejected\n", data.magnitude);
-        }
-        return; // Skip this sample
+    if (detailedLoggingEnabled) {
+        Serial.printf("Accel range 0x%02X: ±%d g -> ±%d g\n", sensor.address, 2 << sensor.rangeShift, 2 << rangeShift);
     }
+    sensor.rangeShift = rangeShift;
+    sensor.rangeSwitches++;
+    sensor.rangeQuietSinceMs = millis();
     
-    if (shouldLogDetails) {
-        Serial.printf("Sample ACCEPTED: Magnitude %.6f g passed spike filter\n", data.magnitude);
+    // Reads still in the FIFO were taken with the old range; drop them
+    // (on every sensor, so the runs stay aligned)
+    if (fifoMode) resetFifos();
+    return true;
+}
+
+bool Seismograph::resetAccelRange(ArraySensor& sensor) {
+    // Back to ±2 g with the auto-range state cleared. Runs before the tasks
+    // start or on the sensor task between blocks, so no block read at one
+    // range is scaled with the other.
+    if (sensor.rangeShift != 0 && !setAccelRange(sensor, 0)) return false;
+    sensor.rangeQuietSinceMs = millis();
+    blockRangeShift = 0;
+    blockClipped = false;
+    return true;
+}
+
+bool Seismograph::startFifo() {
+    // The FIFO is read through the IDF master only
+    if (!sensorBus.isActive()) return false;
+    
+    uint8_t divider = 8000 / ACQUISITION_RATE - 1;
+    for (int s = 0; s < SENSOR_COUNT; s++) {
+        if (!sensors[s].present) continue;
+        if (!sensorBus.beginFifo(sensors[s].address, divider, LOW_POWER_FIFO_WAKE)) {
+            Serial.printf("ERROR: MPU6050 0x%02X FIFO setup failed\n", sensors[s].address);
+            stopFifo();
+            return false;
+        }
+    }
+#if GYRO_CHANNELS_ENABLED
+    gyroEnabled = false;
+#endif
+    fifoMode = true;
+    resetFifos();
+    return true;
+}
+
+void Seismograph::stopFifo() {
+    for (int s = 0; s < SENSOR_COUNT; s++) {
+        if (sensors[s].present) sensorBus.endFifo(sensors[s].address);
+    }
+    fifoMode = false;
+}
+
+void Seismograph::resetFifos() {
+    // Back to back, so all sensors start their next read together
+    fifoRestarts++;
+    for (int s = 0; s < SENSOR_COUNT; s++) {
+        if (sensors[s].present) sensorBus.resetFifo(sensors[s].address);
+    }
+}
+
+size_t Seismograph::readFifoBatch(int16_t* xyz, size_t maxCount, uint8_t& sensorMask, bool& overflow) {
+    // Take as many reads as the emptiest FIFO holds, so every sensor's run
+    // covers the same ticks; xyz gets one run of count triples per sensor
+    sensorMask = 0;
+    overflow = false;
+    size_t count = maxCount;
+    size_t most = 0;
+    for (int s = 0; s < SENSOR_COUNT; s++) {
+        ArraySensor& sensor = sensors[s];
+        if (!sensor.present) continue;
+        
+        uint16_t bytes;
+        bool sensorOverflow;
+        if (!sensorBus.readFifoStatus(sensor.address, bytes, sensorOverflow)) {
+            sensor.readErrors++;
+            continue;
+        }
+        overflow |= sensorOverflow;
+        size_t reads = bytes / 6;
+        if (reads < count) count = reads;
+        if (reads > most) most = reads;
+        sensorMask |= 1 << s;
     }
     
-    // Update magnitude buffer for spike detection
-    lastMagnitudes[magnitudeIndex] = data.magnitude;
-    magnitudeIndex = (magnitudeIndex + 1) % 5;
-    if (magnitudeIndex == 0) magnitudeBufferFull = true;
+    // An overflowed FIFO has lost reads: the batch would not be contiguous
+    if (overflow) {
+        fifoOverflows++;
+        resetFifos();
+        sensorMask = 0;
+        return 0;
+    }
+    if (sensorMask == 0 || count == 0) return 0;
     
-    // Update adaptive thresholds periodically
-    updateAdaptiveThresholds();
+    for (int s = 0; s < SENSOR_COUNT; s++) {
+        if (!(sensorMask & (1 << s))) continue;
+        if (!sensorBus.readFifoAccel(sensors[s].address, xyz + 3 * count * s, count)) {
+            sensors[s].readErrors++;
+            sensorMask &= ~(1 << s);
+        }
+    }
+    // No run read completely: where the FIFOs stand is unknown
+    if (sensorMask == 0) {
+        resetFifos();
+        return 0;
+    }
     
-    // Update STA/LTA algorithm
-    updateSTALTA(data.magnitude);
+    // Sensor clocks drift apart (or a failed read left one behind): restart together
+    if (most - count > FIFO_MAX_SKEW_READS) {
+        fifoResyncs++;
+        resetFifos();
+    }
+    return count;
+}
+
+bool Seismograph::readMotionRaw(const ArraySensor& sensor, int16_t* accel, int16_t* gyro) {
+    if (sensorBus.isActive()) {
+        // Accel-only unless the rotational channels are wanted
+        return gyro != nullptr ? sensorBus.readMotion(sensor.address, accel, gyro)
+                               : sensorBus.readAccel(sensor.address, accel);
+    }
     
-    // Log STA/LTA analysis
-    if (shouldLogDetails && staFull && ltaFull) {
-        float sta = staSum / STA_WINDOW;
-        float lta = ltaSum / LTA_WINDOW;
-        float ratio = (lta > 0) ? sta / lta : 0;
-        Serial.printf("STA/LTA Analysis: STA=%.6f, LTA=%.6f, Ratio=%.2f (Trigger at %.2f)\n", 
-                      sta, lta, ratio, STA_LTA_RATIO);
+    // Wire fallback if the IDF driver could not take over the port: one
+    // burst over accel (temperature, gyro), so a NACK or short read shows
+    uint8_t buffer[14];
+    uint8_t length = gyro != nullptr ? 14 : 6;
+    if (I2Cdev::readBytes(sensor.address, MPU6050_RA_ACCEL_XOUT_H, length, buffer) != length) return false;
+    for (int axis = 0; axis < 3; axis++) {
+        accel[axis] = (int16_t)((buffer[2 * axis] << 8) | buffer[2 * axis + 1]);
+        if (gyro != nullptr) gyro[axis] = (int16_t)((buffer[8 + 2 * axis] << 8) | buffer[9 + 2 * axis]);
+    }
+    return true;
+}
+
+void Seismograph::injectSynthetic(int16_t* xyz, size_t count) {
+    float offset[3];
+    for (size_t i = 0; i < count; i++) {
+        if (!injector.next(offset[0], offset[1], offset[2])) return;
         
-        if (ratio > STA_LTA_RATIO) {
-            Serial.printf(">>> STA/LTA TRIGGER CONDITION MET! <<<\n");
-        } else {
-            Serial.printf("STA/LTA below trigger threshold\n");
+        // Same ground motion on every sensor of the array
+        for (int s = 0; s < SENSOR_COUNT; s++) {
+            const ArraySensor& sensor = sensors[s];
+            int16_t* raw = xyz + 3 * (s * count + i);
+            
+            // Z-up frame back to the sensor frame (transpose of the rotation)
+            for (int axis = 0; axis < 3; axis++) {
+                float g = sensor.rotationMatrix[0][axis] * offset[0] +
+                          sensor.rotationMatrix[1][axis] * offset[1] +
+                          sensor.rotationMatrix[2][axis] * offset[2];
+                int32_t counts = raw[axis] + (int32_t)lroundf(g * MPU6050_ACCEL_SCALE / (1 << sensor.rangeShift));
+                // Saturate like the ADC would
+                raw[axis] = (int16_t)constrain(counts, (int32_t)-32768, (int32_t)32767);
+            }
         }
     }
+}
+
+size_t Seismograph::processBlock(const int16_t* xyz, size_t count, uint64_t t0, uint8_t sensorMask,
+                                 const int16_t* gyro, SensorData* samples) {
+    // xyz holds one run of count interleaved raw X/Y/Z triples per sensor,
+    // t0 is the first sample time in us; sensorMask marks the sensors read.
+    // gyro, if not null, has the same layout with the angular rates.
+    // samples, if not null, receives every calibrated output sample.
+    if (count == 0) return 0;
+    
+    size_t stride = 3 * count;
+    for (int s = 0; s < SENSOR_COUNT; s++) {
+        if (!(sensorMask & (1 << s))) continue;
+        lastRaw[0] = xyz[s * stride + 3 * (count - 1)];
+        lastRaw[1] = xyz[s * stride + 3 * (count - 1) + 1];
+        lastRaw[2] = xyz[s * stride + 3 * (count - 1) + 2];
+        lastRawShift = sensors[s].rangeShift;
+        break;
+    }
     
-    // Check for event trigger with detailed logging
-    bool triggerCondition = checkEventTrigger();
-    if (triggerCondition) {
-        if (!eventActive) {
-            if (shouldLogDetails) {
-                Serial.printf(">>> NEW EVENT TRIGGERED! <<<\n");
-            }
-            startEvent(data.magnitude);
-        } else {
-            // Update ongoing event
-            if (data.magnitude > eventMaxMagnitude) {
-                eventMaxMagnitude = data.magnitude;
-                if (shouldLogDetails) {
-                    Serial.printf("Event magnitude updated: %.6f g (new max)\n", data.magnitude);
+    size_t blockSize = 0;
+    size_t produced = 0;
+    size_t lastOutputs = 0;
+    bool bandWindowDone = false;
+    while (count > 0) {
+        blockSize = count < StationPipeline::Block::CAPACITY ? count : StationPipeline::Block::CAPACITY;
+        if (calibrateBlock(xyz, gyro, stride, blockSize, sensorMask)) {
+            // Down to SAMPLING_RATE; with oversampling most reads produce no output
+            size_t firstIndex = 0;
+            size_t outputs = decimateBlock(blockSize, firstIndex);
+            if (outputs > 0) {
+                uint64_t outputT0 = t0 + firstIndex * (uint64_t)ACQUISITION_PERIOD_US;
+#if OVERSAMPLE_FACTOR > 1
+                outputT0 -= decimator.groupDelayUs();
+#endif
+                finishBlock(outputs);
+                if (samples != nullptr) exportSamples(samples + produced, outputs, outputT0);
+                for (size_t i = 0; i < outputs; i++) {
+                    bandWindowDone |= bandMonitor.addSample(SampleFormat::toG(block.x[i]),
+                                                            SampleFormat::toG(block.y[i]),
+                                                            SampleFormat::toG(block.z[i]));
                 }
+                // Before the stages: the estimator integrates the unfiltered vertical
+                if (EARLY_MAG_ENABLED) earlyMagnitude.addBlock(block.z, outputs, outputT0);
+                lastSample.timestamp = (unsigned long)((outputT0 + (outputs - 1) * (uint64_t)SAMPLING_PERIOD_US) / 1000);
+                portENTER_CRITICAL(&sampleLock);
+                publishedSample = lastSample;
+                portEXIT_CRITICAL(&sampleLock);
+                blockStartUs = outputT0;
+                runPipeline(outputs);
+                produced += outputs;
+                lastOutputs = outputs;
             }
-            eventSumMagnitude += data.magnitude;
-            eventSampleCount++;
-        }
-    } else if (eventActive) {
-        // Check if event should end
-        unsigned long eventDuration = millis() - eventStartTime;
-        if (eventDuration >= MIN_EVENT_DURATION) {
-            if (shouldLogDetails) {
-                Serial.printf("Event ending: Duration %lu ms >= minimum %d ms\n", 
-                              eventDuration, MIN_EVENT_DURATION);
+            
+            // Range of this block goes with the event; the switch applies
+            // from the next read on, so every sample keeps its own scale
+            if (eventActive) {
+                if (blockRangeShift > eventRangeShift) eventRangeShift = blockRangeShift;
+                eventClipped |= blockClipped;
+            }
+            if (ACCEL_AUTO_RANGE) {
+                for (int s = 0; s < SENSOR_COUNT; s++) {
+                    if ((sensorMask & (1 << s)) && isMember(sensors[s])) updateAccelRange(sensors[s], arrayBlock.rawPeak[s]);
+                }
             }
-            endEvent();
-        } else if (shouldLogDetails) {
-            Serial.printf("Event continues: Duration %lu ms < minimum %d ms\n", 
-                          eventDuration, MIN_EVENT_DURATION);
         }
+        
+        xyz += 3 * blockSize;
+        if (gyro != nullptr) gyro += 3 * blockSize;
+        t0 += blockSize * (uint64_t)ACQUISITION_PERIOD_US;
+        count -= blockSize;
+    }
+    if (produced == 0) return 0;
+    
+    // Band energy jump in a trigger band opens an event the STA/LTA missed
+    if (BAND_TRIGGER_ENABLED && bandWindowDone && !eventActive &&
+        bandMonitor.isTriggered() && !bandMonitor.isVetoed()) {
+        bandTriggers++;
+        startEvent(lastSample.magnitudeG(), blockStartUs + (lastOutputs - 1) * (uint64_t)SAMPLING_PERIOD_US);
     }
     
-    // Check for calibration drift periodically
+    // Learn temperature-dependent offset drift (model runs once per TEMP_SAMPLE_INTERVAL)
+    if (millis() - lastTempSample >= TEMP_SAMPLE_INTERVAL) {
+        updateTemperatureModel();
+    }
+    
+    // Periodic housekeeping runs once per block, not per sample
+    updateAdaptiveThresholds();
     checkCalibrationDrift();
     
-    // Log threshold comparison
-    if (shouldLogDetails) {
-        Serial.printf("Threshold Analysis:\n");
-        Serial.printf("  Magnitude: %.6f g\n", data.magnitude);
-        Serial.printf("  Micro threshold (%.6f g): %s\n", THRESHOLD_MICRO, 
-                      data.magnitude >= THRESHOLD_MICRO ? "EXCEEDED" : "below");
-        Serial.printf("  Light threshold (%.6f g): %s\n", THRESHOLD_LIGHT, 
-                      data.magnitude >= THRESHOLD_LIGHT ? "EXCEEDED" : "below");
-        Serial.printf("  Strong threshold (%.6f g): %s\n", THRESHOLD_STRONG, 
-                      data.magnitude >= THRESHOLD_STRONG ? "EXCEEDED" : "below");
+    static unsigned long lastDetailedLog = 0;
+    if (detailedLoggingEnabled && (millis() - lastDetailedLog > detailedLoggingInterval)) {
+        logProcessingDetails(lastOutputs - 1);
+        lastDetailedLog = millis();
+    }
+    return produced;
+}
+
+bool Seismograph::calibrateBlock(const int16_t* xyz, const int16_t* gyro, size_t stride, size_t count, uint8_t sensorMask) {
+    // Rotate each sensor into the Z-up frame and remove its offsets (static
+    // calibration + temperature compensation, precombined per axis), one
+    // axis per loop. The temperature models' axis sums are accumulated in
+    // the same pass.
+    int members[SENSOR_COUNT];
+    int memberCount = 0;
+    blockRangeShift = 0;
+    blockClipped = false;
+    for (int s = 0; s < SENSOR_COUNT; s++) {
+        ArraySensor& sensor = sensors[s];
+        if (!(sensorMask & (1 << s)) || !isMember(sensor)) continue;
+        members[memberCount++] = s;
         
-        // Add calibration status to detailed logging
-        Serial.printf("Calibration Status:\n");
-        Serial.printf("  Calibration valid: %s\n", calibrationValid ? "YES" : "NO");
-        Serial.printf("  Calibration age: %lu ms\n", millis() - lastCalibrationTime);
-        if (ltaFull && baselineLTA > 0) {
-            float currentLTA = ltaSum / LTA_WINDOW;
-            float driftPercent = ((currentLTA - baselineLTA) / baselineLTA) * 100.0f;
-            Serial.printf("  Baseline LTA: %.6f g\n", baselineLTA);
-            Serial.printf("  Current LTA: %.6f g\n", currentLTA);
-            Serial.printf("  Drift: %.2f%%\n", driftPercent);
+        const int16_t* raw = xyz + s * stride;
+        
+        // Clipping is judged on the raw counts, before rotation mixes axes
+        int32_t peak = 0;
+        for (size_t i = 0; i < 3 * count; i++) {
+            int32_t value = raw[i] < 0 ? -(int32_t)raw[i] : raw[i];
+            if (value > peak) peak = value;
+        }
+        arrayBlock.rawPeak[s] = (uint16_t)peak;
+        arrayBlock.rangeShift[s] = sensor.rangeShift;
+        if (sensor.rangeShift > blockRangeShift) blockRangeShift = sensor.rangeShift;
+        if (peak >= ACCEL_CLIP_COUNTS) {
+            sensor.clippedBlocks++;
+            blockClipped = true;
         }
-        Serial.println("=== END ANALYSIS ===\n");
+        
+        SampleFormat::Sample* axes[3] = { arrayBlock.x[s], arrayBlock.y[s], arrayBlock.z[s] };
+        for (int axis = 0; axis < 3; axis++) {
+            const SampleFormat::Coefficient* row = sensor.rotationCoefficients[axis];
+            SampleFormat::Sample offset = sensor.sampleOffsets[axis];
+            SampleFormat::Sample* out = axes[axis];
+            SampleFormat::AxisSum sum = 0;
+            for (size_t i = 0; i < count; i++) {
+                out[i] = SampleFormat::subtract(SampleFormat::rotate(row, raw[3 * i], raw[3 * i + 1], raw[3 * i + 2], sensor.rangeShift), offset);
+                sum += out[i];
+            }
+            sensor.tempAxisSum[axis] += sum;
+        }
+        sensor.tempAxisCount += count;
     }
+    if (memberCount == 0) return false;
+    
+    combineSensors(count, members, memberCount);
+    calibrateRates(gyro, stride, count, members, memberCount);
+    return true;
 }
 
-void Seismograph::simulateEvent(float richterMagnitude) {
-    // Convert Richter magnitude to realistic PGA using inverse formula
-    float realisticPGA = calculatePGAFromRichter(richterMagnitude);
+size_t Seismograph::decimateBlock(size_t count, size_t& firstIndex) {
+    firstIndex = 0;
+#if OVERSAMPLE_FACTOR > 1
+    SampleFormat::Sample* axes[3] = { block.x, block.y, block.z };
+    size_t outputs = decimator.processBlock(axes, count, firstIndex);
+#if GYRO_CHANNELS_ENABLED
+    // Fed on every read (zeros while off) so both decimators keep one phase
+    if (!blockHasRates) {
+        for (int axis = 0; axis < 3; axis++) memset(rateBlock[axis], 0, count * sizeof(float));
+    }
+    float* rates[3] = { rateBlock[0], rateBlock[1], rateBlock[2] };
+    size_t rateFirstIndex;
+    rateDecimator.processBlock(rates, count, rateFirstIndex);
+#endif
+    return outputs;
+#else
+    return count;
+#endif
+}
+
+void Seismograph::finishBlock(size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        block.magnitudeSq[i] = SampleFormat::magnitudeSquared(block.x[i], block.y[i], block.z[i]);
+    }
+    memcpy(block.inputMagnitudeSq, block.magnitudeSq, count * sizeof(block.magnitudeSq[0]));
+    
+    // Stages filter the block in place, so keep the calibrated last sample now
+    lastSample.accelX = block.x[count - 1];
+    lastSample.accelY = block.y[count - 1];
+    lastSample.accelZ = block.z[count - 1];
+    lastSample.rangeShift = blockRangeShift;
+#if GYRO_CHANNELS_ENABLED
+    lastSample.rateX = blockHasRates ? rateBlock[0][count - 1] : 0.0f;
+    lastSample.rateY = blockHasRates ? rateBlock[1][count - 1] : 0.0f;
+    lastSample.rateZ = blockHasRates ? rateBlock[2][count - 1] : 0.0f;
+#endif
+    totalSamples += count;
+}
+
+void Seismograph::exportSamples(SensorData* samples, size_t count, uint64_t t0) {
+    // Calibrated, before the stages filter the block in place
+    for (size_t i = 0; i < count; i++) {
+        SensorData& sample = samples[i];
+        sample.accelX = block.x[i];
+        sample.accelY = block.y[i];
+        sample.accelZ = block.z[i];
+        sample.timestamp = (unsigned long)((t0 + i * (uint64_t)SAMPLING_PERIOD_US) / 1000);
+        sample.rangeShift = blockRangeShift;
+#if GYRO_CHANNELS_ENABLED
+        sample.rateX = blockHasRates ? rateBlock[0][i] : 0.0f;
+        sample.rateY = blockHasRates ? rateBlock[1][i] : 0.0f;
+        sample.rateZ = blockHasRates ? rateBlock[2][i] : 0.0f;
+#endif
+    }
+}
+
+void Seismograph::calibrateRates(const int16_t* gyro, size_t stride, size_t count, const int* members, int memberCount) {
+#if GYRO_CHANNELS_ENABLED
+    // Bias removed in the sensor frame, then the accelerometer's rotation
+    // (angular rate is a vector like acceleration); mean of the same sensors
+    blockHasRates = gyro != nullptr;
+    if (!blockHasRates) return;
+    
+    const float scale = 1.0f / (MPU6050_GYRO_SCALE * memberCount);
+    for (int axis = 0; axis < 3; axis++) {
+        memset(rateBlock[axis], 0, count * sizeof(float));
+    }
+    for (int m = 0; m < memberCount; m++) {
+        const ArraySensor& sensor = sensors[members[m]];
+        const int16_t* raw = gyro + members[m] * stride;
+        for (int axis = 0; axis < 3; axis++) {
+            const float* row = sensor.rotationMatrix[axis];
+            float* out = rateBlock[axis];
+            for (size_t i = 0; i < count; i++) {
+                out[i] += (row[0] * (raw[3 * i] - sensor.gyroBias[0]) +
+                           row[1] * (raw[3 * i + 1] - sensor.gyroBias[1]) +
+                           row[2] * (raw[3 * i + 2] - sensor.gyroBias[2])) * scale;
+            }
+        }
+    }
+#endif
+}
+
+// Members (bit per index into in[]) within tolerance of reference on all axes
+static uint8_t agreementMask(SampleFormat::Sample* const in[3][SENSOR_COUNT], size_t i, int memberCount,
+                             const SampleFormat::Sample* reference, SampleFormat::Sample tolerance,
+                             SampleFormat::Coefficient relative) {
+    uint8_t mask = 0;
+    for (int m = 0; m < memberCount; m++) {
+        if (SampleFormat::agrees(in[0][m][i], reference[0], tolerance, relative) &&
+            SampleFormat::agrees(in[1][m][i], reference[1], tolerance, relative) &&
+            SampleFormat::agrees(in[2][m][i], reference[2], tolerance, relative)) {
+            mask |= 1 << m;
+        }
+    }
+    return mask;
+}
+
+void Seismograph::combineSensors(size_t count, const int* members, int memberCount) {
+    SampleFormat::Sample* out[3] = { block.x, block.y, block.z };
+    SampleFormat::Sample* in[3][SENSOR_COUNT];
+    for (int m = 0; m < memberCount; m++) {
+        in[0][m] = arrayBlock.x[members[m]];
+        in[1][m] = arrayBlock.y[members[m]];
+        in[2][m] = arrayBlock.z[members[m]];
+    }
     
-    Serial.printf("Simulating seismic event: Richter %.2f -> PGA %.6f g\n", richterMagnitude, realisticPGA);
+    if (memberCount == 1) {
+        for (int axis = 0; axis < 3; axis++) {
+            memcpy(out[axis], in[axis][0], count * sizeof(SampleFormat::Sample));
+            lastCombined[axis] = out[axis][count - 1];
+        }
+        return;
+    }
     
-    // Force trigger an event directly for simulation
-    if (!eventActive) {
-        startEvent(realisticPGA);
+    // Consensus per axis is the median of the sensors (the mean of two).
+    // A sensor off the consensus on any axis saw something the others
+    // did not - a local spike, a knock on its mount - and is left out of
+    // the mean. With two sensors the consensus cannot tell which one is
+    // off, so the previous combined sample decides.
+    const uint8_t allMembers = (uint8_t)((1 << memberCount) - 1);
+    for (size_t i = 0; i < count; i++) {
+        SampleFormat::Sample consensus[3];
+        for (int axis = 0; axis < 3; axis++) {
+            SampleFormat::Sample sorted[SENSOR_COUNT];
+            for (int m = 0; m < memberCount; m++) {
+                SampleFormat::Sample value = in[axis][m][i];
+                int k = m;
+                for (; k > 0 && sorted[k - 1] > value; k--) sorted[k] = sorted[k - 1];
+                sorted[k] = value;
+            }
+            int middle = memberCount / 2;
+            consensus[axis] = (memberCount & 1) ? sorted[middle]
+                : SampleFormat::mean((SampleFormat::AxisSum)sorted[middle - 1] + sorted[middle], 2);
+        }
         
-        // Simulate realistic event duration based on Richter magnitude
-        unsigned long simulatedDuration = calculateEventDuration(richterMagnitude);
+        const SampleFormat::Sample* reference = consensus;
+        uint8_t accepted = agreementMask(in, i, memberCount, reference, consistencyTolerance, consistencyRelative);
+        if (accepted != allMembers && memberCount == 2) {
+            reference = lastCombined;
+            accepted = agreementMask(in, i, memberCount, reference, consistencyTolerance, consistencyRelative);
+        }
         
-        // Simulate event duration with multiple samples
-        for (int i = 0; i < 10; i++) {
-            float sampleMagnitude = realisticPGA * (0.8f + (i * 0.02f)); // Vary magnitude slightly
-            if (sampleMagnitude > eventMaxMagnitude) {
-                eventMaxMagnitude = sampleMagnitude;
+        // Nobody agrees with the reference: keep the sensor closest to it
+        if (accepted == 0) {
+            SampleFormat::AxisSum bestDistance = 0;
+            for (int m = 0; m < memberCount; m++) {
+                SampleFormat::AxisSum distance = 0;
+                for (int axis = 0; axis < 3; axis++) {
+                    SampleFormat::AxisSum d = (SampleFormat::AxisSum)in[axis][m][i] - reference[axis];
+                    distance += d < 0 ? -d : d;
+                }
+                if (accepted == 0 || distance < bestDistance) {
+                    accepted = 1 << m;
+                    bestDistance = distance;
+                }
             }
-            eventSumMagnitude += sampleMagnitude;
-            eventSampleCount++;
         }
         
-        // Simulate the passage of time for realistic duration
-        delay(simulatedDuration / 10); // Brief delay to simulate event duration
+        int acceptedCount = 0;
+        SampleFormat::AxisSum sum[3] = { 0, 0, 0 };
+        for (int m = 0; m < memberCount; m++) {
+            if (!(accepted & (1 << m))) {
+                sensors[members[m]].outvoted++;
+                continue;
+            }
+            for (int axis = 0; axis < 3; axis++) sum[axis] += in[axis][m][i];
+            acceptedCount++;
+        }
+        if (acceptedCount < memberCount) arrayDisagreements++;
+        for (int axis = 0; axis < 3; axis++) {
+            out[axis][i] = SampleFormat::mean(sum[axis], acceptedCount);
+            lastCombined[axis] = out[axis][i];
+        }
+    }
+}
+
+void Seismograph::runPipeline(size_t count) {
+    pipeline.processBlock(block, count);
+    handleBlock(count);
+}
+
+void Seismograph::handleBlock(size_t count) {
+    // Common case: nothing triggered and no event in progress
+    uint8_t anyTriggered = 0;
+    for (size_t i = 0; i < count; i++) {
+        anyTriggered |= block.triggered[i];
+    }
+    if (!anyTriggered && !eventActive) return;
+    
+    // Machinery/mains energy dominating the trigger bands blocks new events
+    bool vetoed = BAND_TRIGGER_ENABLED && bandMonitor.isVetoed();
+    bool vetoApplied = false;
+    
+    // Event timing follows the sample clock, not the time the block is
+    // processed: in low-power batches seconds of samples arrive at once
+    for (size_t i = 0; i < count; i++) {
+        if (block.rejected[i]) continue; // Spike - skip this sample
+        uint64_t sampleUs = blockStartUs + i * (uint64_t)SAMPLING_PERIOD_US;
         
-        // End the event - this will trigger the scientific analysis
-        endEvent();
+        if (block.triggered[i]) {
+            float magnitudeG = SampleFormat::magnitudeSqToG(block.inputMagnitudeSq[i]);
+            if (!eventActive) {
+                if (vetoed) {
+                    vetoApplied = true;
+                    continue;
+                }
+                startEvent(magnitudeG, sampleUs);
+            } else {
+                // Update ongoing event
+                if (magnitudeG > eventMaxMagnitude) {
+                    eventMaxMagnitude = magnitudeG;
+                }
+                eventSumMagnitude += magnitudeG;
+                eventSampleCount++;
+            }
+            trackEventPeaks(i);
+        } else if (eventActive) {
+            // End the event once it has lasted the minimum duration
+            if (sampleUs - eventTriggerUs >= MIN_EVENT_DURATION * 1000ULL) {
+                endEvent(sampleUs);
+            }
+        }
     }
     
-    // Also process the data normally for STA/LTA algorithm updates
-    SensorData simulatedData;
-    simulatedData.timestamp = millis();
-    simulatedData.accelX = realisticPGA * 0.6f;
-    simulatedData.accelY = realisticPGA * 0.3f;
-    simulatedData.accelZ = realisticPGA * 0.1f;
-    simulatedData.magnitude = realisticPGA;
+    if (vetoApplied) vetoedTriggers++;
     
-    // Process the simulated data for algorithm updates
-    processData(simulatedData);
+    // Running PGA/magnitude for early-warning subscribers
+    uint64_t lastSampleUs = blockStartUs + (count - 1) * (uint64_t)SAMPLING_PERIOD_US;
+    if (eventActive && lastSampleUs - lastAlertUs >= ALERT_UPDATE_INTERVAL_MS * 1000ULL) {
+        sendAlert(ALERT_UPDATE, lastSampleUs);
+    }
 }
 
-float Seismograph::calculateMagnitude(float x, float y, float z) {
-    return sqrt(x * x + y * y + z * z);
+void Seismograph::logProcessingDetails(size_t index) {
+    const float rawScale = (float)(1 << lastRawShift) / MPU6050_ACCEL_SCALE;
+    float rawX = lastRaw[0] * rawScale;
+    float rawY = lastRaw[1] * rawScale;
+    float rawZ = lastRaw[2] * rawScale;
+    
+    Serial.printf("=== SENSOR ANALYSIS (Sample #%lu) ===\n", totalSamples);
+    Serial.printf("Station profile: %s (%d stages, %s, block size %u)\n",
+                  stationProfileName(), StationPipeline::STAGE_COUNT, SampleFormat::name(),
+                  (unsigned)StationPipeline::Block::CAPACITY);
+    Serial.printf("RAW values: X=%.6f, Y=%.6f, Z=%.6f g (magnitude: %.6f g)\n",
+                  rawX, rawY, rawZ, calculateMagnitude(rawX, rawY, rawZ));
+    Serial.printf("Calibrated components: X=%.6f, Y=%.6f, Z=%.6f g\n",
+                  lastSample.accelXG(), lastSample.accelYG(), lastSample.accelZG());
+    Serial.printf("Calibrated magnitude: %.6f g, pipeline magnitude: %.6f g\n",
+                  lastSample.magnitudeG(), SampleFormat::magnitudeSqToG(block.magnitudeSq[index]));
+    for (int s = 0; s < SENSOR_COUNT; s++) {
+        Serial.printf("Calibration offsets 0x%02X: X=%.6f, Y=%.6f, Z=%.6f g%s\n", sensors[s].address,
+                      sensors[s].offset[0], sensors[s].offset[1], sensors[s].offset[2],
+                      isMember(sensors[s]) ? "" : " (not in combined channel)");
+    }
+    if (SENSOR_COUNT > 1) {
+        Serial.printf("Array: %lu samples with an outvoted sensor, read skew max %lu us\n",
+                      arrayDisagreements, (unsigned long)maxReadSkewUs);
+    }
+    
+    SpikeFilterStage<SampleFormat>& spikes = spikeFilter();
+    Serial.printf("Spike filter: %s, %d-sample median %.6f g, %lu %s, last sample %s\n",
+                  spikes.isActive() ? "active" : "filling", SPIKE_FILTER_BUFFER_SIZE, spikes.getMedian(),
+                  spikes.getSpikesFiltered(), SPIKE_FILTER_REPLACE_WITH_MEDIAN ? "replaced" : "dropped",
+                  block.rejected[index] ? "REJECTED" : "accepted");
+    
+    if (staLta().isReady()) {
+        Serial.printf("STA/LTA Analysis: STA=%.6f, LTA=%.6f, Ratio=%.2f (Trigger at %.2f)%s\n",
+                      staLta().getSTA(), staLta().getLTA(), staLta().getRatio(), STA_LTA_RATIO,
+                      block.triggered[index] ? " >>> TRIGGER <<<" : "");
+    }
+    Serial.printf("Event active: %s\n", eventActive ? "YES" : "no");
+    
+    Serial.printf("Threshold Analysis:\n");
+    SampleFormat::MagnitudeSq magnitudeSq = SampleFormat::magnitudeSquared(lastSample.accelX, lastSample.accelY, lastSample.accelZ);
+    Serial.printf("  Micro threshold (%.6f g): %s\n", THRESHOLD_MICRO, 
+                  SampleFormat::exceeds(magnitudeSq, THRESHOLD_MICRO) ? "EXCEEDED" : "below");
+    Serial.printf("  Light threshold (%.6f g): %s\n", THRESHOLD_LIGHT, 
+                  SampleFormat::exceeds(magnitudeSq, THRESHOLD_LIGHT) ? "EXCEEDED" : "below");
+    Serial.printf("  Strong threshold (%.6f g): %s\n", THRESHOLD_STRONG, 
+                  SampleFormat::exceeds(magnitudeSq, THRESHOLD_STRONG) ? "EXCEEDED" : "below");
+    
+    Serial.printf("Calibration Status:\n");
+    Serial.printf("  Calibration valid: %s\n", calibrationValid ? "YES" : "NO");
+    Serial.printf("  Calibration age: %lu ms\n", millis() - lastCalibrationTime);
+    if (staLta().isLtaFull() && baselineLTA > 0) {
+        float currentLTA = staLta().getLTA();
+        float driftPercent = ((currentLTA - baselineLTA) / baselineLTA) * 100.0f;
+        Serial.printf("  Baseline LTA: %.6f g\n", baselineLTA);
+        Serial.printf("  Current LTA: %.6f g\n", currentLTA);
+        Serial.printf("  Drift: %.2f%%\n", driftPercent);
+    }
+    Serial.println("=== END ANALYSIS ===\n");
 }
 
-void Seismograph::updateSTALTA(float magnitude) {
-    // Update STA (Short-Term Average)
-    staSum -= staBuffer[staIndex];
-    staBuffer[staIndex] = magnitude;
-    staSum += magnitude;
-    staIndex = (staIndex + 1) % STA_WINDOW;
-    if (staIndex == 0) staFull = true;
-    
-    // Update LTA (Long-Term Average)
-    ltaSum -= ltaBuffer[ltaIndex];
-    ltaBuffer[ltaIndex] = magnitude;
-    ltaSum += magnitude;
-    ltaIndex = (ltaIndex + 1) % LTA_WINDOW;
-    if (ltaIndex == 0) ltaFull = true;
+void Seismograph::resetOrientation(ArraySensor& sensor) {
+    // Identity rotation - sensor frame is used as-is
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++) {
+            sensor.rotationMatrix[row][col] = (row == col) ? 1.0f : 0.0f;
+        }
+    }
+    sensor.gravityMagnitude = 1.0f;
+    sensor.mountingTiltDeg = 0.0f;
 }
 
-bool Seismograph::checkEventTrigger() {
-    if (!staFull || !ltaFull) return false;
+void Seismograph::computeOrientation(ArraySensor& sensor, float gx, float gy, float gz) {
+    // Rodrigues rotation taking the measured gravity direction onto +Z.
+    // Rotated X/Y are horizontal channels, rotated Z is the vertical channel.
+    float norm = sqrt(gx * gx + gy * gy + gz * gz);
+    if (norm <= 0.0f) {
+        resetOrientation(sensor);
+        return;
+    }
+    
+    float ux = gx / norm;
+    float uy = gy / norm;
+    float uz = gz / norm;
+    
+    sensor.mountingTiltDeg = acos(constrain(uz, -1.0f, 1.0f)) * 180.0f / PI;
     
-    float sta = staSum / STA_WINDOW;
-    float lta = ltaSum / LTA_WINDOW;
+    if (uz < -0.999999f) {
+        // Sensor mounted upside down: rotate 180 degrees about X
+        resetOrientation(sensor);
+        sensor.rotationMatrix[1][1] = -1.0f;
+        sensor.rotationMatrix[2][2] = -1.0f;
+        sensor.mountingTiltDeg = 180.0f;
+        return;
+    }
+    
+    // Axis k = u x z = (uy, -ux, 0), cos(theta) = uz; R = I + [k]x + [k]x^2 / (1 + uz)
+    float c = 1.0f / (1.0f + uz);
+    float (&r)[3][3] = sensor.rotationMatrix;
+    r[0][0] = 1.0f - ux * ux * c;
+    r[0][1] = -ux * uy * c;
+    r[0][2] = -ux;
+    r[1][0] = -ux * uy * c;
+    r[1][1] = 1.0f - uy * uy * c;
+    r[1][2] = -uy;
+    r[2][0] = ux;
+    r[2][1] = uy;
+    r[2][2] = uz;
+}
+
+void Seismograph::applyOrientation(const ArraySensor& sensor, float rawX, float rawY, float rawZ, float& outX, float& outY, float& outZ) {
+    const float (&r)[3][3] = sensor.rotationMatrix;
+    outX = r[0][0] * rawX + r[0][1] * rawY + r[0][2] * rawZ;
+    outY = r[1][0] * rawX + r[1][1] * rawY + r[1][2] * rawZ;
+    outZ = r[2][0] * rawX + r[2][1] * rawY + r[2][2] * rawZ;
+}
+
+bool Seismograph::readTemperature(const ArraySensor& sensor, float& tempC) {
+    int16_t raw;
+    if (sensorBus.isActive()) {
+        if (!sensorBus.readTemperatureRaw(sensor.address, raw)) return false;
+    } else {
+        MPU6050 device(sensor.address);
+        raw = device.getTemperature();
+    }
+    tempC = TemperatureCompensator::rawToCelsius(raw);
+    return true;
+}
+
+void Seismograph::updateTemperatureModel() {
+    lastTempSample = millis();
     
-    if (lta == 0) return false;
+    for (int s = 0; s < SENSOR_COUNT; s++) {
+        ArraySensor& sensor = sensors[s];
+        if (!sensor.present) continue;
+        
+        float tempC;
+        // Bus error: keep accumulating, the next interval is simply longer
+        if (!readTemperature(sensor, tempC)) continue;
+        
+        // Only quiet intervals teach the model - ground motion is not offset drift
+        if (sensor.calibrated && !eventActive && sensor.tempAxisCount > 0) {
+            float axisMean[3];
+            for (int axis = 0; axis < 3; axis++) {
+                // Add back the compensation that was applied during this interval
+                axisMean[axis] = SampleFormat::sumToG(sensor.tempAxisSum[axis]) / sensor.tempAxisCount + sensor.appliedCompensation[axis];
+            }
+            sensor.tempCompensator.addObservation(tempC, axisMean);
+        } else {
+            sensor.tempCompensator.updateCompensation(tempC);
+        }
+        sensor.tempAxisSum[0] = sensor.tempAxisSum[1] = sensor.tempAxisSum[2] = 0;
+        sensor.tempAxisCount = 0;
+    }
     
-    float ratio = sta / lta;
-    return ratio > STA_LTA_RATIO;
+    rebuildParameterBlock();
+}
+
+void Seismograph::rebuildParameterBlock() {
+    for (int s = 0; s < SENSOR_COUNT; s++) {
+        ArraySensor& sensor = sensors[s];
+        for (int row = 0; row < 3; row++) {
+            for (int col = 0; col < 3; col++) {
+                sensor.rotationCoefficients[row][col] = SampleFormat::coefficient(sensor.rotationMatrix[row][col]);
+            }
+            sensor.appliedCompensation[row] = sensor.tempCompensator.getCompensation(row);
+            sensor.sampleOffsets[row] = SampleFormat::fromG(sensor.offset[row] + sensor.appliedCompensation[row]);
+        }
+    }
+}
+
+float Seismograph::calculateMagnitude(float x, float y, float z) {
+    return sqrt(x * x + y * y + z * z);
 }
 
-void Seismograph::startEvent(float magnitude) {
+void Seismograph::startEvent(float magnitude, uint64_t triggerUs) {
     eventActive = true;
-    eventStartTime = millis();
+    eventTraceId++;
+    eventTriggerUs = triggerUs;
+    eventStartTime = (unsigned long)(triggerUs / 1000);
     eventMaxMagnitude = magnitude;
     eventSumMagnitude = magnitude;
     eventSampleCount = 1;
+    eventPeakAccel[0] = eventPeakAccel[1] = eventPeakAccel[2] = 0.0f;
+    eventRangeShift = blockRangeShift;
+    eventClipped = blockClipped;
+#if GYRO_CHANNELS_ENABLED
+    eventPeakRate[0] = eventPeakRate[1] = eventPeakRate[2] = 0.0f;
+#endif
+    eventInjected = injector.isActive();
+    
+    // Announce the onset to peer stations (never for injected events). The
+    // onset is the trigger sample's time, not the time this block is processed.
+    eventOnsetUtcMs = 0;
+    if (COINCIDENCE_ENABLED && !eventInjected && TimeManager::timerToEpochMs(triggerUs, eventOnsetUtcMs)) {
+        coincidence.localTriggerOn(eventOnsetUtcMs, staLta().isReady() ? staLta().getRatio() : 0.0f);
+    }
+    
+    // Preliminary magnitude from the P wave
+    if (EARLY_MAG_ENABLED) earlyMagnitude.start(eventTraceId, triggerUs);
+    
+    // Early warning goes out before anything else about this event
+    alertSequence = 0;
+    sendAlert(ALERT_TRIGGER_ON, triggerUs);
     
     int level = classifyEvent(magnitude);
     Serial.printf("Seismic event detected! Level: %d, Magnitude: %.4f g\n", level, magnitude);
 }
 
-void Seismograph::endEvent() {
+void Seismograph::sendAlert(AlertKind kind, uint64_t sampleUs) {
+    lastAlertUs = sampleUs;
+    if (!ALERT_ENABLED || globalCoreManager == nullptr) return;
+    
+    AlertPacket alert;
+    alert.kind = kind;
+    alert.injected = eventInjected;
+    alert.sequence = alertSequence++;
+    alert.traceId = eventTraceId;
+    alert.onsetUtcMs = eventOnsetUtcMs;
+    alert.triggerUs = eventTriggerUs;
+    alert.elapsedMs = (uint32_t)((sampleUs - eventTriggerUs) / 1000);
+    alert.pgaG = eventMaxMagnitude;
+    alert.level = classifyEvent(eventMaxMagnitude);
+    
+    // tau_c / Pd once enough P wave is in, the running PGA before that
+    const EarlyMagnitudeEstimate& early = earlyMagnitude.estimate();
+    if (EARLY_MAG_ENABLED && early.valid && early.traceId == eventTraceId) {
+        alert.magnitude = early.magnitude;
+        alert.earlyMagnitude = true;
+        alert.tauC = early.tauC;
+        alert.pdCm = early.pdCm;
+        alert.pWindowMs = early.windowMs;
+    } else {
+        alert.magnitude = calculateRichterMagnitude(eventMaxMagnitude);
+        alert.earlyMagnitude = false;
+        alert.tauC = 0.0f;
+        alert.pdCm = 0.0f;
+        alert.pWindowMs = 0;
+    }
+    alert.triggerRatio = staLta().isReady() ? staLta().getRatio() : 0.0f;
+    globalCoreManager->sendAlert(alert);
+}
+
+void Seismograph::trackEventPeaks(size_t index) {
+    // Filtered axes: DC (and gravity on Z) is already removed
+    float peaks[3] = {
+        fabsf(SampleFormat::toG(block.x[index])),
+        fabsf(SampleFormat::toG(block.y[index])),
+        fabsf(SampleFormat::toG(block.z[index]))
+    };
+    for (int axis = 0; axis < 3; axis++) {
+        if (peaks[axis] > eventPeakAccel[axis]) eventPeakAccel[axis] = peaks[axis];
+    }
+#if GYRO_CHANNELS_ENABLED
+    if (blockHasRates) {
+        for (int axis = 0; axis < 3; axis++) {
+            float rate = fabsf(rateBlock[axis][index]);
+            if (rate > eventPeakRate[axis]) eventPeakRate[axis] = rate;
+        }
+    }
+#endif
+}
+
+void Seismograph::endEvent(uint64_t endUs) {
+    // endUs is the time of the first quiet sample past MIN_EVENT_DURATION
     if (!eventActive) return;
     
-    unsigned long eventDuration = millis() - eventStartTime;
-    float avgMagnitude = eventSumMagnitude / eventSampleCount;
-    int level = classifyEvent(eventMaxMagnitude);
-    
+    eventDuration = (unsigned long)((endUs - eventTriggerUs) / 1000);
+    sendAlert(ALERT_SUMMARY, endUs);
     eventsDetected++;
     eventActive = false;
     
-    Serial.printf("Event ended. Duration: %lu ms, Max: %.4f g, Avg: %.4f g, Level: %d\n",
-                  eventDuration, eventMaxMagnitude, avgMagnitude, level);
-    
-    // Create event description with scientific analysis - use Richter-based classification
-    float richter = calculateRichterMagnitude(eventMaxMagnitude);
-    String eventType = getEventTypeFromRichter(richter);
-    String description = getScientificEventDescription(eventMaxMagnitude, eventDuration);
-    
-    // Add traditional description for compatibility
-    description += " | Traditional: Duration=" + String(eventDuration) + 
-                   "ms, Max=" + String(eventMaxMagnitude, 4) + "g, Avg=" + 
-                   String(avgMagnitude, 4) + "g";
-    
-    if (detailedLoggingEnabled) {
-        // KRITISCH: Prüfe NTP-Zeit vor Event-Weiterleitung mit detailliertem Logging
-        Serial.printf("=== EVENT VALIDATION ===\n");
-        Serial.printf("Event Type: %s\n", eventType.c_str());
-        Serial.printf("Max Magnitude: %.6f g\n", eventMaxMagnitude);
-        Serial.printf("Avg Magnitude: %.6f g\n", avgMagnitude);
-        Serial.printf("Duration: %lu ms\n", eventDuration);
-        Serial.printf("Sample Count: %d\n", eventSampleCount);
-        Serial.printf("Classification Level: %d\n", level);
-    }
-    
-    // Detaillierte NTP-Zeit-Validierung
-    bool ntpTimeValid = timeManager.isTimeValid();
-    if (detailedLoggingEnabled) Serial.printf("NTP Time Validation: %s\n", ntpTimeValid ? "VALID" : "INVALID");
-    
-    if (!ntpTimeValid) {
-        Serial.println(">>> EVENT REJECTED: NTP time not valid <<<");
-        if (detailedLoggingEnabled) {
-            Serial.println("Reasons for NTP time invalidity:");
-            Serial.printf("  - System may not be synchronized with NTP server\n");
-            Serial.printf("  - Network connectivity issues\n");
-            Serial.printf("  - Time integrity requirements not met\n");
-            Serial.printf("Event details: %s, Magnitude: %.6f g, Duration: %lu ms\n", 
-                          eventType.c_str(), eventMaxMagnitude, eventDuration);
-            Serial.printf("Boot time would be: %lu ms\n", millis());
-            Serial.println("=== EVENT VALIDATION FAILED ===\n");
-        }
-        return; // Event wird nicht weitergeleitet ohne gültige NTP-Zeit
+    if (eventOnsetUtcMs != 0) {
+        uint64_t offUtcMs;
+        if (!TimeManager::timerToEpochMs(endUs, offUtcMs)) offUtcMs = eventOnsetUtcMs + eventDuration;
+        coincidence.localTriggerOff(offUtcMs);
     }
     
-    if (detailedLoggingEnabled) {
-        // NTP-Zeit ist gültig - Event wird weitergeleitet
-        Serial.printf(">>> EVENT ACCEPTED: NTP time is valid <<<\n");
-        Serial.printf("Current NTP time: %s\n", timeManager.getFormattedDateTime().c_str());
-        Serial.printf("Epoch timestamp: %lu\n", timeManager.getEpochTime());
-    }
-    
-    // Create comprehensive seismic event with scientific data
-    createSeismicEvent(eventMaxMagnitude, eventDuration, "seismograph_detection");
-    
-    // Send event to dual core manager for processing (nur mit gültiger NTP-Zeit)
-    if (globalCoreManager != nullptr) {
-        EventPacket eventPacket;
-        eventPacket.eventType = eventType;
-        eventPacket.magnitude = eventMaxMagnitude;
-        eventPacket.level = level;
-        // Verwende NTP-validierte Zeit statt Boot-Zeit
-        eventPacket.timestamp = timeManager.getEpochTime() * 1000; // Convert to milliseconds
-        globalCoreManager->sendEvent(eventPacket);
-        
-        if (detailedLoggingEnabled) {
-            Serial.printf(">>> EVENT FORWARDED SUCCESSFULLY <<<\n");
-            Serial.printf("Forwarded with NTP-validated timestamp: %s\n", 
-                          timeManager.getFormattedDateTime().c_str());
-            Serial.printf("Timestamp (ms): %lu\n", eventPacket.timestamp);
-        }
-    } else {
-        Serial.println("WARNING: globalCoreManager is null - Event not forwarded");
+    // Hand the raw event state to the finalizer in the background task; classification,
+    // coincidence verdict, flash log and publishing all happen there
+    EventPacket packet;
+    packet.startMs = eventStartTime;
+    packet.durationMs = eventDuration;
+    packet.maxMagnitude = eventMaxMagnitude;
+    packet.avgMagnitude = eventSumMagnitude / eventSampleCount;
+    packet.sampleCount = eventSampleCount;
+    packet.peakAccel[0] = eventPeakAccel[0];
+    packet.peakAccel[1] = eventPeakAccel[1];
+    packet.peakAccel[2] = eventPeakAccel[2];
+    packet.accelRangeG = (float)(2 << eventRangeShift);
+    packet.clipped = eventClipped;
+#if GYRO_CHANNELS_ENABLED
+    packet.peakRate[0] = eventPeakRate[0];
+    packet.peakRate[1] = eventPeakRate[1];
+    packet.peakRate[2] = eventPeakRate[2];
+#endif
+    packet.triggerRatio = staLta().isReady() ? staLta().getRatio() : 0.0f;
+    packet.backgroundNoise = backgroundNoise;
+    packet.calibrationValid = calibrationValid;
+    packet.calibrationAgeHours = getCalibrationAgeHours();
+    packet.onsetUtcMs = eventOnsetUtcMs;
+    packet.injected = eventInjected;
+    packet.traceId = eventTraceId;
+    packet.triggerUs = eventTriggerUs;
+    packet.dequeueUs = 0;
+    packet.handoffUs = (uint64_t)esp_timer_get_time();
+    
+    if (globalCoreManager == nullptr || !globalCoreManager->sendEvent(packet)) {
+        Serial.println("WARNING: Event queue unavailable - Event not forwarded");
     }
-    if (detailedLoggingEnabled) Serial.println("=== EVENT VALIDATION COMPLETE ===\n");
 }
 
 int Seismograph::classifyEvent(float magnitude) {
@@ -735,10 +1423,10 @@ void Seismograph::updateAdaptiveThresholds() {
     }
     lastAdaptiveUpdate = currentTime;
     
-    if (!ltaFull) return;
+    if (!staLta().isLtaFull()) return;
     
     // Calculate current background noise level
-    float lta = ltaSum / LTA_WINDOW;
+    float lta = staLta().getLTA();
     
     // Validate LTA value to prevent NaN
     if (isnan(lta) || lta < 0.0001f) {
@@ -775,6 +1463,7 @@ void Seismograph::updateAdaptiveThresholds() {
     adaptiveThresholdMicro = constrain(adaptiveThresholdMicro, THRESHOLD_MICRO * 0.5f, THRESHOLD_MICRO * 3.0f);
     adaptiveThresholdLight = constrain(adaptiveThresholdLight, THRESHOLD_LIGHT * 0.5f, THRESHOLD_LIGHT * 3.0f);
     adaptiveThresholdStrong = constrain(adaptiveThresholdStrong, THRESHOLD_STRONG * 0.5f, THRESHOLD_STRONG * 3.0f);
+    syncSpikeThreshold();
     
     if (detailedLoggingEnabled) {
         Serial.printf("Adaptive thresholds updated: Micro=%.4f, Light=%.4f, Strong=%.4f (Background=%.4f, Factor=%.2f)\n",
@@ -782,90 +1471,8 @@ void Seismograph::updateAdaptiveThresholds() {
     }
 }
 
-bool Seismograph::isSpikeFiltered(float magnitude) {
-    if (!magnitudeBufferFull) {
-        // Log why spike filtering is not active yet
-        static unsigned long lastBufferLog = 0;
-        if (detailedLoggingEnabled && (millis() - lastBufferLog > 10000)) { // Log every 10 seconds
-            Serial.printf("Spike filter not active: Buffer not full yet (%d/5 samples)\n", magnitudeIndex);
-            lastBufferLog = millis();
-        }
-        return false;
-    }
-    
-    // Get median of last 5 readings
-    float median = getMedianMagnitude();
-    
-    // Use appropriate threshold based on adaptive mode
-    float thresholdMicro = adaptiveThresholdEnabled ? adaptiveThresholdMicro : THRESHOLD_MICRO;
-    
-    // Calculate spike detection criteria using defined constants
-    float medianMultiplier = SPIKE_MEDIAN_MULTIPLIER;
-    float thresholdMultiplier = SPIKE_THRESHOLD_MULTIPLIER;
-    bool exceedsMedian = magnitude > median * medianMultiplier;
-    bool exceedsThreshold = magnitude > thresholdMicro * thresholdMultiplier;
-    
-    // Detailed logging for spike analysis
-    static unsigned long lastSpikeAnalysisLog = 0;
-    bool shouldLogSpikeAnalysis = detailedLoggingEnabled && (millis() - lastSpikeAnalysisLog > 5000);
-    
-    if (shouldLogSpikeAnalysis) {
-        Serial.printf("--- SPIKE FILTER ANALYSIS ---\n");
-        Serial.printf("Current magnitude: %.6f g\n", magnitude);
-        Serial.printf("Median of last 5: %.6f g\n", median);
-        Serial.printf("Last 5 magnitudes: ");
-        for (int i = 0; i < 5; i++) {
-            Serial.printf("%.6f ", lastMagnitudes[i]);
-        }
-        Serial.println();
-        Serial.printf("Spike criteria:\n");
-        Serial.printf("  > %.1fx median (%.6f g): %s\n", medianMultiplier, median * medianMultiplier, exceedsMedian ? "YES" : "no");
-        Serial.printf("  > %.1fx micro threshold (%.6f g): %s\n", thresholdMultiplier, thresholdMicro * thresholdMultiplier, exceedsThreshold ? "YES" : "no");
-        lastSpikeAnalysisLog = millis();
-    }
-    
-    // Check if current magnitude is a spike
-    if (exceedsMedian && exceedsThreshold) {
-        if (detailedLoggingEnabled) {
-            Serial.printf(">>> SPIKE DETECTED AND FILTERED <<<\n");
-            Serial.printf("Magnitude %.6f g > %.1fx median (%.6f g) AND > %.1fx threshold (%.6f g)\n", 
-                          magnitude, medianMultiplier, median * medianMultiplier, 
-                          thresholdMultiplier, thresholdMicro * thresholdMultiplier);
-        }
-        return true;
-    }
-    
-    if (shouldLogSpikeAnalysis) {
-        Serial.printf("Sample passes spike filter\n");
-        Serial.printf("--- END SPIKE ANALYSIS ---\n");
-    }
-    
-    return false;
-}
-
-float Seismograph::getMedianMagnitude() {
-    // Optimized median calculation for 5 elements using partial sorting
-    float sorted[5];
-    for (int i = 0; i < 5; i++) {
-        sorted[i] = lastMagnitudes[i];
-    }
-    
-    // Find median using selection algorithm - only need to find 3rd smallest
-    for (int i = 0; i < 3; i++) {
-        int minIdx = i;
-        for (int j = i + 1; j < 5; j++) {
-            if (sorted[j] < sorted[minIdx]) {
-                minIdx = j;
-            }
-        }
-        if (minIdx != i) {
-            float temp = sorted[i];
-            sorted[i] = sorted[minIdx];
-            sorted[minIdx] = temp;
-        }
-    }
-    
-    return sorted[2]; // Return median (3rd smallest)
+void Seismograph::syncSpikeThreshold() {
+    spikeFilter().setThreshold(adaptiveThresholdEnabled ? adaptiveThresholdMicro : THRESHOLD_MICRO);
 }
 
 void Seismograph::checkCalibrationDrift() {
@@ -879,11 +1486,11 @@ void Seismograph::checkCalibrationDrift() {
     lastDriftCheck = millis();
     
     // Only check if we have valid calibration and LTA is available
-    if (!calibrationValid || !ltaFull || baselineLTA <= 0) {
+    if (!calibrationValid || !staLta().isLtaFull() || baselineLTA <= 0) {
         return;
     }
     
-    float currentLTA = ltaSum / LTA_WINDOW;
+    float currentLTA = staLta().getLTA();
     float driftPercent = ((currentLTA - baselineLTA) / baselineLTA) * 100.0f;
     float absDriftPercent = abs(driftPercent);
     
@@ -1035,9 +1642,11 @@ void Seismograph::printStats() {
     Serial.println("=== Seismograph Statistics ===");
     Serial.printf("Total samples: %lu\n", totalSamples);
     Serial.printf("Events detected: %lu\n", eventsDetected);
-    Serial.printf("Spikes filtered: %lu\n", spikesFiltered);
-    Serial.printf("Last magnitude: %.4f g\n", lastMagnitude);
+    Serial.printf("Spikes filtered: %lu\n", spikeFilter().getSpikesFiltered());
+    Serial.printf("Last magnitude: %.4f g\n", getLastMagnitude());
     Serial.printf("Background noise: %.4f g\n", backgroundNoise);
+    Serial.printf("Sample pipeline: %s, station profile %s (%d stages, STA/LTA buffers: %u bytes)\n",
+                  SampleFormat::name(), stationProfileName(), StationPipeline::STAGE_COUNT, (unsigned)staLta().bufferBytes());
     Serial.printf("Calibrated: %s\n", calibrated ? "Yes" : "No");
     Serial.printf("Calibration valid: %s\n", calibrationValid ? "Yes" : "No");
     Serial.printf("Event active: %s\n", eventActive ? "Yes" : "No");
@@ -1051,10 +1660,9 @@ void Seismograph::printStats() {
                       THRESHOLD_MICRO, THRESHOLD_LIGHT, THRESHOLD_STRONG);
     }
     
-    if (staFull && ltaFull) {
-        float sta = staSum / STA_WINDOW;
-        float lta = ltaSum / LTA_WINDOW;
-        float ratio = (lta > 0) ? sta / lta : 0;
+    if (staLta().isReady()) {
+        float lta = staLta().getLTA();
+        float ratio = staLta().getRatio();
         Serial.printf("STA/LTA ratio: %.2f (trigger at %.2f)\n", ratio, STA_LTA_RATIO);
         
         if (baselineLTA > 0) {
@@ -1066,81 +1674,30 @@ void Seismograph::printStats() {
     if (lastCalibrationTime > 0) {
         Serial.printf("Last calibration: %lu minutes ago\n", (millis() - lastCalibrationTime) / 60000);
     }
-}
-
-void Seismograph::createSeismicEvent(float magnitude, unsigned long duration, const String& source) {
-    // Nur Events mit gültiger NTP-Zeit erstellen
-    if (!timeManager.isTimeValid()) {
-        if (detailedLoggingEnabled) {
-            Serial.println("CRITICAL: Cannot create seismic event - NTP time not valid");
-        }
-        return;
-    }
-    
-    // Erstelle vollständige SeismicEventData-Struktur
-    SeismicEventData eventData;
     
-    // Detection info
-    eventData.timestamp = timeManager.getEpochTime();
-    eventData.datetimeISO = timeManager.getFormattedDateTime();
-    eventData.ntpValidated = true;
-    eventData.bootTimeMs = millis();
+    BandEnergySnapshot bands;
+    bandMonitor.getSnapshot(bands);
+    Serial.printf("Band energies (%lu windows, band triggers %lu, vetoed triggers %lu):\n",
+                  bands.windows, bandTriggers, vetoedTriggers);
+    for (int band = 0; band < bandMonitor.getBandCount(); band++) {
+        Serial.printf("  %-10s %5.1f-%5.1f Hz [%s]: RMS %.6f g, background %.6f g\n",
+                      bandMonitor.getBandName(band), bandMonitor.getBandLowHz(band), bandMonitor.getBandHighHz(band),
+                      BandEnergyMonitor::roleName(bandMonitor.getBandRole(band)),
+                      bands.rms[band], bands.background[band]);
+    }
     
-    // Classification
-    float richter = calculateRichterMagnitude(magnitude);
-    eventData.eventType = getEventTypeFromRichter(richter);
-    eventData.intensityLevel = getIntensityLevelFromRichter(richter);
-    eventData.richterRange = getRichterRangeFromType(eventData.eventType);
-    eventData.confidence = 0.95f; // High confidence for detected events
-    
-    // Measurements
-    eventData.pgaG = magnitude;
-    eventData.richterMagnitude = richter;
-    eventData.localMagnitude = calculateLocalMagnitude(magnitude);
-    eventData.durationMs = duration;
-    eventData.peakFrequencyHz = calculatePeakFrequency(magnitude);
-    eventData.energyJoules = calculateEnergyJoules(richter);
-    
-    // Sensor data (use last sensor reading or simulate)
-    SensorData lastReading = readSensor();
-    eventData.maxAccelX = abs(lastReading.accelX);
-    eventData.maxAccelY = abs(lastReading.accelY);
-    eventData.maxAccelZ = abs(lastReading.accelZ);
-    eventData.vectorMagnitude = magnitude;
-    eventData.calibrationValid = calibrationValid;
-    eventData.calibrationAgeHours = getCalibrationAgeHours();
-    
-    // Algorithm data
-    eventData.detectionMethod = "STA_LTA";
-    if (staFull && ltaFull) {
-        float sta = staSum / STA_WINDOW;
-        float lta = ltaSum / LTA_WINDOW;
-        eventData.triggerRatio = (lta > 0) ? sta / lta : 0.0f;
-    } else {
-        eventData.triggerRatio = 0.0f;
-    }
-    eventData.staWindowSamples = STA_WINDOW;
-    eventData.ltaWindowSamples = LTA_WINDOW;
-    eventData.backgroundNoise = backgroundNoise;
-    
-    // Metadata
-    eventData.source = source;
-    eventData.processingVersion = "v1.0";
-    eventData.sampleRateHz = 100; // Typical sampling rate
-    eventData.filterApplied = "bandpass_1-30hz";
-    eventData.dataQuality = calibrationValid ? "excellent" : "good";
-    
-    // Send to DataLogger für permanente Speicherung
-    if (globalDataLogger != nullptr) {
-        bool success = globalDataLogger->logSeismicEvent(eventData);
-        if (detailedLoggingEnabled) {
-            Serial.printf("Seismic event logged: %s (Success: %s)\n", 
-                          eventData.eventType.c_str(), success ? "YES" : "NO");
-        }
-    } else {
-        if (detailedLoggingEnabled) {
-            Serial.println("WARNING: globalDataLogger is null - Seismic event not logged");
-        }
+    for (int s = 0; s < SENSOR_COUNT; s++) {
+        const ArraySensor& sensor = sensors[s];
+        const TemperatureCompensator& tc = sensor.tempCompensator;
+        Serial.printf("Sensor 0x%02X: %s, tilt %.2f deg, %lu read errors, %lu samples outvoted\n",
+                      sensor.address, !sensor.present ? "missing" : sensor.calibrated ? "calibrated" : "uncalibrated",
+                      sensor.mountingTiltDeg, sensor.readErrors, sensor.outvoted);
+        Serial.printf("  Die temperature: %.2f C (reference %.2f C, span %.2f C)\n",
+                      tc.getLastTemp(), tc.getReferenceTemp(), tc.getTempSpan());
+        Serial.printf("  Temperature model: %s, slopes X=%.6f Y=%.6f Z=%.6f g/C, residual RMS X=%.6f Y=%.6f Z=%.6f g\n",
+                      tc.isReady() ? "active" : "learning",
+                      tc.getSlope(0), tc.getSlope(1), tc.getSlope(2),
+                      tc.getResidualRms(0), tc.getResidualRms(1), tc.getResidualRms(2));
     }
 }
 
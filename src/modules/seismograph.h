@@ -5,13 +5,33 @@
 #include <Wire.h>
 #include <MPU6050.h>
 #include "config.h"
+#include "temperature_compensator.h"
+#include "band_energy_monitor.h"
+#include "coincidence_trigger.h"
+#include "synthetic_injector.h"
+#include "early_magnitude.h"
+#include "i2c_sensor_bus.h"
+#include "processing_pipeline.h"
+#include "dual_core_manager.h"
+#include "../utils/sample_format.h"
+#include "../utils/fir_decimator.h"
 
+// Calibrated sample in the compile-time selected SampleFormat
 struct SensorData {
-    float accelX;
-    float accelY;
-    float accelZ;
-    float magnitude;
+    SampleFormat::Sample accelX;
+    SampleFormat::Sample accelY;
+    SampleFormat::Sample accelZ;
     unsigned long timestamp;
+    uint8_t rangeShift;         // Highest accel range in the sample's block (±2 g << shift)
+#if GYRO_CHANNELS_ENABLED
+    float rateX, rateY, rateZ;  // Angular rate, Z-up frame (deg/s); 0 while the gyro is off
+#endif
+    
+    float rangeG() const { return (float)(2 << rangeShift); }
+    float accelXG() const { return SampleFormat::toG(accelX); }
+    float accelYG() const { return SampleFormat::toG(accelY); }
+    float accelZG() const { return SampleFormat::toG(accelZ); }
+    float magnitudeG() const { return SampleFormat::magnitudeG(accelX, accelY, accelZ); }
 };
 
 struct SeismicEvent {
@@ -23,31 +43,138 @@ struct SeismicEvent {
     String description;
 };
 
+#define ALL_SENSORS_MASK ((uint8_t)((1 << SENSOR_COUNT) - 1))
+
+// One MPU6050 of the sensor array with its own calibration and temperature
+// model (mounting and die drift differ between sensors)
+struct ArraySensor {
+    uint8_t address;
+    bool present;               // Answered during begin()
+    bool calibrated;
+    
+    // Calibration data (offsets are expressed in the rotated, Z-up frame)
+    float offset[3];
+    float rotationMatrix[3][3]; // Sensor frame -> Z-up frame, precomputed at calibration
+    float gravityMagnitude;     // |g| measured during calibration
+    float mountingTiltDeg;      // Angle between sensor Z-axis and gravity
+    float lastCalibrationOffsets[3];
+    
+    // Per-sample parameter block in SampleFormat units, rebuilt from the
+    // float calibration whenever the calibration or temperature model changes
+    SampleFormat::Coefficient rotationCoefficients[3][3];
+    SampleFormat::Sample sampleOffsets[3];  // Static offset + temperature compensation
+    float appliedCompensation[3];           // Temperature compensation inside sampleOffsets (g)
+    
+    // Temperature compensation (learned online from the on-die sensor)
+    TemperatureCompensator tempCompensator;
+    SampleFormat::AxisSum tempAxisSum[3];
+    unsigned long tempAxisCount;
+    
+    // Accelerometer range (±2 g << rangeShift), raised on clipping
+    uint8_t rangeShift;
+    unsigned long rangeQuietSinceMs; // Peak has fit the next lower range since then
+    unsigned long clippedBlocks;     // Blocks with a raw count at ACCEL_CLIP_COUNTS
+    unsigned long rangeSwitches;
+    
+#if GYRO_CHANNELS_ENABLED
+    float gyroBias[3];          // Raw counts at rest, sensor frame
+#endif
+    
+    unsigned long readErrors;
+    unsigned long outvoted;     // Samples left out of the combined channel
+};
+
+// Calibrated Z-up samples of every sensor, each sensor's axis contiguous
+struct ArrayBlock {
+    SampleFormat::Sample x[SENSOR_COUNT][PIPELINE_BLOCK_SIZE];
+    SampleFormat::Sample y[SENSOR_COUNT][PIPELINE_BLOCK_SIZE];
+    SampleFormat::Sample z[SENSOR_COUNT][PIPELINE_BLOCK_SIZE];
+    uint8_t rangeShift[SENSOR_COUNT];   // Range the block was read with
+    uint16_t rawPeak[SENSOR_COUNT];     // Largest |raw count| on any axis
+};
+
 class Seismograph {
 private:
-    MPU6050 mpu;
+    I2cSensorBus sensorBus;
     bool initialized;
     
-    // Calibration data
-    float offsetX, offsetY, offsetZ;
-    bool calibrated;
+    // Sensor array; the pipeline sees the combined channel only
+    ArraySensor sensors[SENSOR_COUNT];
+    ArrayBlock arrayBlock;
+    SampleFormat::Sample consistencyTolerance;
+    SampleFormat::Coefficient consistencyRelative;
+    SampleFormat::Sample lastCombined[3];   // Tie-breaker when two sensors disagree
+    unsigned long arrayDisagreements;       // Samples where a sensor was outvoted
+    uint32_t maxReadSkewUs;                 // First to last sensor read in one tick
     
-    // STA/LTA algorithm variables
-    float staBuffer[STA_WINDOW];
-    float ltaBuffer[LTA_WINDOW];
-    int staIndex;
-    int ltaIndex;
-    float staSum;
-    float ltaSum;
-    bool staFull;
-    bool ltaFull;
+    // FIFO batches (LOW_POWER_MODE): the sensors pace and buffer the reads
+    static const size_t FIFO_MAX_SKEW_READS = 4;
+    bool fifoMode;
+    unsigned long fifoOverflows;            // Batches lost to a full FIFO
+    unsigned long fifoResyncs;              // FIFOs restarted after drifting apart
+    unsigned long fifoRestarts;             // Every FIFO reset: the read sequence restarts there
+    bool calibrated;                        // At least one sensor calibrated
+    
+#if GYRO_CHANNELS_ENABLED
+    // Rotational channels, combined like the accelerometer but kept out of
+    // the detection pipeline; only filled while gyroEnabled
+    volatile bool gyroEnabled;
+    bool blockHasRates;
+    float rateBlock[3][PIPELINE_BLOCK_SIZE]; // deg/s, Z-up frame
+    float eventPeakRate[3];                  // Peak |omega| per axis during the event
+#endif
+    
+    unsigned long lastTempSample;
+    
+#if OVERSAMPLE_FACTOR > 1
+    // Calibrated channel at ACQUISITION_RATE -> SAMPLING_RATE, in place in
+    // the work block; the rates follow the same phase so they stay aligned
+    FirDecimator<SampleFormat, 3> decimator;
+#if GYRO_CHANNELS_ENABLED
+    FirDecimator<FloatSampleFormat, 3> rateDecimator;
+#endif
+#endif
+    
+    // Processing chain (filters, spike filter, STA/LTA) and its SoA work block
+    StationPipeline pipeline;
+    StationPipeline::Block block;
+    
+    // Continuous band energies (Goertzel bank), also a trigger/veto input
+    BandEnergyMonitor bandMonitor;
+    unsigned long bandTriggers;
+    unsigned long vetoedTriggers;
     
     // Event detection
     bool eventActive;
-    unsigned long eventStartTime;
+    unsigned long eventStartTime;   // Trigger sample on the boot clock (ms)
     float eventMaxMagnitude;
     float eventSumMagnitude;
     int eventSampleCount;
+    unsigned long eventDuration;
+    float eventPeakAccel[3];        // Peak filtered |a| per axis during the event (g)
+    uint8_t eventRangeShift;        // Highest accel range used during the event
+    bool eventClipped;              // A sensor clipped: peaks are lower bounds
+    uint8_t blockRangeShift;        // Highest range of the members of the current block
+    bool blockClipped;
+    bool eventInjected;             // Simulated, or onset while a synthetic waveform was injected
+    uint32_t eventTraceId;          // Latency trace id, one per event
+    uint64_t eventTriggerUs;        // esp_timer time of the trigger sample
+    uint64_t blockStartUs;          // Time of the first sample of the current block
+    
+    // Early-warning alerts for the running event
+    uint16_t alertSequence;
+    uint64_t lastAlertUs;           // Sample time of the last alert
+    
+    // Synthetic waveforms superimposed on the raw samples (end-to-end tests)
+    SyntheticEventInjector injector;
+    
+    // tau_c / Pd preliminary magnitude from the first seconds of the P wave
+    EarlyMagnitudeEstimator earlyMagnitude;
+    
+    // Multi-station coincidence: the finalizer (background task) holds an ended
+    // event until its confirmation deadline so late peer triggers count
+    CoincidenceTrigger coincidence;
+    uint64_t eventOnsetUtcMs;       // 0 without disciplined UTC at the onset
     
     // Adaptive thresholds
     float adaptiveThresholdMicro;
@@ -57,22 +184,19 @@ private:
     unsigned long lastAdaptiveUpdate;
     bool adaptiveThresholdEnabled;
     
-    // Spike filtering
-    float lastMagnitudes[5]; // Buffer for spike detection
-    int magnitudeIndex;
-    bool magnitudeBufferFull;
-    
     // Statistics
     unsigned long totalSamples;
     unsigned long eventsDetected;
-    unsigned long spikesFiltered;
-    float lastMagnitude;
+    SensorData lastSample;  // Last calibrated sample handed to the pipeline
+    SensorData publishedSample; // Copy of it for other tasks, under sampleLock
+    portMUX_TYPE sampleLock;
+    int16_t lastRaw[3];     // Raw counts of that sample (debug logging)
+    uint8_t lastRawShift;   // and the range they were read with
     
     // Detailed logging configuration
     unsigned long detailedLoggingInterval;
     
     // Enhanced calibration monitoring
-    float lastCalibrationOffsets[3]; // Store previous calibration for comparison
     unsigned long lastCalibrationTime;
     float baselineLTA; // Baseline LTA after calibration
     unsigned long lastDriftCheck;
@@ -80,29 +204,97 @@ private:
     
     // Private methods
     float calculateMagnitude(float x, float y, float z);
-    void updateSTALTA(float magnitude);
-    bool checkEventTrigger();
-    void startEvent(float magnitude);
-    void endEvent();
+    const StaLtaStage<SampleFormat>::Detector& staLta() const { return pipeline.stage(StageTag<StaLtaStage>()).detector(); }
+    SpikeFilterStage<SampleFormat>& spikeFilter() { return pipeline.stage(StageTag<SpikeFilterStage>()); }
+    bool calibrateSensor(ArraySensor& sensor);
+    static bool tooManyFailedReads(int failedReads, int wantedReads);
+    SensorData readSensor();
+    bool calibrateBlock(const int16_t* xyz, const int16_t* gyro, size_t stride, size_t count, uint8_t sensorMask);
+    void combineSensors(size_t count, const int* members, int memberCount);
+    void calibrateRates(const int16_t* gyro, size_t stride, size_t count, const int* members, int memberCount);
+    size_t decimateBlock(size_t count, size_t& firstIndex);
+    void finishBlock(size_t count);
+    void exportSamples(SensorData* samples, size_t count, uint64_t t0);
+    void resetFifos();
+    void runPipeline(size_t count);
+    void handleBlock(size_t count);
+    void logProcessingDetails(size_t index);
+    void syncSpikeThreshold();
+    void startEvent(float magnitude, uint64_t triggerUs);
+    void endEvent(uint64_t endUs);
+    void trackEventPeaks(size_t index);
+    void sendAlert(AlertKind kind, uint64_t sampleUs);
     int classifyEvent(float magnitude);
     void updateAdaptiveThresholds();
-    bool isSpikeFiltered(float magnitude);
-    float getMedianMagnitude();
     void checkCalibrationDrift();
+    void computeOrientation(ArraySensor& sensor, float gx, float gy, float gz);
+    void resetOrientation(ArraySensor& sensor);
+    void applyOrientation(const ArraySensor& sensor, float rawX, float rawY, float rawZ, float& outX, float& outY, float& outZ);
+    void rebuildParameterBlock();
+    bool readTemperature(const ArraySensor& sensor, float& tempC);
+    bool readAccelRaw(const ArraySensor& sensor, int16_t& ax, int16_t& ay, int16_t& az);
+    bool readMotionRaw(const ArraySensor& sensor, int16_t* accel, int16_t* gyro);
+    bool isMember(const ArraySensor& sensor) { return sensor.present && (sensor.calibrated || !calibrated); }
+    void updateTemperatureModel();
+    void updateAccelRange(ArraySensor& sensor, uint16_t rawPeak);
+    bool setAccelRange(ArraySensor& sensor, uint8_t rangeShift);
+    bool resetAccelRange(ArraySensor& sensor);
 
 public:
     bool detailedLoggingEnabled;
     Seismograph();
     bool begin();
-    bool calibrate();
-    SensorData readSensor();
-    void processData(SensorData data);
-    void simulateEvent(float magnitude);
+    bool calibrate();   // Before the tasks start or on the sensor task (DualCoreManager::calibrateSensors)
+    // xyz (and gyro, if given): SENSOR_COUNT runs of interleaved X/Y/Z;
+    // returns the mask of sensors read
+    uint8_t readRawSample(int16_t* xyz, int16_t* gyro = nullptr);
+    void injectSynthetic(int16_t* xyz, size_t count);
+    // count reads at ACQUISITION_RATE; returns the samples produced at SAMPLING_RATE
+    // (copied to samples, if given, which must hold count entries)
+    size_t processBlock(const int16_t* xyz, size_t count, uint64_t t0, uint8_t sensorMask = ALL_SENSORS_MASK,
+                      const int16_t* gyro = nullptr, SensorData* samples = nullptr);
+    // FIFO batches: startFifo() switches the sensors to self-paced buffered
+    // reads (accelerometer only); readFifoBatch() returns the reads per sensor
+    // in the processBlock() layout, 0 after an overflow (FIFOs restarted)
+    bool startFifo();
+    void stopFifo();
+    size_t readFifoBatch(int16_t* xyz, size_t maxCount, uint8_t& sensorMask, bool& overflow);
+    bool isFifoMode() { return fifoMode; }
+    unsigned long getFifoOverflows() { return fifoOverflows; }
+    unsigned long getFifoResyncs() { return fifoResyncs; }
+    unsigned long getFifoRestarts() { return fifoRestarts; }
+    SensorData getLastSample() { return lastSample; }  // Sensor task only
+    void getSampleSnapshot(SensorData& sample) {
+        portENTER_CRITICAL(&sampleLock);
+        sample = publishedSample;
+        portEXIT_CRITICAL(&sampleLock);
+    }
     void printStats();
     bool isCalibrated() { return calibrated; }
+    float getMountingTiltDegrees() { return sensors[0].mountingTiltDeg; }
+    const TemperatureCompensator& getTemperatureCompensator(int sensor = 0) { return sensors[sensor].tempCompensator; }
+    const ArraySensor& getSensor(int index) { return sensors[index]; }
+    unsigned long getArrayDisagreements() { return arrayDisagreements; }
+    uint32_t getMaxReadSkewUs() { return maxReadSkewUs; }
+    float getAccelRangeG(int sensor = 0) { return (float)(2 << sensors[sensor].rangeShift); }
+#if GYRO_CHANNELS_ENABLED
+    void setGyroEnabled(bool enabled) { gyroEnabled = enabled && !fifoMode; }
+    bool isGyroEnabled() { return gyroEnabled; }
+#else
+    void setGyroEnabled(bool enabled) {}
+    bool isGyroEnabled() { return false; }
+#endif
+    I2cSensorBus& getSensorBus() { return sensorBus; }
+    BandEnergyMonitor& getBandEnergyMonitor() { return bandMonitor; }
+    unsigned long getBandTriggerCount() { return bandTriggers; }
+    unsigned long getVetoedTriggerCount() { return vetoedTriggers; }
+    CoincidenceTrigger& getCoincidenceTrigger() { return coincidence; }
+    SyntheticEventInjector& getInjector() { return injector; }
+    EarlyMagnitudeEstimator& getEarlyMagnitude() { return earlyMagnitude; }
     unsigned long getEventsDetected() { return eventsDetected; }
-    float getLastMagnitude() { return lastMagnitude; }
-    void setAdaptiveThresholdEnabled(bool enabled) { adaptiveThresholdEnabled = enabled; }
+    bool isEventActive() { return eventActive; }
+    float getLastMagnitude() { return lastSample.magnitudeG(); }
+    void setAdaptiveThresholdEnabled(bool enabled) { adaptiveThresholdEnabled = enabled; syncSpikeThreshold(); }
     bool isAdaptiveThresholdEnabled() { return adaptiveThresholdEnabled; }
     void setDetailedLoggingInterval(unsigned long intervalMs) { detailedLoggingInterval = intervalMs; }
     void enableDetailedLogging(bool enable) { detailedLoggingEnabled = enable; }
@@ -112,9 +304,6 @@ public:
     float calculateLocalMagnitude(float acceleration);
     String getScientificEventDescription(float magnitude, unsigned long duration);
     String getEventTypeFromRichter(float richter);
-    
-    // New seismic event creation
-    void createSeismicEvent(float magnitude, unsigned long duration, const String& source);
     int getIntensityLevelFromRichter(float richter);
     String getRichterRangeFromType(const String& eventType);
     float calculateEnergyJoules(float richter);
@@ -0,0 +1,81 @@
+#ifndef STA_LTA_DETECTOR_H
+#define STA_LTA_DETECTOR_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "../utils/sample_format.h"
+
+// Classic STA/LTA trigger on the sample energy |a|^2, parameterised on the
+// sample format. The trigger compares mean energies against ratio^2, which is
+// the RMS amplitude ratio, so no square root is taken per sample and the
+// ratio test never divides.
+template <typename Format, int StaWindow, int LtaWindow>
+class StaLtaDetector {
+public:
+    typedef typename Format::MagnitudeSq MagnitudeSq;
+    typedef typename Format::Sum Sum;
+
+private:
+    MagnitudeSq staBuffer[StaWindow];
+    MagnitudeSq ltaBuffer[LtaWindow];
+    int staIndex;
+    int ltaIndex;
+    Sum staSum;
+    Sum ltaSum;
+    bool staFull;
+    bool ltaFull;
+
+public:
+    StaLtaDetector() { reset(); }
+    
+    void reset() {
+        staIndex = 0;
+        ltaIndex = 0;
+        staSum = 0;
+        ltaSum = 0;
+        staFull = false;
+        ltaFull = false;
+        for (int i = 0; i < StaWindow; i++) staBuffer[i] = 0;
+        for (int i = 0; i < LtaWindow; i++) ltaBuffer[i] = 0;
+    }
+    
+    void update(MagnitudeSq magnitudeSq) {
+        // Update STA (Short-Term Average)
+        staSum -= staBuffer[staIndex];
+        staBuffer[staIndex] = magnitudeSq;
+        staSum += magnitudeSq;
+        if (++staIndex == StaWindow) {
+            staIndex = 0;
+            staFull = true;
+        }
+        
+        // Update LTA (Long-Term Average)
+        ltaSum -= ltaBuffer[ltaIndex];
+        ltaBuffer[ltaIndex] = magnitudeSq;
+        ltaSum += magnitudeSq;
+        if (++ltaIndex == LtaWindow) {
+            ltaIndex = 0;
+            ltaFull = true;
+        }
+    }
+    
+    bool isReady() const { return staFull && ltaFull; }
+    bool isLtaFull() const { return ltaFull; }
+    
+    bool isTriggered(float ratio) const {
+        if (!isReady() || ltaSum == 0) return false;
+        return Format::ratioExceeds(staSum, StaWindow, ltaSum, LtaWindow, ratio * ratio);
+    }
+    
+    // Diagnostics as RMS in g - not used on the per-sample path
+    float getSTA() const { return sqrtf(Format::sumSqToG2(staSum) / StaWindow); }
+    float getLTA() const { return sqrtf(Format::sumSqToG2(ltaSum) / LtaWindow); }
+    float getRatio() const {
+        float lta = getLTA();
+        return (lta > 0) ? getSTA() / lta : 0.0f;
+    }
+    
+    static size_t bufferBytes() { return sizeof(MagnitudeSq) * (StaWindow + LtaWindow); }
+};
+
+#endif // STA_LTA_DETECTOR_H
@@ -0,0 +1,176 @@
+#include "synthetic_injector.h"
+
+// Horizontal/vertical split of the simple shapes (unit vector), so the
+// vertical-only consumers (RSAM, helicorder) see the injection as well
+static const float SIMPLE_DIRECTION[3] = { 0.64f, 0.48f, 0.6f };
+
+SyntheticEventInjector::SyntheticEventInjector() {
+    lock = portMUX_INITIALIZER_UNLOCKED;
+    requestPending = false;
+    cancelPending = false;
+    request.shape = SyntheticShape::QUAKE;
+    request.pgaG = 0.0f;
+    request.durationMs = 0;
+    request.frequencyHz = SYNTHETIC_DEFAULT_FREQ_HZ;
+    requestScale = 0.0f;
+
+    active = false;
+    current = request;
+    scale = 0.0f;
+    sampleIndex = 0;
+    totalSamples = 0;
+
+    injectionsStarted = 0;
+    injectionsCompleted = 0;
+    injectionsCancelled = 0;
+}
+
+bool SyntheticEventInjector::arm(const SyntheticWaveform& waveform) {
+    if (isActive()) return false;
+
+    SyntheticWaveform armed = waveform;
+    armed.durationMs = constrain(armed.durationMs, (unsigned long)SYNTHETIC_MIN_DURATION_MS,
+                                 (unsigned long)SYNTHETIC_MAX_DURATION_MS);
+    armed.frequencyHz = constrain(armed.frequencyHz, 0.5f, SAMPLING_RATE / 4.0f);
+    if (armed.pgaG <= 0.0f) return false;
+
+    // Normalise to the vector peak of the sampled waveform, so the pipeline
+    // sees exactly pgaG at the rate the sensor is read (frequency capped
+    // well inside the pass band of the decimator when oversampling)
+    unsigned long samples = armed.durationMs * ACQUISITION_RATE / 1000;
+    float peak = 0.0f;
+    for (unsigned long n = 0; n < samples; n++) {
+        float x, y, z;
+        shapeSample(armed, n, x, y, z);
+        float magnitude = sqrtf(x * x + y * y + z * z);
+        if (magnitude > peak) peak = magnitude;
+    }
+    if (peak <= 0.0f) return false;
+
+    portENTER_CRITICAL(&lock);
+    request = armed;
+    requestScale = armed.pgaG / peak;
+    requestPending = true;
+    portEXIT_CRITICAL(&lock);
+    return true;
+}
+
+void SyntheticEventInjector::cancel() {
+    portENTER_CRITICAL(&lock);
+    requestPending = false;
+    if (active) cancelPending = true;
+    portEXIT_CRITICAL(&lock);
+}
+
+bool SyntheticEventInjector::next(float& x, float& y, float& z) {
+    if (!active) {
+        // Idle fast path: one flag read per sample
+        if (!requestPending) return false;
+
+        portENTER_CRITICAL(&lock);
+        current = request;
+        scale = requestScale;
+        requestPending = false;
+        cancelPending = false;
+        portEXIT_CRITICAL(&lock);
+
+        sampleIndex = 0;
+        totalSamples = current.durationMs * ACQUISITION_RATE / 1000;
+        active = true;
+        injectionsStarted++;
+    }
+
+    if (cancelPending) {
+        cancelPending = false;
+        active = false;
+        injectionsCancelled++;
+        return false;
+    }
+
+    shapeSample(current, sampleIndex, x, y, z);
+    x *= scale;
+    y *= scale;
+    z *= scale;
+
+    if (++sampleIndex >= totalSamples) {
+        active = false;
+        injectionsCompleted++;
+    }
+    return true;
+}
+
+unsigned long SyntheticEventInjector::getRemainingMs() {
+    if (!active) return requestPending ? request.durationMs : 0;
+    return (totalSamples - sampleIndex) * 1000UL / ACQUISITION_RATE;
+}
+
+void SyntheticEventInjector::shapeSample(const SyntheticWaveform& waveform, unsigned long n,
+                                         float& x, float& y, float& z) {
+    float t = (float)n / ACQUISITION_RATE;
+    float T = waveform.durationMs / 1000.0f;
+    float f = waveform.frequencyHz;
+    float s = 0.0f;
+
+    switch (waveform.shape) {
+        case SyntheticShape::SINE_BURST: {
+            float w = sinf(PI * t / T);
+            s = w * w * sinf(2.0f * PI * f * t);
+            break;
+        }
+        case SyntheticShape::RICKER: {
+            float a = PI * f * (t - T / 2.0f);
+            a *= a;
+            s = (1.0f - 2.0f * a) * expf(-a);
+            break;
+        }
+        case SyntheticShape::CHIRP: {
+            float w = sinf(PI * t / T);
+            float f0 = 2.0f * f;
+            float f1 = 0.5f * f;
+            s = w * w * sinf(2.0f * PI * (f0 * t + (f1 - f0) * t * t / (2.0f * T)));
+            break;
+        }
+        case SyntheticShape::QUAKE: {
+            // Envelopes u*e^(1-u) peak at 1 for u = 1 and have decayed to
+            // a few per mille by the end of the window
+            float u = t / (0.05f * T);
+            float p = 0.25f * u * expf(1.0f - u) * sinf(2.0f * PI * 2.0f * f * t);
+
+            float sPhase = 0.0f;
+            float tS = 0.15f * T;
+            if (t >= tS) {
+                float ts = t - tS;
+                float v = ts / (0.1f * T);
+                sPhase = v * expf(1.0f - v) *
+                         (sinf(2.0f * PI * f * ts) + 0.4f * sinf(2.0f * PI * 1.6f * f * ts + 1.0f));
+            }
+            x = 0.8f * sPhase;
+            y = 0.6f * sPhase;
+            z = p + 0.2f * sPhase;
+            return;
+        }
+    }
+
+    x = SIMPLE_DIRECTION[0] * s;
+    y = SIMPLE_DIRECTION[1] * s;
+    z = SIMPLE_DIRECTION[2] * s;
+}
+
+bool SyntheticEventInjector::parseShape(const String& name, SyntheticShape& shape) {
+    if (name == "sine") shape = SyntheticShape::SINE_BURST;
+    else if (name == "ricker") shape = SyntheticShape::RICKER;
+    else if (name == "chirp") shape = SyntheticShape::CHIRP;
+    else if (name == "quake") shape = SyntheticShape::QUAKE;
+    else return false;
+    return true;
+}
+
+const char* SyntheticEventInjector::shapeName(SyntheticShape shape) {
+    switch (shape) {
+        case SyntheticShape::SINE_BURST: return "sine";
+        case SyntheticShape::RICKER: return "ricker";
+        case SyntheticShape::CHIRP: return "chirp";
+        case SyntheticShape::QUAKE: return "quake";
+    }
+    return "unknown";
+}
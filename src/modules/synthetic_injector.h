@@ -0,0 +1,72 @@
+#ifndef SYNTHETIC_INJECTOR_H
+#define SYNTHETIC_INJECTOR_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "config.h"
+
+enum class SyntheticShape : uint8_t {
+    SINE_BURST,  // Hann-windowed sine at the given frequency
+    RICKER,      // Ricker wavelet centred in the window
+    CHIRP,       // Hann-windowed sweep from 2f down to f/2
+    QUAKE        // Vertical P onset followed by a horizontal S phase and coda
+};
+
+struct SyntheticWaveform {
+    SyntheticShape shape;
+    float pgaG;              // Peak vector acceleration of the injected signal
+    unsigned long durationMs;
+    float frequencyHz;       // Dominant frequency
+};
+
+// Superimposes a synthetic waveform onto the live sample stream so an
+// injected event runs through calibration, filters, spike filter, STA/LTA
+// and every consumer exactly like ground motion would.
+//
+// arm() may be called from any task; the waveform is normalised there so
+// its vector peak equals pgaG. next() runs in the sensor task, one call per
+// sample, and returns the Z-up frame offset in g.
+class SyntheticEventInjector {
+private:
+    portMUX_TYPE lock;
+
+    // Armed request, picked up by the sensor task
+    volatile bool requestPending;
+    volatile bool cancelPending;
+    SyntheticWaveform request;
+    float requestScale;
+
+    // Running injection (sensor task only)
+    volatile bool active;
+    SyntheticWaveform current;
+    float scale;
+    unsigned long sampleIndex;
+    unsigned long totalSamples;
+
+    unsigned long injectionsStarted;
+    unsigned long injectionsCompleted;
+    unsigned long injectionsCancelled;
+
+    static void shapeSample(const SyntheticWaveform& waveform, unsigned long n, float& x, float& y, float& z);
+
+public:
+    SyntheticEventInjector();
+
+    // Any task: queue an injection; false while another one is armed or running
+    bool arm(const SyntheticWaveform& waveform);
+    void cancel();
+
+    // Sensor task: next offset (g, Z-up frame); false when nothing is injected
+    bool next(float& x, float& y, float& z);
+
+    bool isActive() { return active || requestPending; }
+    unsigned long getRemainingMs();
+    unsigned long getInjectionsStarted() { return injectionsStarted; }
+    unsigned long getInjectionsCompleted() { return injectionsCompleted; }
+    unsigned long getInjectionsCancelled() { return injectionsCancelled; }
+
+    static bool parseShape(const String& name, SyntheticShape& shape);
+    static const char* shapeName(SyntheticShape shape);
+};
+
+#endif // SYNTHETIC_INJECTOR_H
@@ -0,0 +1,86 @@
+#include "temperature_compensator.h"
+
+TemperatureCompensator::TemperatureCompensator() {
+    reset(25.0f);
+}
+
+void TemperatureCompensator::reset(float referenceTempC) {
+    referenceTemp = referenceTempC;
+    lastTemp = referenceTempC;
+    minTempSeen = referenceTempC;
+    maxTempSeen = referenceTempC;
+    observations = 0;
+    
+    sumW = 0.0;
+    sumT = 0.0;
+    sumTT = 0.0;
+    for (int axis = 0; axis < 3; axis++) {
+        sumY[axis] = 0.0;
+        sumTY[axis] = 0.0;
+        intercept[axis] = 0.0f;
+        slope[axis] = 0.0f;
+        residualRms[axis] = 0.0f;
+        compensation[axis] = 0.0f;
+    }
+    modelReady = false;
+}
+
+void TemperatureCompensator::addObservation(float tempC, const float axisMean[3]) {
+    if (isnan(tempC)) return;
+    
+    double t = tempC - referenceTemp;
+    const double lambda = TEMP_COMP_FORGETTING_FACTOR;
+    
+    // Track residuals of the current model before it absorbs this observation
+    if (modelReady) {
+        for (int axis = 0; axis < 3; axis++) {
+            float predicted = intercept[axis] + slope[axis] * (float)t;
+            float residual = axisMean[axis] - predicted;
+            residualRms[axis] = sqrt(TEMP_COMP_RESIDUAL_ALPHA * residual * residual +
+                                     (1.0f - TEMP_COMP_RESIDUAL_ALPHA) * residualRms[axis] * residualRms[axis]);
+        }
+    }
+    
+    sumW = lambda * sumW + 1.0;
+    sumT = lambda * sumT + t;
+    sumTT = lambda * sumTT + t * t;
+    for (int axis = 0; axis < 3; axis++) {
+        sumY[axis] = lambda * sumY[axis] + axisMean[axis];
+        sumTY[axis] = lambda * sumTY[axis] + t * axisMean[axis];
+    }
+    
+    observations++;
+    if (tempC < minTempSeen) minTempSeen = tempC;
+    if (tempC > maxTempSeen) maxTempSeen = tempC;
+    
+    updateModel();
+    updateCompensation(tempC);
+}
+
+void TemperatureCompensator::updateModel() {
+    // A slope needs temperature variation to be meaningful
+    if (observations < TEMP_COMP_MIN_OBSERVATIONS || getTempSpan() < TEMP_COMP_MIN_SPAN_C) {
+        return;
+    }
+    
+    double denominator = sumW * sumTT - sumT * sumT;
+    if (denominator <= 1e-9) return;
+    
+    for (int axis = 0; axis < 3; axis++) {
+        double b = (sumW * sumTY[axis] - sumT * sumY[axis]) / denominator;
+        double a = (sumY[axis] - b * sumT) / sumW;
+        slope[axis] = (float)b;
+        intercept[axis] = (float)a;
+    }
+    modelReady = true;
+}
+
+void TemperatureCompensator::updateCompensation(float tempC) {
+    if (isnan(tempC)) return;
+    lastTemp = tempC;
+    
+    float t = tempC - referenceTemp;
+    for (int axis = 0; axis < 3; axis++) {
+        compensation[axis] = intercept[axis] + slope[axis] * t;
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef TEMPERATURE_COMPENSATOR_H
+#define TEMPERATURE_COMPENSATOR_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Online per-axis model of accelerometer offset versus die temperature:
+//   offset(T) = intercept + slope * (T - referenceTemp)
+// fitted by exponentially weighted least squares so the model follows slow
+// sensor ageing while still spanning several daily temperature cycles.
+class TemperatureCompensator {
+private:
+    float referenceTemp;
+    float lastTemp;
+    float minTempSeen;
+    float maxTempSeen;
+    unsigned long observations;
+    
+    // Weighted regression sums (double: weights approach 1/(1-lambda))
+    double sumW;
+    double sumT;
+    double sumTT;
+    double sumY[3];
+    double sumTY[3];
+    
+    // Fitted model and quality
+    float intercept[3];
+    float slope[3];
+    float residualRms[3];
+    float compensation[3];
+    bool modelReady;
+    
+    void updateModel();
+
+public:
+    TemperatureCompensator();
+    void reset(float referenceTempC);
+    void addObservation(float tempC, const float axisMean[3]);
+    void updateCompensation(float tempC);
+    
+    // Per-sample path: cached offsets for the last temperature reading
+    float getCompensation(int axis) const { return modelReady ? compensation[axis] : 0.0f; }
+    
+    bool isReady() const { return modelReady; }
+    float getReferenceTemp() const { return referenceTemp; }
+    float getLastTemp() const { return lastTemp; }
+    float getTempSpan() const { return observations > 0 ? maxTempSeen - minTempSeen : 0.0f; }
+    float getIntercept(int axis) const { return intercept[axis]; }
+    float getSlope(int axis) const { return slope[axis]; }
+    float getResidualRms(int axis) const { return residualRms[axis]; }
+    unsigned long getObservationCount() const { return observations; }
+    
+    static float rawToCelsius(int16_t raw) { return raw / 340.0f + 36.53f; }
+};
+
+#endif // TEMPERATURE_COMPENSATOR_H
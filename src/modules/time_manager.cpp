@@ -1,4 +1,6 @@
 #include "time_manager.h"
+#include <sys/time.h>
+#include <esp_timer.h>
 
 TimeManager::TimeManager() : timeClient(ntpUDP, NTP_SERVER1, TIMEZONE_OFFSET) {
     detailedLoggingEnabled = false;
@@ -18,6 +20,10 @@ bool TimeManager::begin() {
     timeClient.begin();
     timeClient.setTimeOffset(TIMEZONE_OFFSET);
     
+    // The system clock is kept in UTC by the IDF SNTP client, which slews it
+    // with sub-second precision; NTPClient only resolves whole seconds
+    configTime(0, 0, NTP_SERVER1, NTP_SERVER2, NTP_SERVER3);
+    
     // Try to sync with NTP
     if (syncWithNTP()) {
         initialized = true;
@@ -130,6 +136,27 @@ unsigned long TimeManager::getEpochTime() {
     return timeClient.getEpochTime();
 }
 
+bool TimeManager::getEpochTimeMs(uint64_t& epochMs) {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    // Before the first SNTP sync the system clock starts at 1970
+    if (tv.tv_sec < 1600000000) return false;
+    epochMs = (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+    return true;
+}
+
+bool TimeManager::timerToEpochMs(uint64_t timerUs, uint64_t& epochMs) {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    int64_t nowUs = esp_timer_get_time();
+    if (tv.tv_sec < 1600000000) return false;
+    // Both clocks read back to back; the offset between them carries the
+    // sample time over to UTC
+    int64_t epochUs = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec - (nowUs - (int64_t)timerUs);
+    epochMs = (uint64_t)(epochUs / 1000);
+    return true;
+}
+
 unsigned long TimeManager::getUptime() {
     return millis() / 1000;
 }
@@ -151,3 +178,27 @@ void TimeManager::setTimezone() {
     // This is handled by the NTPClient timeOffset
     // Additional timezone logic could be added here if needed
 }
+
+bool TimeManager::parseDateToEpochDay(const String& date, uint32_t& epochDay) {
+    int year, month, day;
+    if (sscanf(date.c_str(), "%d-%d-%d", &year, &month, &day) != 3) return false;
+    if (year < 1970 || month < 1 || month > 12 || day < 1 || day > 31) return false;
+    
+    // Days from civil date (proleptic Gregorian)
+    year -= month <= 2;
+    int era = year / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    epochDay = (uint32_t)(era * 146097 + dayOfEra - 719468);
+    return true;
+}
+
+String TimeManager::formatEpochDay(uint32_t epochDay) {
+    time_t rawTime = (time_t)epochDay * 86400;
+    struct tm* ptm = gmtime(&rawTime);
+    
+    char buffer[16];
+    sprintf(buffer, "%04d-%02d-%02d", ptm->tm_year + 1900, ptm->tm_mon + 1, ptm->tm_mday);
+    return String(buffer);
+}
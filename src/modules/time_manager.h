@@ -31,12 +31,20 @@ public:
     String getFormattedDate();
     String getFormattedDateTime();
     unsigned long getEpochTime();
+    // UTC with ms resolution from the SNTP-disciplined system clock (any core)
+    static bool getEpochTimeMs(uint64_t& epochMs);
+    // esp_timer µs (sample timestamps) -> UTC ms, for events stamped by sample time
+    static bool timerToEpochMs(uint64_t timerUs, uint64_t& epochMs);
     unsigned long getUptime();
     
     // Utility methods
     bool isTimeValid();
     void forceSync();
     String formatTimestamp(unsigned long timestamp);
+    
+    // "YYYY-MM-DD" -> days since 1970-01-01 (archive file names)
+    static bool parseDateToEpochDay(const String& date, uint32_t& epochDay);
+    static String formatEpochDay(uint32_t epochDay);
 };
 
 #endif // TIME_MANAGER_H
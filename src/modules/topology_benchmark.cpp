@@ -0,0 +1,223 @@
+#include "topology_benchmark.h"
+#include "web_server.h"
+#include <ArduinoJson.h>
+
+TopologyBenchmark::TopologyBenchmark() {
+    coreManagerRef = nullptr;
+    webServerRef = nullptr;
+    startRequested = false;
+    requestedMeasureMs = BENCH_DEFAULT_MEASURE_MS;
+    requestedLoad = true;
+
+    phase = PHASE_IDLE;
+    presetIndex = 0;
+    phaseStart = 0;
+    measureMs = BENCH_DEFAULT_MEASURE_MS;
+    loadEnabled = true;
+    lastBurst = 0;
+    loadBytes = 0;
+
+    resultCount = 0;
+    runsCompleted = 0;
+    resultsLock = portMUX_INITIALIZER_UNLOCKED;
+
+    memset(loadPacket, 0xA5, sizeof(loadPacket));
+}
+
+void TopologyBenchmark::setReferences(DualCoreManager* coreManager, WebServerManager* webServer) {
+    coreManagerRef = coreManager;
+    webServerRef = webServer;
+}
+
+bool TopologyBenchmark::start(unsigned long measureMsPerTopology, bool withLoad) {
+    if (coreManagerRef == nullptr || isRunning()) return false;
+
+    requestedMeasureMs = constrain(measureMsPerTopology, 1000UL, (unsigned long)BENCH_MAX_MEASURE_MS);
+    requestedLoad = withLoad;
+    startRequested = true;
+    return true;
+}
+
+void TopologyBenchmark::loop() {
+    if (phase == PHASE_IDLE) {
+        if (!startRequested) return;
+
+        measureMs = requestedMeasureMs;
+        loadEnabled = requestedLoad;
+        if (wsLoad.length() == 0) {
+            // Roughly one WebSocket frame of filler per burst
+            wsLoad = "{\"type\":\"bench_load\",\"pad\":\"";
+            for (int i = 0; i < BENCH_LOAD_PACKET_BYTES - 40; i++) wsLoad += 'x';
+            wsLoad += "\"}";
+        }
+        portENTER_CRITICAL(&resultsLock);
+        resultCount = 0;
+        portEXIT_CRITICAL(&resultsLock);
+        Serial.printf("Topology benchmark: %lu ms per topology, Wi-Fi load %s\n",
+                      measureMs, loadEnabled ? "on" : "off");
+        beginPhase(0);
+        startRequested = false;
+        return;
+    }
+
+    unsigned long now = millis();
+    if (phase == PHASE_SETTLING) {
+        if (now - phaseStart >= BENCH_SETTLE_MS) {
+            coreManagerRef->resetSensorTiming();
+            loadBytes = 0;
+            lastBurst = 0;
+            phase = PHASE_MEASURING;
+            phaseStart = now;
+        }
+        return;
+    }
+
+    // Measuring
+    if (loadEnabled && now - lastBurst >= BENCH_LOAD_INTERVAL_MS) {
+        sendLoadBurst();
+        lastBurst = now;
+    }
+    if (now - phaseStart >= measureMs) {
+        finishPhase();
+    }
+}
+
+void TopologyBenchmark::beginPhase(int index) {
+    int presetCount;
+    const TaskTopology* presets = DualCoreManager::getTopologyPresets(presetCount);
+    for (; index < presetCount && index < BENCH_MAX_TOPOLOGIES; index++) {
+        if (coreManagerRef->applyTopology(presets[index])) {
+            presetIndex = index;
+            phase = PHASE_SETTLING;
+            phaseStart = millis();
+            return;
+        }
+        // The previous layout is still running; measuring now would file
+        // its numbers under this preset
+        TopologyBenchmarkResult skipped;
+        memset(&skipped, 0, sizeof(skipped));
+        skipped.topology = presets[index];
+        skipped.applied = false;
+        storeResult(skipped);
+        Serial.printf("Topology %-20s could not be applied - skipped\n", presets[index].name);
+    }
+    finishRun();
+}
+
+void TopologyBenchmark::finishPhase() {
+    TopologyBenchmarkResult result;
+    result.topology = coreManagerRef->getTopology();
+    result.applied = true;
+    result.periods = coreManagerRef->getSensorPeriods();
+    result.meanJitterUs = coreManagerRef->getMeanSensorJitterUs();
+    result.minPeriodUs = coreManagerRef->getMinSensorPeriodUs();
+    result.maxPeriodUs = coreManagerRef->getMaxSensorPeriodUs();
+    result.maxProcessingUs = coreManagerRef->getMaxSensorProcessingUs();
+    result.sensorLoadPct = coreManagerRef->getSensorLoadPercent();
+    result.lateIterations = coreManagerRef->getLateSensorIterations();
+    result.queueDrops = coreManagerRef->getSensorQueueDrops();
+    result.loadBytes = loadBytes;
+    storeResult(result);
+
+    Serial.printf("Topology %-20s jitter %.1f us, period %lu..%lu us, sensor load %.1f%%, %lu late, %lu drops, %lu KB load\n",
+                  result.topology.name, result.meanJitterUs, (unsigned long)result.minPeriodUs,
+                  (unsigned long)result.maxPeriodUs, result.sensorLoadPct, result.lateIterations,
+                  result.queueDrops, result.loadBytes / 1024);
+
+    beginPhase(presetIndex + 1);
+}
+
+void TopologyBenchmark::finishRun() {
+    // Back to the configured layout
+    if (!coreManagerRef->applyTopology(DualCoreManager::configuredTopology())) {
+        Serial.printf("ERROR: Configured topology not restored, still on '%s'\n", coreManagerRef->getTopology().name);
+    }
+    phase = PHASE_IDLE;
+    runsCompleted++;
+    Serial.println("Topology benchmark complete");
+}
+
+void TopologyBenchmark::storeResult(const TopologyBenchmarkResult& result) {
+    portENTER_CRITICAL(&resultsLock);
+    if (resultCount < BENCH_MAX_TOPOLOGIES) results[resultCount++] = result;
+    portEXIT_CRITICAL(&resultsLock);
+}
+
+void TopologyBenchmark::sendLoadBurst() {
+    if (WiFi.status() != WL_CONNECTED) return;
+
+    // Broadcast reaches the air even without a listener
+    IPAddress broadcast(255, 255, 255, 255);
+    for (int i = 0; i < BENCH_LOAD_PACKETS; i++) {
+        if (udp.beginPacket(broadcast, BENCH_LOAD_UDP_PORT)) {
+            udp.write(loadPacket, sizeof(loadPacket));
+            if (udp.endPacket()) loadBytes += sizeof(loadPacket);
+        }
+    }
+
+    if (webServerRef != nullptr && webServerRef->broadcastRaw(wsLoad)) {
+        loadBytes += wsLoad.length() * webServerRef->getConnectedClients();
+    }
+}
+
+String TopologyBenchmark::getResultsJson() {
+    JsonDocument doc;
+    doc["running"] = isRunning();
+    doc["runs_completed"] = runsCompleted;
+    doc["measure_ms"] = measureMs;
+    doc["load"] = loadEnabled;
+    doc["acquisition_rate_hz"] = ACQUISITION_RATE;
+    doc["oversample_factor"] = OVERSAMPLE_FACTOR;
+    if (coreManagerRef != nullptr) doc["active_topology"] = coreManagerRef->getTopology().name;
+
+    const TaskTopology& configured = DualCoreManager::configuredTopology();
+    JsonObject configuredJson = doc["configured"].to<JsonObject>();
+    configuredJson["sensor_core"] = configured.sensorCore;
+    configuredJson["sensor_priority"] = configured.sensorPriority;
+    configuredJson["background_core"] = configured.backgroundCore;
+    configuredJson["background_priority"] = configured.backgroundPriority;
+
+    JsonArray list = doc["results"].to<JsonArray>();
+    const char* best = nullptr;
+    uint32_t bestMaxPeriod = 0;
+    float bestJitter = 0.0f;
+    for (int i = 0; i < BENCH_MAX_TOPOLOGIES; i++) {
+        TopologyBenchmarkResult result;
+        portENTER_CRITICAL(&resultsLock);
+        bool present = i < resultCount;
+        if (present) result = results[i];
+        portEXIT_CRITICAL(&resultsLock);
+        if (!present) break;
+
+        JsonObject entry = list.add<JsonObject>();
+        entry["name"] = result.topology.name;
+        entry["sensor_core"] = result.topology.sensorCore;
+        entry["sensor_priority"] = result.topology.sensorPriority;
+        entry["background_core"] = result.topology.backgroundCore;
+        entry["background_priority"] = result.topology.backgroundPriority;
+        entry["applied"] = result.applied;
+        if (!result.applied) continue;
+        entry["periods"] = result.periods;
+        entry["mean_jitter_us"] = result.meanJitterUs;
+        entry["min_period_us"] = result.minPeriodUs;
+        entry["max_period_us"] = result.maxPeriodUs;
+        entry["max_processing_us"] = result.maxProcessingUs;
+        entry["sensor_load_pct"] = result.sensorLoadPct;
+        entry["late_iterations"] = result.lateIterations;
+        entry["queue_drops"] = result.queueDrops;
+        entry["load_bytes"] = result.loadBytes;
+
+        // Worst-case period first, mean jitter as tie-breaker
+        if (best == nullptr || result.maxPeriodUs < bestMaxPeriod ||
+            (result.maxPeriodUs == bestMaxPeriod && result.meanJitterUs < bestJitter)) {
+            best = result.topology.name;
+            bestMaxPeriod = result.maxPeriodUs;
+            bestJitter = result.meanJitterUs;
+        }
+    }
+    if (best != nullptr) doc["best"] = best;
+
+    String output;
+    serializeJson(doc, output);
+    return output;
+}
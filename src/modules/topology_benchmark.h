@@ -0,0 +1,84 @@
+#ifndef TOPOLOGY_BENCHMARK_H
+#define TOPOLOGY_BENCHMARK_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <freertos/FreeRTOS.h>
+#include "config.h"
+#include "dual_core_manager.h"
+
+class WebServerManager;
+
+#define BENCH_MAX_TOPOLOGIES 8
+
+// Sampling jitter of one topology over one measurement phase
+struct TopologyBenchmarkResult {
+    TaskTopology topology;
+    bool applied;                   // False: the preset could not be started, nothing measured
+    unsigned long periods;
+    float meanJitterUs;
+    uint32_t minPeriodUs;
+    uint32_t maxPeriodUs;
+    uint32_t maxProcessingUs;
+    float sensorLoadPct;            // Busy share of the sensor core at ACQUISITION_RATE
+    unsigned long lateIterations;
+    unsigned long queueDrops;
+    unsigned long loadBytes;        // Synthetic traffic sent during the phase
+};
+
+// Runs every task topology preset in turn: switch, settle, then measure the
+// sensor period for a fixed time while bursts of UDP broadcast (and
+// WebSocket messages, if clients are connected) load the Wi-Fi stack. The
+// configured topology is restored at the end.
+//
+// loop() runs from the Arduino loop task; start() may be called from any
+// task and only raises a request.
+class TopologyBenchmark {
+private:
+    enum Phase { PHASE_IDLE, PHASE_SETTLING, PHASE_MEASURING };
+
+    DualCoreManager* coreManagerRef;
+    WebServerManager* webServerRef;
+
+    volatile bool startRequested;
+    unsigned long requestedMeasureMs;
+    bool requestedLoad;
+
+    Phase phase;
+    int presetIndex;
+    unsigned long phaseStart;
+    unsigned long measureMs;
+    bool loadEnabled;
+    unsigned long lastBurst;
+    unsigned long loadBytes;
+
+    TopologyBenchmarkResult results[BENCH_MAX_TOPOLOGIES];
+    int resultCount;
+    unsigned long runsCompleted;
+    portMUX_TYPE resultsLock;
+
+    WiFiUDP udp;
+    uint8_t loadPacket[BENCH_LOAD_PACKET_BYTES];
+    String wsLoad;
+
+    void beginPhase(int index);
+    void finishPhase();
+    void finishRun();
+    void storeResult(const TopologyBenchmarkResult& result);
+    void sendLoadBurst();
+
+public:
+    TopologyBenchmark();
+    void setReferences(DualCoreManager* coreManager, WebServerManager* webServer);
+
+    // Any task: request a run; false while one is in progress
+    bool start(unsigned long measureMsPerTopology, bool withLoad);
+    // Arduino loop task
+    void loop();
+
+    bool isRunning() { return phase != PHASE_IDLE || startRequested; }
+    String getResultsJson();
+};
+
+#endif // TOPOLOGY_BENCHMARK_H
@@ -0,0 +1,246 @@
+#include "waveform_recorder.h"
+#include <ArduinoJson.h>
+#include "time_manager.h"
+
+const uint32_t WaveformRecorder::SEGMENT_MAGIC;
+const uint8_t WaveformRecorder::FORMAT_VERSION;
+const uint8_t WaveformRecorder::FRACTION_BITS;
+const int WaveformRecorder::PRETRIGGER_SAMPLES;
+const int WaveformRecorder::QUIET_DECIMATION;
+
+// ±2 g counts per g with the fraction bits: the finest archive unit,
+// coarsened per segment by scaleShift
+static const float ARCHIVE_COUNTS_PER_G = MPU6050_ACCEL_SCALE * (1 << WaveformRecorder::FRACTION_BITS);
+
+WaveformRecorder::WaveformRecorder() : retention("/wave", WAVEFORM_RETENTION_DAYS) {
+    detailedLoggingEnabled = false;
+    initialized = false;
+
+    ringHead = 0;
+    ringCount = 0;
+    ringNewestMs = 0;
+
+    fullRate = false;
+    capped = false;
+    fullRateSinceMs = 0;
+    lastActiveMs = 0;
+    lastFullRateMs = 0;
+    haveFullRate = false;
+
+    quietSum[0] = quietSum[1] = quietSum[2] = 0.0f;
+    quietCount = 0;
+    quietStartMs = 0;
+
+    segmentCount = 0;
+    segmentMode = SEGMENT_QUIET;
+    segmentRate = 0;
+    segmentStartMs = 0;
+
+    segmentsWritten = 0;
+    samplesWritten = 0;
+    writeErrors = 0;
+    unanchoredSegments = 0;
+    rateSwitches = 0;
+    eventsCaptured = 0;
+}
+
+bool WaveformRecorder::begin() {
+    if (!LittleFS.exists("/wave") && !LittleFS.mkdir("/wave")) {
+        Serial.println("ERROR: Failed to create /wave directory");
+        return false;
+    }
+    initialized = true;
+    if (detailedLoggingEnabled) {
+        Serial.printf("Waveform archive initialized (%d Hz quiet, %d Hz events, %d ms pre-trigger)\n",
+                      ADAPTIVE_QUIET_RATE_HZ, SAMPLING_RATE, ADAPTIVE_PRETRIGGER_MS);
+    }
+    return true;
+}
+
+void WaveformRecorder::addSample(float accelX, float accelY, float accelZ, unsigned long timestampMs, bool eventActive) {
+    Triple value = { accelX, accelY, accelZ };
+
+    if (eventActive) {
+        lastActiveMs = timestampMs;
+    } else {
+        capped = false;
+    }
+
+    if (!fullRate) {
+        if (eventActive && !capped) startFullRate(timestampMs);
+    } else if (!eventActive && timestampMs - lastActiveMs >= ADAPTIVE_POSTTRIGGER_MS) {
+        stopFullRate();
+    } else if (timestampMs - fullRateSinceMs >= ADAPTIVE_MAX_EVENT_MS) {
+        // Flash budget: a stuck detector must not archive at full rate forever
+        capped = eventActive;
+        stopFullRate();
+    }
+
+    // The ring always runs at full rate, so the next trigger finds it filled
+    ring[ringHead] = value;
+    ringHead = (ringHead + 1) % PRETRIGGER_SAMPLES;
+    if (ringCount < PRETRIGGER_SAMPLES) ringCount++;
+    ringNewestMs = timestampMs;
+
+    if (fullRate) {
+        append(SEGMENT_EVENT, SAMPLING_RATE, timestampMs, value);
+        lastFullRateMs = timestampMs;
+        haveFullRate = true;
+        return;
+    }
+
+    // Quiet: one mean per interval (a boxcar ahead of the decimation)
+    if (quietCount == 0) quietStartMs = timestampMs;
+    quietSum[0] += accelX;
+    quietSum[1] += accelY;
+    quietSum[2] += accelZ;
+    if (++quietCount == QUIET_DECIMATION) {
+        Triple mean = { quietSum[0] / QUIET_DECIMATION, quietSum[1] / QUIET_DECIMATION, quietSum[2] / QUIET_DECIMATION };
+        append(SEGMENT_QUIET, ADAPTIVE_QUIET_RATE_HZ, quietStartMs, mean);
+        quietSum[0] = quietSum[1] = quietSum[2] = 0.0f;
+        quietCount = 0;
+    }
+}
+
+void WaveformRecorder::startFullRate(unsigned long timestampMs) {
+    fullRate = true;
+    fullRateSinceMs = timestampMs;
+    rateSwitches++;
+    eventsCaptured++;
+
+    // The unfinished quiet interval is covered by the pre-trigger samples
+    closeSegment();
+    quietSum[0] = quietSum[1] = quietSum[2] = 0.0f;
+    quietCount = 0;
+
+    // Ring, oldest first; samples already archived at full rate (a trigger
+    // soon after the previous event) are skipped
+    int oldest = (ringHead - ringCount + PRETRIGGER_SAMPLES) % PRETRIGGER_SAMPLES;
+    for (int i = 0; i < ringCount; i++) {
+        unsigned long sampleMs = ringNewestMs - (unsigned long)((uint32_t)(ringCount - 1 - i) * 1000 / SAMPLING_RATE);
+        if (haveFullRate && (long)(sampleMs - lastFullRateMs) <= 0) continue;
+        append(SEGMENT_PRETRIGGER, SAMPLING_RATE, sampleMs, ring[(oldest + i) % PRETRIGGER_SAMPLES]);
+    }
+    closeSegment();
+
+    if (detailedLoggingEnabled) Serial.printf("Waveform archive: full rate (%d pre-trigger samples)\n", ringCount);
+}
+
+void WaveformRecorder::stopFullRate() {
+    fullRate = false;
+    rateSwitches++;
+    closeSegment();
+    if (detailedLoggingEnabled) Serial.printf("Waveform archive: back to %d Hz\n", ADAPTIVE_QUIET_RATE_HZ);
+}
+
+void WaveformRecorder::append(uint8_t mode, uint16_t rateHz, unsigned long timestampMs, const Triple& value) {
+    if (segmentCount > 0 && (mode != segmentMode || rateHz != segmentRate)) closeSegment();
+    if (segmentCount == 0) {
+        segmentMode = mode;
+        segmentRate = rateHz;
+        segmentStartMs = timestampMs;
+    }
+    segment[segmentCount++] = value;
+    if (segmentCount == WAVEFORM_SEGMENT_SAMPLES) closeSegment();
+}
+
+void WaveformRecorder::closeSegment() {
+    if (segmentCount == 0) return;
+    int count = segmentCount;
+    segmentCount = 0;
+
+    // Segments are filed by UTC; the sample clock is millis, so the start is
+    // carried back by the time the segment waited in RAM
+    uint64_t nowUtcMs;
+    if (!initialized || !TimeManager::getEpochTimeMs(nowUtcMs)) {
+        unanchoredSegments++;
+        return;
+    }
+    SegmentHeader header;
+    header.magic = SEGMENT_MAGIC;
+    header.startUtcMs = nowUtcMs - (millis() - segmentStartMs);
+    header.startMs = segmentStartMs;
+    header.rateHz = segmentRate;
+    header.count = count;
+    header.mode = segmentMode;
+    header.channels = 3;
+    header.version = FORMAT_VERSION;
+    header.fractionBits = FRACTION_BITS;
+
+    // Finest unit that holds the segment's peak
+    float peak = 0.0f;
+    for (int i = 0; i < count; i++) {
+        peak = max(peak, max(fabsf(segment[i].x), max(fabsf(segment[i].y), fabsf(segment[i].z))));
+    }
+    uint8_t shift = 0;
+    while (shift < 15 + FRACTION_BITS && peak * ARCHIVE_COUNTS_PER_G / (1 << shift) > 32767.0f) shift++;
+    header.scaleShift = shift;
+
+    float scale = ARCHIVE_COUNTS_PER_G / (1 << shift);
+    for (int i = 0; i < count; i++) {
+        encoded[3 * i] = (int16_t)constrain(lroundf(segment[i].x * scale), -32768L, 32767L);
+        encoded[3 * i + 1] = (int16_t)constrain(lroundf(segment[i].y * scale), -32768L, 32767L);
+        encoded[3 * i + 2] = (int16_t)constrain(lroundf(segment[i].z * scale), -32768L, 32767L);
+    }
+
+    uint32_t epochDay = (uint32_t)(header.startUtcMs / 86400000ULL);
+    if (writeSegment(epochDay, header)) {
+        segmentsWritten++;
+        samplesWritten += count;
+    } else {
+        writeErrors++;
+    }
+    retention.cleanup(epochDay, detailedLoggingEnabled);
+}
+
+bool WaveformRecorder::writeSegment(uint32_t epochDay, const SegmentHeader& header) {
+    File file = LittleFS.open(getArchivePath(epochDay), "a");
+    if (!file) return false;
+
+    size_t bytes = header.count * 3 * sizeof(int16_t);
+    bool ok = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              file.write((const uint8_t*)encoded, bytes) == bytes;
+    file.close();
+    return ok;
+}
+
+String WaveformRecorder::getArchivePath(uint32_t epochDay) {
+    return "/wave/" + String(epochDay) + ".bin";
+}
+
+String WaveformRecorder::getInfoJson() {
+    JsonDocument doc;
+    doc["mode"] = fullRate ? "full" : "quiet";
+    doc["rate_hz"] = getCurrentRateHz();
+    doc["full_rate_hz"] = SAMPLING_RATE;
+    doc["quiet_rate_hz"] = ADAPTIVE_QUIET_RATE_HZ;
+    doc["pretrigger_ms"] = ADAPTIVE_PRETRIGGER_MS;
+    doc["posttrigger_ms"] = ADAPTIVE_POSTTRIGGER_MS;
+    doc["max_event_ms"] = ADAPTIVE_MAX_EVENT_MS;
+    doc["segment_magic"] = SEGMENT_MAGIC;
+    doc["segment_header_bytes"] = sizeof(SegmentHeader);
+    doc["counts_per_g"] = ARCHIVE_COUNTS_PER_G;
+    doc["fraction_bits"] = FRACTION_BITS;
+    doc["segments_written"] = segmentsWritten;
+    doc["samples_written"] = samplesWritten;
+    doc["write_errors"] = writeErrors;
+    doc["unanchored_segments"] = unanchoredSegments;
+    doc["rate_switches"] = rateSwitches;
+    doc["events_captured"] = eventsCaptured;
+
+    JsonArray days = doc["days"].to<JsonArray>();
+    File dir = LittleFS.open("/wave");
+    if (dir && dir.isDirectory()) {
+        File file = dir.openNextFile();
+        while (file) {
+            String fileName = file.name();
+            fileName = fileName.substring(fileName.lastIndexOf('/') + 1);
+            days.add(TimeManager::formatEpochDay(fileName.substring(0, fileName.indexOf('.')).toInt()));
+            file = dir.openNextFile();
+        }
+    }
+
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
@@ -0,0 +1,121 @@
+#ifndef WAVEFORM_RECORDER_H
+#define WAVEFORM_RECORDER_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "config.h"
+#include "../utils/archive_retention.h"
+
+// Adaptive-rate waveform archive fed by the sensor task. Every calibrated sample
+// enters a full-rate pre-trigger ring; while no detector is active only the
+// mean over each 1/ADAPTIVE_QUIET_RATE_HZ interval is archived. When an event
+// triggers, the ring is written out at full rate and full rate is kept until
+// ADAPTIVE_POSTTRIGGER_MS after the event ended.
+//
+// File layout: /wave/<days since 1970>.bin (UTC day of the segment start) is
+// a sequence of segments, each a SegmentHeader followed by count samples of
+// { int16 x, y, z } (Z-up frame,
+// g = value * 2^scaleShift / (16384 * 2^fractionBits)), little-endian.
+// fractionBits keeps the resolution oversampling gains below the ±2 g LSB. A segment has one rate and no gaps, so sample i lies at
+// startUtcMs + i * 1000 / rateHz (quiet samples are the mean of the interval
+// starting there). Each rate change starts a new segment; the
+// pre-trigger segment repeats the last seconds of the preceding quiet
+// segment at full rate (readers prefer the higher rate where they overlap).
+class WaveformRecorder {
+public:
+    bool detailedLoggingEnabled;
+
+    enum SegmentMode : uint8_t {
+        SEGMENT_QUIET = 0,        // Interval means at ADAPTIVE_QUIET_RATE_HZ
+        SEGMENT_PRETRIGGER,       // Ring contents ahead of the trigger, full rate
+        SEGMENT_EVENT             // Live samples while the event lasts, full rate
+    };
+
+    static const uint32_t SEGMENT_MAGIC = 0x47455357;  // "WSEG"
+    static const uint8_t FORMAT_VERSION = 2;          // 2: fractionBits
+    static const uint8_t FRACTION_BITS = OVERSAMPLE_FACTOR > 1 ? WIDE_SAMPLE_FRACTION_BITS : 0;
+    static const int PRETRIGGER_SAMPLES = (int)((uint32_t)ADAPTIVE_PRETRIGGER_MS * SAMPLING_RATE / 1000);
+    static const int QUIET_DECIMATION = SAMPLING_RATE / ADAPTIVE_QUIET_RATE_HZ;
+
+    struct __attribute__((packed)) SegmentHeader {
+        uint32_t magic;
+        uint64_t startUtcMs;      // First sample, UTC
+        uint32_t startMs;         // First sample, boot clock (millis)
+        uint16_t rateHz;
+        uint16_t count;           // Samples following the header
+        uint8_t mode;             // SegmentMode
+        uint8_t scaleShift;
+        uint8_t channels;         // Always 3
+        uint8_t version;
+        uint8_t fractionBits;     // Bits below the ±2 g LSB at scaleShift 0
+    };
+
+private:
+    struct Triple {
+        float x;
+        float y;
+        float z;
+    };
+
+    bool initialized;
+
+    // Full-rate ring, always filled
+    Triple ring[PRETRIGGER_SAMPLES];
+    int ringHead;
+    int ringCount;
+    unsigned long ringNewestMs;
+
+    // Rate state
+    bool fullRate;
+    bool capped;                    // Hit ADAPTIVE_MAX_EVENT_MS, quiet until the event ends
+    unsigned long fullRateSinceMs;
+    unsigned long lastActiveMs;
+    unsigned long lastFullRateMs;   // Newest sample archived at full rate
+    bool haveFullRate;
+
+    // Quiet interval mean
+    float quietSum[3];
+    int quietCount;
+    unsigned long quietStartMs;
+
+    // Open segment, appended to flash when full or when the rate changes
+    Triple segment[WAVEFORM_SEGMENT_SAMPLES];
+    int segmentCount;
+    uint8_t segmentMode;
+    uint16_t segmentRate;
+    unsigned long segmentStartMs;
+    int16_t encoded[3 * WAVEFORM_SEGMENT_SAMPLES];
+
+    unsigned long segmentsWritten;
+    unsigned long samplesWritten;
+    unsigned long writeErrors;
+    unsigned long unanchoredSegments;   // Closed before UTC was valid, not stored
+    unsigned long rateSwitches;
+    unsigned long eventsCaptured;
+    ArchiveRetention retention;
+
+    void startFullRate(unsigned long timestampMs);
+    void stopFullRate();
+    void append(uint8_t mode, uint16_t rateHz, unsigned long timestampMs, const Triple& value);
+    void closeSegment();
+    bool writeSegment(uint32_t epochDay, const SegmentHeader& header);
+
+public:
+    WaveformRecorder();
+    bool begin();
+
+    // Sensor task: feed one calibrated sample (g); eventActive while a detector is
+    // active for this sample
+    void addSample(float accelX, float accelY, float accelZ, unsigned long timestampMs, bool eventActive);
+
+    // Any core
+    String getInfoJson();
+    String getArchivePath(uint32_t epochDay);
+
+    bool isFullRate() { return fullRate; }
+    int getCurrentRateHz() { return fullRate ? SAMPLING_RATE : ADAPTIVE_QUIET_RATE_HZ; }
+    unsigned long getSegmentsWritten() { return segmentsWritten; }
+    unsigned long getWriteErrors() { return writeErrors; }
+};
+
+#endif // WAVEFORM_RECORDER_H
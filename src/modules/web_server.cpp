@@ -3,6 +3,13 @@
 #include "data_logger.h"
 #include "mqtt_handler.h"
 #include "time_manager.h"
+#include "amplitude_monitor.h"
+#include "helicorder_recorder.h"
+#include "waveform_recorder.h"
+#include "power_manager.h"
+#include "dual_core_manager.h"
+#include "latency_tracer.h"
+#include "topology_benchmark.h"
 
 WebServerManager::WebServerManager() : server(WEB_SERVER_PORT), ws("/ws") {
     initialized = false;
@@ -10,11 +17,18 @@ WebServerManager::WebServerManager() : server(WEB_SERVER_PORT), ws("/ws") {
     dataLoggerRef = nullptr;
     mqttHandlerRef = nullptr;
     timeManagerRef = nullptr;
+    amplitudeMonitorRef = nullptr;
+    helicorderRef = nullptr;
+    waveformRef = nullptr;
+    latencyTracerRef = nullptr;
+    topologyBenchmarkRef = nullptr;
+    powerManagerRef = nullptr;
     
     // Initialize WebSocket variables
     lastSensorBroadcast = 0;
     lastStatusBroadcast = 0;
     realtimeStreamingEnabled = true;
+    fullRateStreaming = true;
 }
 
 bool WebServerManager::begin() {
@@ -48,6 +62,30 @@ void WebServerManager::setReferences(Seismograph* seismo, DataLogger* logger, MQ
     timeManagerRef = time;
 }
 
+void WebServerManager::setAmplitudeMonitorReference(AmplitudeMonitor* monitor) {
+    amplitudeMonitorRef = monitor;
+}
+
+void WebServerManager::setHelicorderReference(HelicorderRecorder* helicorder) {
+    helicorderRef = helicorder;
+}
+
+void WebServerManager::setWaveformReference(WaveformRecorder* waveform) {
+    waveformRef = waveform;
+}
+
+void WebServerManager::setPowerManagerReference(PowerManager* power) {
+    powerManagerRef = power;
+}
+
+void WebServerManager::setLatencyTracerReference(LatencyTracer* tracer) {
+    latencyTracerRef = tracer;
+}
+
+void WebServerManager::setTopologyBenchmarkReference(TopologyBenchmark* benchmark) {
+    topologyBenchmarkRef = benchmark;
+}
+
 void WebServerManager::addHttpEndpoint(const char* uri, WebRequestMethodComposite method, std::function<void(AsyncWebServerRequest *request)> onRequest) {
     server.on(uri, method, onRequest);
 }
@@ -85,6 +123,51 @@ void WebServerManager::setupRoutes() {
         handleSimulate(request);
     });
     
+#if GYRO_CHANNELS_ENABLED
+    server.on("/api/gyro", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        handleGyro(request);
+    });
+#endif
+    
+    server.on("/api/rsam", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        handleRsam(request);
+    });
+    
+    server.on("/api/helicorder", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        handleHelicorder(request);
+    });
+    
+#if ADAPTIVE_RATE_ENABLED
+    server.on("/api/waveform", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        handleWaveform(request);
+    });
+#endif
+    
+    server.on("/api/perf", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        handlePerf(request);
+    });
+    
+    server.on("/api/perf/reset", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        if (latencyTracerRef == nullptr) {
+            request->send(503, "text/plain", "Latency tracer not available");
+            return;
+        }
+        latencyTracerRef->reset();
+        request->send(200, "text/plain", "Latency statistics reset");
+    });
+    
+    server.on("/api/benchmark/topology", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        if (topologyBenchmarkRef == nullptr) {
+            request->send(503, "application/json", "{\"error\":\"Topology benchmark not available\"}");
+            return;
+        }
+        request->send(200, "application/json", topologyBenchmarkRef->getResultsJson());
+    });
+    
+    server.on("/api/benchmark/topology", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        handleTopologyBenchmark(request);
+    });
+    
     // Serve static files from LittleFS (AFTER API endpoints)
     server.serveStatic("/", LittleFS, "/").setDefaultFile("index.html");
     
@@ -113,12 +196,185 @@ void WebServerManager::handleStatus(AsyncWebServerRequest *request) {
     doc["wifi_rssi"] = WiFi.RSSI();
     doc["ip_address"] = WiFi.localIP().toString();
     doc["mqtt_connected"] = (mqttHandlerRef != nullptr) ? mqttHandlerRef->isConnected() : false;
+    if (waveformRef != nullptr) {
+        doc["archive_rate_hz"] = waveformRef->getCurrentRateHz();
+    }
+    
+    // Low-power mode: duty cycle, wake-ups and the FIFO batches behind them
+    if (powerManagerRef != nullptr) {
+        JsonObject power = doc["power"].to<JsonObject>();
+        powerManagerRef->toJson(power);
+        if (seismographRef != nullptr) {
+            power["fifo_overflows"] = seismographRef->getFifoOverflows();
+            power["fifo_resyncs"] = seismographRef->getFifoResyncs();
+        }
+        if (globalCoreManager != nullptr) {
+            power["sample_clock_gaps"] = globalCoreManager->getSampleClockGaps();
+        }
+    }
     
     // Add seismograph status if available
     if (seismographRef != nullptr) {
         doc["sensor_calibrated"] = seismographRef->isCalibrated();
         doc["events_detected"] = seismographRef->getEventsDetected();
         doc["last_magnitude"] = seismographRef->getLastMagnitude();
+        doc["mounting_tilt_deg"] = seismographRef->getMountingTiltDegrees();
+        doc["gyro_enabled"] = seismographRef->isGyroEnabled();
+        
+        // Sensor array: per-sensor state and the consistency check
+        JsonObject array = doc["sensor_array"].to<JsonObject>();
+        array["disagreements"] = seismographRef->getArrayDisagreements();
+        array["max_read_skew_us"] = seismographRef->getMaxReadSkewUs();
+        JsonArray sensorList = array["sensors"].to<JsonArray>();
+        for (int s = 0; s < SENSOR_COUNT; s++) {
+            const ArraySensor& sensor = seismographRef->getSensor(s);
+            JsonObject entry = sensorList.add<JsonObject>();
+            entry["address"] = sensor.address;
+            entry["present"] = sensor.present;
+            entry["calibrated"] = sensor.calibrated;
+            entry["tilt_deg"] = sensor.mountingTiltDeg;
+            entry["gravity_g"] = sensor.gravityMagnitude;
+            entry["temperature_c"] = sensor.tempCompensator.getLastTemp();
+            entry["range_g"] = 2 << sensor.rangeShift;
+            entry["clipped_blocks"] = sensor.clippedBlocks;
+            entry["range_switches"] = sensor.rangeSwitches;
+            entry["read_errors"] = sensor.readErrors;
+            entry["outvoted"] = sensor.outvoted;
+        }
+        
+        // Temperature compensation model and its residuals
+        const TemperatureCompensator& tc = seismographRef->getTemperatureCompensator();
+        JsonObject tempComp = doc["temperature_compensation"].to<JsonObject>();
+        tempComp["active"] = tc.isReady();
+        tempComp["temperature_c"] = tc.getLastTemp();
+        tempComp["reference_c"] = tc.getReferenceTemp();
+        tempComp["span_c"] = tc.getTempSpan();
+        tempComp["observations"] = tc.getObservationCount();
+        JsonArray slopes = tempComp["slope_g_per_c"].to<JsonArray>();
+        JsonArray intercepts = tempComp["intercept_g"].to<JsonArray>();
+        JsonArray residuals = tempComp["residual_rms_g"].to<JsonArray>();
+        for (int axis = 0; axis < 3; axis++) {
+            slopes.add(tc.getSlope(axis));
+            intercepts.add(tc.getIntercept(axis));
+            residuals.add(tc.getResidualRms(axis));
+        }
+        
+        // Sensor bus transactions (IDF I2C master)
+        I2cSensorBus& bus = seismographRef->getSensorBus();
+        I2cBusStats busStats;
+        bus.getStats(busStats);
+        JsonObject i2c = doc["i2c"].to<JsonObject>();
+        i2c["driver"] = bus.isActive() ? "idf" : "wire";
+        i2c["frequency_hz"] = bus.getFrequency();
+        i2c["transactions"] = busStats.transactions;
+        i2c["errors"] = busStats.errors;
+        i2c["timeouts"] = busStats.timeouts;
+        i2c["other_errors"] = busStats.otherErrors;
+        i2c["foreign_calls"] = busStats.foreignCalls;
+        if (busStats.lastError != ESP_OK) {
+            i2c["last_error"] = esp_err_to_name(busStats.lastError);
+            i2c["last_error_ms"] = busStats.lastErrorMs;
+        }
+        i2c["max_transaction_us"] = busStats.maxTransactionUs;
+        i2c["mean_transaction_us"] = busStats.transactions > 0 ? (float)busStats.sumTransactionUs / busStats.transactions : 0.0f;
+        
+        // Goertzel band energies of the last completed window
+        BandEnergyMonitor& monitor = seismographRef->getBandEnergyMonitor();
+        BandEnergySnapshot bands;
+        monitor.getSnapshot(bands);
+        JsonObject bandEnergy = doc["band_energy"].to<JsonObject>();
+        bandEnergy["windows"] = bands.windows;
+        bandEnergy["triggered"] = bands.triggered;
+        bandEnergy["vetoed"] = bands.vetoed;
+        bandEnergy["band_triggers"] = seismographRef->getBandTriggerCount();
+        bandEnergy["vetoed_triggers"] = seismographRef->getVetoedTriggerCount();
+        JsonArray bandList = bandEnergy["bands"].to<JsonArray>();
+        for (int band = 0; band < monitor.getBandCount(); band++) {
+            JsonObject bandJson = bandList.add<JsonObject>();
+            bandJson["name"] = monitor.getBandName(band);
+            bandJson["role"] = BandEnergyMonitor::roleName(monitor.getBandRole(band));
+            bandJson["low_hz"] = monitor.getBandLowHz(band);
+            bandJson["high_hz"] = monitor.getBandHighHz(band);
+            bandJson["rms_g"] = bands.rms[band];
+            bandJson["background_g"] = bands.background[band];
+        }
+        
+        // Network coincidence with peer stations
+        CoincidenceTrigger& coincidence = seismographRef->getCoincidenceTrigger();
+        JsonObject coincidenceJson = doc["coincidence"].to<JsonObject>();
+        coincidenceJson["enabled"] = COINCIDENCE_ENABLED;
+        coincidenceJson["station_id"] = coincidence.getStationId();
+        coincidenceJson["required_stations"] = coincidence.getRequiredStations();
+        coincidenceJson["window_ms"] = coincidence.getWindowMs();
+        coincidenceJson["known_peers"] = coincidence.getKnownPeers();
+        coincidenceJson["triggered_peers"] = coincidence.getActivePeers(millis());
+        coincidenceJson["confirmed_events"] = coincidence.getConfirmedEvents();
+        coincidenceJson["unconfirmed_events"] = coincidence.getUnconfirmedEvents();
+        coincidenceJson["messages_sent"] = coincidence.getMessagesSent();
+        coincidenceJson["messages_received"] = coincidence.getMessagesReceived();
+        coincidenceJson["messages_rejected"] = coincidence.getMessagesRejected();
+        coincidenceJson["id_collisions"] = coincidence.getIdCollisions();
+        
+        // Synthetic waveform injection
+        SyntheticEventInjector& injector = seismographRef->getInjector();
+        JsonObject injection = doc["injection"].to<JsonObject>();
+        injection["active"] = injector.isActive();
+        injection["remaining_ms"] = injector.getRemainingMs();
+        injection["started"] = injector.getInjectionsStarted();
+        injection["completed"] = injector.getInjectionsCompleted();
+        injection["cancelled"] = injector.getInjectionsCancelled();
+        
+        // Preliminary tau_c / Pd magnitude of the latest event
+        EarlyMagnitudeEstimate early;
+        seismographRef->getEarlyMagnitude().getSnapshot(early);
+        JsonObject earlyJson = doc["early_magnitude"].to<JsonObject>();
+        earlyJson["trace_id"] = early.traceId;
+        earlyJson["valid"] = early.valid;
+        earlyJson["complete"] = early.complete;
+        earlyJson["p_window_ms"] = early.windowMs;
+        earlyJson["onset_lead_ms"] = early.onsetLeadMs;
+        earlyJson["estimates"] = seismographRef->getEarlyMagnitude().getEstimatesCompleted();
+        if (early.valid) {
+            earlyJson["tau_c"] = early.tauC;
+            earlyJson["pd_cm"] = early.pdCm;
+            earlyJson["magnitude_tau_c"] = early.magnitudeTauC;
+            earlyJson["magnitude_pd"] = early.magnitudePd;
+            earlyJson["magnitude"] = early.magnitude;
+        }
+    }
+    
+    // Sensor task timing: sample continuity overall and while events are active
+    if (globalCoreManager != nullptr) {
+        JsonObject timing = doc["sensor_timing"].to<JsonObject>();
+        const TaskTopology& topology = globalCoreManager->getTopology();
+        timing["topology"] = topology.name;
+        timing["sensor_core"] = topology.sensorCore;
+        timing["sensor_priority"] = topology.sensorPriority;
+        timing["mean_jitter_us"] = globalCoreManager->getMeanSensorJitterUs();
+        timing["min_period_us"] = globalCoreManager->getMinSensorPeriodUs();
+        timing["acquisition_rate_hz"] = ACQUISITION_RATE;
+        timing["output_rate_hz"] = SAMPLING_RATE;
+        timing["sample_format"] = SampleFormat::name();
+        timing["load_pct"] = globalCoreManager->getSensorLoadPercent();
+        timing["clock"] = globalCoreManager->isTimerClock() ? "timer" : "tick";
+        if (globalCoreManager->isTimerClock()) {
+            timing["max_wake_latency_us"] = globalCoreManager->getMaxWakeLatencyUs();
+            timing["missed_ticks"] = globalCoreManager->getMissedSampleTicks();
+            timing["timer_stalls"] = globalCoreManager->getSampleTimerStalls();
+        }
+        timing["max_period_us"] = globalCoreManager->getMaxSensorPeriodUs();
+        timing["max_processing_us"] = globalCoreManager->getMaxSensorProcessingUs();
+        timing["late_iterations"] = globalCoreManager->getLateSensorIterations();
+        timing["queue_drops"] = globalCoreManager->getSensorQueueDrops();
+        JsonObject during = timing["during_events"].to<JsonObject>();
+        during["iterations"] = globalCoreManager->getEventIterations();
+        during["max_period_us"] = globalCoreManager->getMaxEventPeriodUs();
+        during["max_processing_us"] = globalCoreManager->getMaxEventProcessingUs();
+        during["late_iterations"] = globalCoreManager->getLateEventIterations();
+        during["event_queue_drops"] = globalCoreManager->getEventQueueDrops();
+        JsonObject alerts = doc["alerts"].to<JsonObject>();
+        alerts["published"] = globalCoreManager->getAlertsPublished();
+        alerts["queue_drops"] = globalCoreManager->getAlertQueueDrops();
     }
     
     // Add time information if available
@@ -145,11 +401,13 @@ void WebServerManager::handleData(AsyncWebServerRequest *request) {
     doc["timestamp"] = millis();
     
     if (seismographRef != nullptr) {
-        SensorData data = seismographRef->readSensor();
-        doc["accel_x"] = data.accelX;
-        doc["accel_y"] = data.accelY;
-        doc["accel_z"] = data.accelZ;
-        doc["magnitude"] = data.magnitude;
+        // Last sample of the sensor task; reading the bus here would race it
+        SensorData data;
+        seismographRef->getSampleSnapshot(data);
+        doc["accel_x"] = data.accelXG();
+        doc["accel_y"] = data.accelYG();
+        doc["accel_z"] = data.accelZG();
+        doc["magnitude"] = data.magnitudeG();
         doc["sensor_timestamp"] = data.timestamp;
         doc["calibrated"] = seismographRef->isCalibrated();
         doc["events_detected"] = seismographRef->getEventsDetected();
@@ -217,6 +475,150 @@ void WebServerManager::handleSeismicEvents(AsyncWebServerRequest *request) {
 }
 
 
+void WebServerManager::handleRsam(AsyncWebServerRequest *request) {
+    if (amplitudeMonitorRef == nullptr) {
+        request->send(503, "application/json", "{\"error\":\"Amplitude monitor not available\"}");
+        return;
+    }
+    
+    // Without a date: recent intervals from RAM
+    if (!request->hasParam("date")) {
+        int minutes = RSAM_HISTORY_SIZE;
+        if (request->hasParam("minutes")) {
+            minutes = request->getParam("minutes")->value().toInt();
+        }
+        request->send(200, "application/json", amplitudeMonitorRef->getHistoryJson(minutes));
+        return;
+    }
+    
+    uint32_t epochDay;
+    if (!TimeManager::parseDateToEpochDay(request->getParam("date")->value(), epochDay)) {
+        request->send(400, "application/json", "{\"error\":\"Invalid date, expected YYYY-MM-DD\"}");
+        return;
+    }
+    
+    String path = amplitudeMonitorRef->getArchivePath(epochDay);
+    if (!LittleFS.exists(path)) {
+        request->send(404, "application/json", "{\"error\":\"No RSAM data for this date\"}");
+        return;
+    }
+    
+    // Raw archive: 14-byte records of minute_of_day, rsam, ssam[5] (uint16 LE)
+    if (request->hasParam("format") && request->getParam("format")->value() == "bin") {
+        request->send(LittleFS, path, "application/octet-stream");
+        return;
+    }
+    
+    int step = 5;
+    if (request->hasParam("step")) {
+        step = request->getParam("step")->value().toInt();
+    }
+    request->send(200, "application/json", amplitudeMonitorRef->getDayJson(epochDay, step));
+}
+
+void WebServerManager::handleHelicorder(AsyncWebServerRequest *request) {
+    if (helicorderRef == nullptr) {
+        request->send(503, "application/json", "{\"error\":\"Helicorder not available\"}");
+        return;
+    }
+    
+    // Without a date: layout and available days, so the client can decode the files
+    if (!request->hasParam("date")) {
+        request->send(200, "application/json", helicorderRef->getInfoJson());
+        return;
+    }
+    
+    uint32_t epochDay;
+    if (!TimeManager::parseDateToEpochDay(request->getParam("date")->value(), epochDay)) {
+        request->send(400, "application/json", "{\"error\":\"Invalid date, expected YYYY-MM-DD\"}");
+        return;
+    }
+    
+    String path = helicorderRef->getArchivePath(epochDay);
+    if (!LittleFS.exists(path)) {
+        request->send(404, "application/json", "{\"error\":\"No helicorder data for this date\"}");
+        return;
+    }
+    
+    // Precomputed day file, sent as-is (int16 min/max pairs per column)
+    request->send(LittleFS, path, "application/octet-stream");
+}
+
+void WebServerManager::handleWaveform(AsyncWebServerRequest *request) {
+    if (waveformRef == nullptr) {
+        request->send(503, "application/json", "{\"error\":\"Waveform archive not available\"}");
+        return;
+    }
+    
+    // Without a date: current rate, segment layout and available days
+    if (!request->hasParam("date")) {
+        request->send(200, "application/json", waveformRef->getInfoJson());
+        return;
+    }
+    
+    uint32_t epochDay;
+    if (!TimeManager::parseDateToEpochDay(request->getParam("date")->value(), epochDay)) {
+        request->send(400, "application/json", "{\"error\":\"Invalid date, expected YYYY-MM-DD\"}");
+        return;
+    }
+    
+    String path = waveformRef->getArchivePath(epochDay);
+    if (!LittleFS.exists(path)) {
+        request->send(404, "application/json", "{\"error\":\"No waveform data for this date\"}");
+        return;
+    }
+    
+    // Segment file sent as-is (header + int16 triples per segment)
+    request->send(LittleFS, path, "application/octet-stream");
+}
+
+void WebServerManager::handlePerf(AsyncWebServerRequest *request) {
+    if (latencyTracerRef == nullptr) {
+        request->send(503, "application/json", "{\"error\":\"Latency tracer not available\"}");
+        return;
+    }
+    request->send(200, "application/json", latencyTracerRef->getPerfJson());
+}
+
+void WebServerManager::handleTopologyBenchmark(AsyncWebServerRequest *request) {
+    if (topologyBenchmarkRef == nullptr) {
+        request->send(503, "application/json", "{\"error\":\"Topology benchmark not available\"}");
+        return;
+    }
+    
+    unsigned long measureMs = BENCH_DEFAULT_MEASURE_MS;
+    if (request->hasParam("measure_ms")) {
+        measureMs = request->getParam("measure_ms")->value().toInt();
+    }
+    bool load = !(request->hasParam("load") && request->getParam("load")->value() == "0");
+    
+    if (!topologyBenchmarkRef->start(measureMs, load)) {
+        request->send(409, "application/json", "{\"error\":\"Benchmark already running\"}");
+        return;
+    }
+    request->send(202, "application/json", "{\"status\":\"started\"}");
+}
+
+void WebServerManager::handleGyro(AsyncWebServerRequest *request) {
+    if (seismographRef == nullptr) {
+        request->send(503, "application/json", "{\"error\":\"Seismograph not available\"}");
+        return;
+    }
+    if (!request->hasParam("enabled")) {
+        request->send(400, "application/json", "{\"error\":\"Missing parameter: enabled\"}");
+        return;
+    }
+    
+    String value = request->getParam("enabled")->value();
+    seismographRef->setGyroEnabled(value == "1" || value == "true" || value == "on");
+    
+    JsonDocument doc;
+    doc["gyro_enabled"] = seismographRef->isGyroEnabled();
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+}
+
 void WebServerManager::handleSimulate(AsyncWebServerRequest *request) {
     if (seismographRef == nullptr) {
         request->send(500, "text/plain", "Seismograph not available");
@@ -237,32 +639,48 @@ void WebServerManager::handleSimulate(AsyncWebServerRequest *request) {
         targetRichter = seismographRef->calculateRichterMagnitude(directMagnitude);
     }
     
-    // Calculate magnitude from Richter scale using scientific formula
-    float magnitude = pow(10, (targetRichter + 2.0) / 3.0);
-    
     // Determine event type from Richter scale
     String type = seismographRef->getEventTypeFromRichter(targetRichter);
     
-    // Simulate realistic event duration based on magnitude
-    unsigned long simulatedDuration = 500 + (magnitude * 15000);
-    simulatedDuration = constrain(simulatedDuration, 500, 3000);
-    
-    // Create scientific description
-    String scientificDescription = seismographRef->getScientificEventDescription(magnitude, simulatedDuration);
+    // Superimpose a synthetic waveform on the live samples in the sensor
+    // task, so the event goes through filters, STA/LTA and all consumers
+    // like a real one
+    SyntheticWaveform waveform;
+    waveform.pgaG = seismographRef->calculatePGAFromRichter(targetRichter);
+    waveform.durationMs = seismographRef->calculateEventDuration(targetRichter);
+    waveform.frequencyHz = SYNTHETIC_DEFAULT_FREQ_HZ;
+    String shapeName = request->hasParam("shape") ? request->getParam("shape")->value() : String(SYNTHETIC_DEFAULT_SHAPE);
+    if (!SyntheticEventInjector::parseShape(shapeName, waveform.shape)) {
+        request->send(400, "text/plain", "Unknown shape (sine, ricker, chirp, quake)");
+        return;
+    }
+    if (request->hasParam("duration_ms")) {
+        waveform.durationMs = request->getParam("duration_ms")->value().toInt();
+    }
+    if (request->hasParam("frequency")) {
+        waveform.frequencyHz = request->getParam("frequency")->value().toFloat();
+    }
+    waveform.durationMs = constrain(waveform.durationMs, (unsigned long)SYNTHETIC_MIN_DURATION_MS,
+                                    (unsigned long)SYNTHETIC_MAX_DURATION_MS);
     
-    // Simulate the event in seismograph
-    Serial.printf("Simulating %s seismic event via web interface (%.4f g, Richter %.2f)\n", 
-                  type.c_str(), magnitude, targetRichter);
-    seismographRef->simulateEvent(magnitude);
+    SyntheticEventInjector& injector = seismographRef->getInjector();
+    if (!injector.arm(waveform)) {
+        request->send(409, "text/plain", "Injection already running (" + String(injector.getRemainingMs()) + " ms left)");
+        return;
+    }
     
-    // Log the simulation with scientific data
+    Serial.printf("Injecting %s waveform via web interface (%s, PGA %.4f g, %lu ms, %.1f Hz)\n",
+                  type.c_str(), SyntheticEventInjector::shapeName(waveform.shape), waveform.pgaG,
+                  waveform.durationMs, waveform.frequencyHz);
     if (dataLoggerRef != nullptr) {
-        String description = "Web simulation: " + type + " event | " + scientificDescription;
-        dataLoggerRef->logEvent(type, description, magnitude);
+        String description = "Web injection: " + type + " " + SyntheticEventInjector::shapeName(waveform.shape) +
+                             " waveform, Richter " + String(targetRichter, 2);
+        dataLoggerRef->logEvent("INJECTION", description, waveform.pgaG);
     }
     
-    String response = "Simulated " + type + " seismic event (Richter " + String(targetRichter, 2) + 
-                     ", " + String(magnitude, 4) + "g)";
+    String response = "Injecting " + type + " " + SyntheticEventInjector::shapeName(waveform.shape) +
+                      " waveform (Richter " + String(targetRichter, 2) + ", " + String(waveform.pgaG, 4) + "g, " +
+                      String(waveform.durationMs) + " ms)";
     request->send(200, "text/plain", response);
 }
 
@@ -369,6 +787,12 @@ void WebServerManager::broadcastSensorData() {
     doc["max_magnitude"] = maxMag; // Peak value in buffer
     doc["sensor_timestamp"] = sensorBuffer.lastUpdate;
     doc["samples_averaged"] = sensorBuffer.sampleCount;
+    float avgRate[3];
+    if (sensorBuffer.getAveragedRates(avgRate)) {
+        doc["gyro_x"] = avgRate[0];
+        doc["gyro_y"] = avgRate[1];
+        doc["gyro_z"] = avgRate[2];
+    }
     
     if (seismographRef != nullptr) {
         doc["calibrated"] = seismographRef->isCalibrated();
@@ -444,14 +868,26 @@ void WebServerManager::broadcastEvent(const String& eventType, const String& dat
     ws.textAll(jsonString);
 }
 
-void WebServerManager::updateSensorData(float accelX, float accelY, float accelZ, float magnitude) {
+void WebServerManager::updateSensorData(float accelX, float accelY, float accelZ, float magnitude, const float* rates) {
     // Add sample to buffer instead of immediate broadcasting
-    sensorBuffer.addSample(accelX, accelY, accelZ, magnitude, millis());
+    sensorBuffer.addSample(accelX, accelY, accelZ, magnitude, millis(), rates);
     
     // Use managed broadcast system instead of immediate broadcasting
     managedBroadcast();
 }
 
+bool WebServerManager::broadcastAlert(const String& alertJson) {
+    // Already a complete message; sent as-is so clients see it without unwrapping
+    return broadcastRaw(alertJson);
+}
+
+bool WebServerManager::broadcastRaw(const String& message) {
+    if (ws.count() == 0) return false;
+    
+    ws.textAll(message);
+    return true;
+}
+
 void WebServerManager::sendSeismicEvent(const String& eventType, float magnitude, int level) {
     if (ws.count() == 0) return;
     
@@ -502,6 +938,9 @@ void WebServerManager::managedBroadcast() {
     int broadcastInterval = 100; // Base 10 Hz
     if (ws.count() > 3) broadcastInterval = 150; // 6.7 Hz for many clients
     if (ESP.getFreeHeap() < 50000) broadcastInterval = 200; // 5 Hz when low memory
+#if ADAPTIVE_RATE_ENABLED
+    if (!fullRateStreaming) broadcastInterval = ADAPTIVE_QUIET_STREAM_MS; // No detector active
+#endif
     
     if (now - lastManagedBroadcast >= broadcastInterval) {
         broadcastSensorData();
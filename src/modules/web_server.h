@@ -14,6 +14,12 @@ class Seismograph;
 class DataLogger;
 class MQTTHandler;
 class TimeManager;
+class AmplitudeMonitor;
+class HelicorderRecorder;
+class WaveformRecorder;
+class LatencyTracer;
+class TopologyBenchmark;
+class PowerManager;
 
 class WebServerManager {
 private:
@@ -26,11 +32,18 @@ private:
     DataLogger* dataLoggerRef;
     MQTTHandler* mqttHandlerRef;
     TimeManager* timeManagerRef;
+    AmplitudeMonitor* amplitudeMonitorRef;
+    HelicorderRecorder* helicorderRef;
+    WaveformRecorder* waveformRef;
+    LatencyTracer* latencyTracerRef;
+    TopologyBenchmark* topologyBenchmarkRef;
+    PowerManager* powerManagerRef;
     
     // WebSocket data streaming
     unsigned long lastSensorBroadcast;
     unsigned long lastStatusBroadcast;
     bool realtimeStreamingEnabled;
+    volatile bool fullRateStreaming;   // Adaptive rate: false slows updates to ADAPTIVE_QUIET_STREAM_MS
     
     // Advanced buffering system
     struct SensorDataBuffer {
@@ -39,6 +52,8 @@ private:
         float accelY[BUFFER_SIZE];
         float accelZ[BUFFER_SIZE];
         float magnitude[BUFFER_SIZE];
+        float rate[BUFFER_SIZE][3];
+        bool hasRate[BUFFER_SIZE];
         unsigned long timestamps[BUFFER_SIZE];
         int writeIndex;
         int sampleCount;
@@ -46,11 +61,13 @@ private:
         
         SensorDataBuffer() : writeIndex(0), sampleCount(0), lastUpdate(0) {}
         
-        void addSample(float x, float y, float z, float mag, unsigned long ts) {
+        void addSample(float x, float y, float z, float mag, unsigned long ts, const float* rates = nullptr) {
             accelX[writeIndex] = x;
             accelY[writeIndex] = y;
             accelZ[writeIndex] = z;
             magnitude[writeIndex] = mag;
+            hasRate[writeIndex] = rates != nullptr;
+            for (int axis = 0; axis < 3; axis++) rate[writeIndex][axis] = rates != nullptr ? rates[axis] : 0.0f;
             timestamps[writeIndex] = ts;
             
             writeIndex = (writeIndex + 1) % BUFFER_SIZE;
@@ -78,6 +95,21 @@ private:
             
             return true;
         }
+        
+        // Mean angular rate over the buffered samples that carried one
+        bool getAveragedRates(float* avgRate) {
+            int count = 0;
+            avgRate[0] = avgRate[1] = avgRate[2] = 0.0f;
+            for (int i = 0; i < sampleCount; i++) {
+                if (!hasRate[i]) continue;
+                for (int axis = 0; axis < 3; axis++) avgRate[axis] += rate[i][axis];
+                count++;
+            }
+            if (count == 0) return false;
+            
+            for (int axis = 0; axis < 3; axis++) avgRate[axis] /= count;
+            return true;
+        }
     } sensorBuffer;
     
     // Client-specific streaming control
@@ -114,6 +146,12 @@ private:
     void handleCalibrate(AsyncWebServerRequest *request);
     void handleRestart(AsyncWebServerRequest *request);
     void handleSimulate(AsyncWebServerRequest *request);
+    void handleGyro(AsyncWebServerRequest *request);
+    void handleRsam(AsyncWebServerRequest *request);
+    void handleHelicorder(AsyncWebServerRequest *request);
+    void handleWaveform(AsyncWebServerRequest *request);
+    void handlePerf(AsyncWebServerRequest *request);
+    void handleTopologyBenchmark(AsyncWebServerRequest *request);
     void handleScientificStats(AsyncWebServerRequest *request);
     void handleNotFound(AsyncWebServerRequest *request);
     
@@ -144,6 +182,12 @@ public:
     
     // Set module references
     void setReferences(Seismograph* seismo, DataLogger* logger, MQTTHandler* mqtt, TimeManager* time);
+    void setAmplitudeMonitorReference(AmplitudeMonitor* monitor);
+    void setHelicorderReference(HelicorderRecorder* helicorder);
+    void setWaveformReference(WaveformRecorder* waveform);
+    void setLatencyTracerReference(LatencyTracer* tracer);
+    void setTopologyBenchmarkReference(TopologyBenchmark* benchmark);
+    void setPowerManagerReference(PowerManager* power);
     
     // Utility methods
     bool isRunning() { return initialized; }
@@ -153,10 +197,13 @@ public:
     void send(AsyncWebServerRequest *request, int code, const char* contentType, const String& content);
     
     // WebSocket public methods
-    void updateSensorData(float accelX, float accelY, float accelZ, float magnitude);
+    void updateSensorData(float accelX, float accelY, float accelZ, float magnitude, const float* rates = nullptr);
     void sendSeismicEvent(const String& eventType, float magnitude, int level);
+    bool broadcastAlert(const String& alertJson);
+    bool broadcastRaw(const String& message);
     void setRealtimeStreaming(bool enabled) { realtimeStreamingEnabled = enabled; }
     bool isRealtimeStreamingEnabled() { return realtimeStreamingEnabled; }
+    void setFullRateStreaming(bool enabled) { fullRateStreaming = enabled; }
     int getConnectedClients() { return ws.count(); }
 };
 
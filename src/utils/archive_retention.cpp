@@ -0,0 +1,34 @@
+#include "archive_retention.h"
+
+ArchiveRetention::ArchiveRetention(const char* directory, uint32_t retentionDays) {
+    this->directory = directory;
+    this->retentionDays = retentionDays;
+    lastCleanupDay = 0;
+}
+
+int ArchiveRetention::cleanup(uint32_t today, bool verbose) {
+    // Once per day is enough for a daily file layout
+    if (today == lastCleanupDay) return 0;
+    lastCleanupDay = today;
+    if (today < retentionDays) return 0;
+    uint32_t cutoffDay = today - retentionDays;
+
+    File dir = LittleFS.open(directory);
+    if (!dir || !dir.isDirectory()) return 0;
+
+    int removed = 0;
+    File file = dir.openNextFile();
+    while (file) {
+        // Older cores report the full path, newer ones the bare name
+        String fileName = file.name();
+        fileName = fileName.substring(fileName.lastIndexOf('/') + 1);
+        uint32_t fileDay = fileName.substring(0, fileName.indexOf('.')).toInt();
+        file = dir.openNextFile();
+        if (fileDay < cutoffDay) {
+            String fullPath = String(directory) + "/" + fileName;
+            if (LittleFS.remove(fullPath)) removed++;
+            if (verbose) Serial.printf("Deleted old archive file: %s\n", fullPath.c_str());
+        }
+    }
+    return removed;
+}
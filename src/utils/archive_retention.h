@@ -0,0 +1,23 @@
+#ifndef ARCHIVE_RETENTION_H
+#define ARCHIVE_RETENTION_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+// Retention for the daily LittleFS archives (/rsam, /heli, /wave): every
+// file is named <epoch day>.<ext>, and files older than the retention
+// period are deleted. The directory is scanned at most once per day.
+class ArchiveRetention {
+private:
+    const char* directory;
+    uint32_t retentionDays;
+    uint32_t lastCleanupDay;
+
+public:
+    ArchiveRetention(const char* directory, uint32_t retentionDays);
+
+    // Deletes the expired files of the archive; returns how many
+    int cleanup(uint32_t today, bool verbose);
+};
+
+#endif // ARCHIVE_RETENTION_H
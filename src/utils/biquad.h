@@ -0,0 +1,153 @@
+#ifndef BIQUAD_H
+#define BIQUAD_H
+
+#include <Arduino.h>
+#include "sample_format.h"
+
+// Second-order section coefficients (a0 normalised to 1), designed in float
+// once at start-up. Formulas follow the RBJ audio EQ cookbook.
+struct BiquadCoefficients {
+    float b0, b1, b2, a1, a2;
+    
+    static BiquadCoefficients lowPass(float sampleRate, float cutoffHz, float q = 0.70710678f) {
+        float w0 = 2.0f * PI * cutoffHz / sampleRate;
+        float alpha = sinf(w0) / (2.0f * q);
+        float cosw0 = cosf(w0);
+        float a0 = 1.0f + alpha;
+        BiquadCoefficients c;
+        c.b0 = (1.0f - cosw0) / 2.0f / a0;
+        c.b1 = (1.0f - cosw0) / a0;
+        c.b2 = c.b0;
+        c.a1 = -2.0f * cosw0 / a0;
+        c.a2 = (1.0f - alpha) / a0;
+        return c;
+    }
+    
+    static BiquadCoefficients highPass(float sampleRate, float cutoffHz, float q = 0.70710678f) {
+        float w0 = 2.0f * PI * cutoffHz / sampleRate;
+        float alpha = sinf(w0) / (2.0f * q);
+        float cosw0 = cosf(w0);
+        float a0 = 1.0f + alpha;
+        BiquadCoefficients c;
+        c.b0 = (1.0f + cosw0) / 2.0f / a0;
+        c.b1 = -(1.0f + cosw0) / a0;
+        c.b2 = c.b0;
+        c.a1 = -2.0f * cosw0 / a0;
+        c.a2 = (1.0f - alpha) / a0;
+        return c;
+    }
+    
+    // First-order DC blocker y[n] = x[n] - x[n-1] + r * y[n-1]
+    static BiquadCoefficients dcBlocker(float sampleRate, float cutoffHz) {
+        BiquadCoefficients c;
+        float r = 1.0f - 2.0f * PI * cutoffHz / sampleRate;
+        c.b0 = 1.0f;
+        c.b1 = -1.0f;
+        c.b2 = 0.0f;
+        c.a1 = -r;
+        c.a2 = 0.0f;
+        return c;
+    }
+};
+
+// Direct form I section operating on Format::Sample values
+template <typename Format>
+class Biquad;
+
+template <>
+class Biquad<FloatSampleFormat> {
+private:
+    float b0, b1, b2, a1, a2;
+    float x1, x2, y1, y2;
+
+public:
+    Biquad() : b0(1), b1(0), b2(0), a1(0), a2(0), x1(0), x2(0), y1(0), y2(0) {}
+    
+    void configure(const BiquadCoefficients& c) {
+        b0 = c.b0; b1 = c.b1; b2 = c.b2; a1 = c.a1; a2 = c.a2;
+        reset();
+    }
+    
+    void reset() { x1 = x2 = y1 = y2 = 0.0f; }
+    
+    inline float process(float x) {
+        float y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+        x2 = x1; x1 = x;
+        y2 = y1; y1 = y;
+        return y;
+    }
+    
+    // Filters count samples in place, state held in locals for the loop
+    void processBlock(float* data, size_t count) {
+        float sx1 = x1, sx2 = x2, sy1 = y1, sy2 = y2;
+        for (size_t i = 0; i < count; i++) {
+            float x = data[i];
+            float y = b0 * x + b1 * sx1 + b2 * sx2 - a1 * sy1 - a2 * sy2;
+            sx2 = sx1; sx1 = x;
+            sy2 = sy1; sy1 = y;
+            data[i] = y;
+        }
+        x1 = sx1; x2 = sx2; y1 = sy1; y2 = sy2;
+    }
+};
+
+// Integer section shared by the fixed-point formats. Q28 coefficients:
+// low-cutoff poles sit very close to the unit circle, so Q14 would round
+// them onto it. State carries StateFraction extra bits so the output
+// rounding is not amplified by the high-Q feedback path.
+template <typename Format, int StateFraction>
+class IntegerBiquad {
+private:
+    typedef typename Format::Sample Sample;
+    static const int SHIFT = 28;
+    int32_t b0, b1, b2, a1, a2;
+    int32_t x1, x2, y1, y2;
+    
+    static int32_t q(float value) { return (int32_t)lroundf(value * (float)(1L << SHIFT)); }
+
+public:
+    IntegerBiquad() : b0(1L << SHIFT), b1(0), b2(0), a1(0), a2(0), x1(0), x2(0), y1(0), y2(0) {}
+    
+    void configure(const BiquadCoefficients& c) {
+        b0 = q(c.b0); b1 = q(c.b1); b2 = q(c.b2); a1 = q(c.a1); a2 = q(c.a2);
+        reset();
+    }
+    
+    void reset() { x1 = x2 = y1 = y2 = 0; }
+    
+    inline Sample process(Sample sample) {
+        int32_t x = (int32_t)sample << StateFraction;
+        int64_t acc = (int64_t)b0 * x + (int64_t)b1 * x1 + (int64_t)b2 * x2
+                    - (int64_t)a1 * y1 - (int64_t)a2 * y2;
+        int32_t y = (int32_t)((acc + (1LL << (SHIFT - 1))) >> SHIFT);
+        x2 = x1; x1 = x;
+        y2 = y1; y1 = y;
+        return Format::saturate((y + (1L << (StateFraction - 1))) >> StateFraction);
+    }
+    
+    // Filters count samples in place, state held in locals for the loop
+    void processBlock(Sample* data, size_t count) {
+        int32_t sx1 = x1, sx2 = x2, sy1 = y1, sy2 = y2;
+        for (size_t i = 0; i < count; i++) {
+            int32_t x = (int32_t)data[i] << StateFraction;
+            int64_t acc = (int64_t)b0 * x + (int64_t)b1 * sx1 + (int64_t)b2 * sx2
+                        - (int64_t)a1 * sy1 - (int64_t)a2 * sy2;
+            int32_t y = (int32_t)((acc + (1LL << (SHIFT - 1))) >> SHIFT);
+            sx2 = sx1; sx1 = x;
+            sy2 = sy1; sy1 = y;
+            data[i] = Format::saturate((y + (1L << (StateFraction - 1))) >> StateFraction);
+        }
+        x1 = sx1; x2 = sx2; y1 = sy1; y2 = sy2;
+    }
+};
+
+// int16 samples: 8 state bits (|x| < 2^23, products < 2^53)
+template <>
+class Biquad<FixedSampleFormat> : public IntegerBiquad<FixedSampleFormat, 8> {};
+
+// int32 samples already carry WIDE_SAMPLE_FRACTION_BITS; ±16 g is 2^22, so
+// 4 more state bits keep |x| < 2^27 and the products below 2^58
+template <>
+class Biquad<WideSampleFormat> : public IntegerBiquad<WideSampleFormat, 4> {};
+
+#endif // BIQUAD_H
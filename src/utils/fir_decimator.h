@@ -0,0 +1,122 @@
+#ifndef FIR_DECIMATOR_H
+#define FIR_DECIMATOR_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "sample_format.h"
+
+// Tap storage and dot product per sample format. Integer formats use Q15
+// taps and a 64-bit accumulator; the rounding happens once per output, so
+// the averaging gain of the filter ends up in the output's low bits.
+template <typename Format>
+struct FirTaps;
+
+template <>
+struct FirTaps<FloatSampleFormat> {
+    typedef float Tap;
+
+    static Tap quantise(float value) { return value; }
+
+    static float dot(const Tap* taps, const float* history, int length) {
+        float acc = 0.0f;
+        for (int k = 0; k < length; k++) acc += taps[k] * history[k];
+        return acc;
+    }
+};
+
+template <typename Format>
+struct IntegerFirTaps {
+    typedef int32_t Tap;
+    static const int SHIFT = 15;
+
+    static Tap quantise(float value) { return (Tap)lroundf(value * (1L << SHIFT)); }
+
+    static typename Format::Sample dot(const Tap* taps, const typename Format::Sample* history, int length) {
+        int64_t acc = 0;
+        for (int k = 0; k < length; k++) acc += (int64_t)taps[k] * history[k];
+        return Format::saturate((acc + (1LL << (SHIFT - 1))) >> SHIFT);
+    }
+};
+
+template <>
+struct FirTaps<FixedSampleFormat> : public IntegerFirTaps<FixedSampleFormat> {};
+
+template <>
+struct FirTaps<WideSampleFormat> : public IntegerFirTaps<WideSampleFormat> {};
+
+// Polyphase-style FIR decimator by OVERSAMPLE_FACTOR: every input enters the
+// history, but the windowed-sinc low-pass is only evaluated for the inputs
+// that produce an output (one dot product of FACTOR * DECIMATION_TAPS_PER_PHASE
+// taps per output sample and channel). The history is stored twice so the
+// taps always see it as one contiguous run.
+template <typename Format, int Channels>
+class FirDecimator {
+public:
+    typedef typename Format::Sample Sample;
+    static const int FACTOR = OVERSAMPLE_FACTOR;
+    static const int LENGTH = OVERSAMPLE_FACTOR * DECIMATION_TAPS_PER_PHASE;
+
+private:
+    typename FirTaps<Format>::Tap taps[LENGTH];
+    Sample history[Channels][2 * LENGTH];
+    int position;   // Next history slot
+    int phase;      // Inputs since the last output
+
+public:
+    FirDecimator() {
+        configure(DECIMATION_CUTOFF);
+    }
+
+    // Blackman-windowed sinc, cutoff as a fraction of the output Nyquist,
+    // normalised to unity DC gain
+    void configure(float cutoff) {
+        float h[LENGTH];
+        float fc = cutoff / (2.0f * FACTOR);  // cycles per input sample
+        float sum = 0.0f;
+        for (int n = 0; n < LENGTH; n++) {
+            float m = n - (LENGTH - 1) / 2.0f;
+            float sinc = m == 0.0f ? 2.0f * fc : sinf(2.0f * PI * fc * m) / (PI * m);
+            float window = 0.42f - 0.5f * cosf(2.0f * PI * n / (LENGTH - 1)) + 0.08f * cosf(4.0f * PI * n / (LENGTH - 1));
+            h[n] = sinc * window;
+            sum += h[n];
+        }
+        // Reversed, so the dot product runs oldest to newest
+        for (int n = 0; n < LENGTH; n++) taps[LENGTH - 1 - n] = FirTaps<Format>::quantise(h[n] / sum);
+        reset();
+    }
+
+    void reset() {
+        memset(history, 0, sizeof(history));
+        position = 0;
+        phase = 0;
+    }
+
+    // Decimates count samples of each channel in place: outputs are written
+    // to the front of the arrays (never ahead of the input being read).
+    // Returns the number of outputs; firstIndex is the input index of the
+    // first one.
+    size_t processBlock(Sample* const* channels, size_t count, size_t& firstIndex) {
+        size_t produced = 0;
+        firstIndex = 0;
+        for (size_t i = 0; i < count; i++) {
+            for (int c = 0; c < Channels; c++) {
+                history[c][position] = history[c][position + LENGTH] = channels[c][i];
+            }
+            if (++position == LENGTH) position = 0;
+            if (++phase < FACTOR) continue;
+
+            phase = 0;
+            if (produced == 0) firstIndex = i;
+            for (int c = 0; c < Channels; c++) {
+                channels[c][produced] = FirTaps<Format>::dot(taps, &history[c][position], LENGTH);
+            }
+            produced++;
+        }
+        return produced;
+    }
+
+    // Linear phase: every output lags its last input by this much
+    static uint32_t groupDelayUs() { return (uint32_t)((LENGTH - 1) * ACQUISITION_PERIOD_US / 2); }
+};
+
+#endif // FIR_DECIMATOR_H
@@ -0,0 +1,123 @@
+#ifndef RUNNING_MEDIAN_H
+#define RUNNING_MEDIAN_H
+
+#include <Arduino.h>
+
+// Sliding-window median with O(log n) updates. The window is a ring buffer
+// and a max-heap / min-heap pair that share one index array centred on the
+// median: heap slot 0 is the median, slots 1..n are the min-heap above it,
+// slots -1..-n the max-heap below it. Every ring entry knows its heap slot,
+// so the value leaving the window is overwritten in place and sifted.
+template <typename T, int Window>
+class RunningMedian {
+private:
+    static const int CENTER = Window / 2;
+
+    T data[Window];            // Ring buffer of window values
+    int16_t pos[Window];       // Heap slot of each ring entry
+    int16_t heap[Window];      // Ring index per heap slot, offset by CENTER
+    int idx;                   // Next ring slot to overwrite
+    int count;                 // Values in the window (saturates at Window)
+
+    // Slots stay within -maxCount()..minCount(); stating it lets the
+    // compiler see every heap index is inside heap[Window]
+    static size_t heapIndex(int slot) {
+        size_t index = (size_t)(slot + CENTER);
+        if (index >= (size_t)Window) __builtin_unreachable();
+        return index;
+    }
+    int16_t& heapAt(int slot) { return heap[heapIndex(slot)]; }
+    int16_t heapAt(int slot) const { return heap[heapIndex(slot)]; }
+    int minCount() const { return (count - 1) / 2; }
+    int maxCount() const { return count / 2; }
+
+    bool less(int i, int j) const { return data[heapAt(i)] < data[heapAt(j)]; }
+
+    void exchange(int i, int j) {
+        int16_t t = heapAt(i);
+        heapAt(i) = heapAt(j);
+        heapAt(j) = t;
+        pos[heapAt(i)] = i;
+        pos[heapAt(j)] = j;
+    }
+
+    bool compareExchange(int i, int j) {
+        if (!less(i, j)) return false;
+        exchange(i, j);
+        return true;
+    }
+
+    // Restores the min-heap from slot i (a child of i / 2) downwards
+    void minSortDown(int i) {
+        for (; i <= minCount(); i *= 2) {
+            if (i > 1 && i < minCount() && less(i + 1, i)) ++i;
+            if (!compareExchange(i, i / 2)) break;
+        }
+    }
+
+    // Restores the max-heap from slot i (negative) downwards
+    void maxSortDown(int i) {
+        for (; i >= -maxCount(); i *= 2) {
+            if (i < -1 && i > -maxCount() && less(i, i - 1)) --i;
+            if (!compareExchange(i / 2, i)) break;
+        }
+    }
+
+    // Sifts slot i towards the median, true if it became the median
+    bool minSortUp(int i) {
+        while (i > 0 && compareExchange(i, i / 2)) i /= 2;
+        return i == 0;
+    }
+
+    bool maxSortUp(int i) {
+        while (i < 0 && compareExchange(i / 2, i)) i /= 2;
+        return i == 0;
+    }
+
+public:
+    RunningMedian() { reset(); }
+
+    void reset() {
+        idx = 0;
+        count = 0;
+        // Interleave ring entries over the heap slots: 0, -1, 1, -2, 2, ...
+        for (int i = Window - 1; i >= 0; i--) {
+            pos[i] = ((i + 1) / 2) * ((i & 1) ? -1 : 1);
+            heapAt(pos[i]) = i;
+            data[i] = 0;
+        }
+    }
+
+    // Adds a value, evicting the oldest once the window is full
+    void insert(T value) {
+        bool isNew = count < Window;
+        int p = pos[idx];
+        T old = data[idx];
+        data[idx] = value;
+        if (++idx == Window) idx = 0;
+        if (isNew) count++;
+
+        if (p > 0) {
+            // Slot is in the min-heap
+            if (!isNew && old < value) minSortDown(p * 2);
+            else if (minSortUp(p)) maxSortDown(-1);
+        } else if (p < 0) {
+            // Slot is in the max-heap
+            if (!isNew && value < old) maxSortDown(p * 2);
+            else if (maxSortUp(p)) minSortDown(1);
+        } else {
+            // Slot is the median itself
+            if (maxCount()) maxSortDown(-1);
+            if (minCount()) minSortDown(1);
+        }
+    }
+
+    // Median of the current window (upper median while the count is even)
+    T median() const { return count > 0 ? data[heapAt(0)] : 0; }
+
+    bool isFull() const { return count == Window; }
+    int size() const { return count; }
+    static int capacity() { return Window; }
+};
+
+#endif // RUNNING_MEDIAN_H
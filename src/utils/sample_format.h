@@ -0,0 +1,283 @@
+#ifndef SAMPLE_FORMAT_H
+#define SAMPLE_FORMAT_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Sample representations for the acquisition/detection path.
+//
+// Each format defines the storage type of one axis sample, the squared
+// magnitude fed to STA/LTA and the spike filter (no square root per sample),
+// the accumulator types for running sums and the calibration coefficient type. Code in the 500 Hz path is written
+// against these traits, so switching SAMPLE_PIPELINE_FIXED_POINT swaps the
+// whole pipeline between the float reference and integer arithmetic at
+// compile time without touching the algorithms.
+
+// Float reference: values in g, 4 bytes per axis
+struct FloatSampleFormat {
+    typedef float Sample;       // Calibrated axis value (g)
+    typedef float Magnitude;    // Vector magnitude (g)
+    typedef float MagnitudeSq;  // Squared magnitude (g^2)
+    typedef float AxisSum;      // Running sum of axis samples
+    typedef float Sum;          // Running sum of squared magnitudes
+    typedef float Coefficient;  // Rotation matrix entry
+    
+    static const char* name() { return "float32"; }
+    
+    static Coefficient coefficient(float value) { return value; }
+    static Sample fromG(float g) { return g; }
+    static Magnitude magnitudeFromG(float g) { return g; }
+    static MagnitudeSq magnitudeSqFromG(float g) { return g * g; }
+    static float toG(float value) { return value; }
+    static float sumToG(float sum) { return sum; }
+    static float sumSqToG2(Sum sum) { return sum; }
+    static float magnitudeSqToG(MagnitudeSq magnitudeSq) { return sqrtf(magnitudeSq); }
+    
+    // Raw counts of the ±(2 << rangeShift) g range to g
+    static Sample rotate(const Coefficient row[3], int16_t rawX, int16_t rawY, int16_t rawZ, int rangeShift = 0) {
+        const float scale = (float)(1 << rangeShift) / MPU6050_ACCEL_SCALE;
+        return (row[0] * rawX + row[1] * rawY + row[2] * rawZ) * scale;
+    }
+    
+    static Sample subtract(Sample value, Sample offset) { return value - offset; }
+    static Sample mean(AxisSum sum, int count) { return sum / count; }
+    
+    // |value - reference| <= absolute + relative * |reference|
+    static bool agrees(Sample value, Sample reference, Sample absolute, Coefficient relative) {
+        return fabsf(value - reference) <= absolute + relative * fabsf(reference);
+    }
+    
+    static MagnitudeSq magnitudeSquared(Sample x, Sample y, Sample z) {
+        return x * x + y * y + z * z;
+    }
+    
+    // |a| in g for reporting; the detectors stay on squared magnitudes
+    static float magnitudeG(Sample x, Sample y, Sample z) {
+        return magnitudeSqToG(magnitudeSquared(x, y, z));
+    }
+    
+    // |a| > threshold, decided on squared values
+    static bool exceeds(MagnitudeSq magnitudeSq, float thresholdG) {
+        return magnitudeSq > magnitudeSqFromG(thresholdG);
+    }
+    
+    // (staSum / staN) > ratio * (ltaSum / ltaN) without divisions
+    static bool ratioExceeds(Sum staSum, int staN, Sum ltaSum, int ltaN, float ratio) {
+        return staSum * ltaN > ratio * ltaSum * staN;
+    }
+};
+
+// Integer pipeline: counts of the ±2 g range scaled down by the headroom shift
+// (1 LSB = 2^SAMPLE_PIPELINE_HEADROOM_SHIFT / MPU6050_ACCEL_SCALE g), 2 bytes
+// per axis, int32 accumulators and Q14 rotation coefficients. No FPU
+// instructions between the I2C read and the trigger decision.
+struct FixedSampleFormat {
+    typedef int16_t Sample;
+    typedef uint16_t Magnitude;
+    typedef uint32_t MagnitudeSq;
+    typedef int32_t AxisSum;
+    typedef uint64_t Sum;
+    typedef int32_t Coefficient;
+    
+    static const int COEFFICIENT_SHIFT = 14;  // Q14: 1.0 == 16384
+    static const int RATIO_SHIFT = 8;         // Q8 trigger ratio
+    static const int HEADROOM_SHIFT = SAMPLE_PIPELINE_HEADROOM_SHIFT;
+    
+    static const char* name() { return "int16_q14"; }
+    
+    static Coefficient coefficient(float value) {
+        return (Coefficient)lroundf(value * (1 << COEFFICIENT_SHIFT));
+    }
+    
+    static Sample saturate(int32_t value) {
+        if (value > INT16_MAX) return INT16_MAX;
+        if (value < INT16_MIN) return INT16_MIN;
+        return (Sample)value;
+    }
+    
+    static float countsPerG() { return MPU6050_ACCEL_SCALE / (1 << HEADROOM_SHIFT); }
+    
+    static Sample fromG(float g) { return saturate(lroundf(g * countsPerG())); }
+    
+    static Magnitude magnitudeFromG(float g) {
+        long counts = lroundf(g * countsPerG());
+        if (counts < 0) return 0;
+        if (counts > UINT16_MAX) return UINT16_MAX;
+        return (Magnitude)counts;
+    }
+    
+    static MagnitudeSq magnitudeSqFromG(float g) {
+        MagnitudeSq counts = magnitudeFromG(g);
+        return counts * counts;
+    }
+    
+    static float toG(int32_t counts) { return counts / countsPerG(); }
+    static float sumToG(int64_t sum) { return sum / countsPerG(); }
+    static float sumSqToG2(Sum sum) { return sum / (countsPerG() * countsPerG()); }
+    static float magnitudeSqToG(MagnitudeSq magnitudeSq) { return sqrtf((float)magnitudeSq) / countsPerG(); }
+    
+    // Raw counts of the ±(2 << rangeShift) g range to pipeline counts: the Q14
+    // product is shifted by the range (up) and the headroom (down) in one step
+    static Sample rotate(const Coefficient row[3], int16_t rawX, int16_t rawY, int16_t rawZ, int rangeShift = 0) {
+        // |coef| <= 2^14 and |raw| <= 2^15, so three products fit in int32
+        int32_t acc = row[0] * rawX + row[1] * rawY + row[2] * rawZ;
+        const int shift = COEFFICIENT_SHIFT + HEADROOM_SHIFT - rangeShift;
+        return saturate((acc + (1 << (shift - 1))) >> shift);
+    }
+    
+    static Sample subtract(Sample value, Sample offset) {
+        return saturate((int32_t)value - (int32_t)offset);
+    }
+    
+    static Sample mean(AxisSum sum, int count) {
+        // Round half away from zero
+        return saturate((sum + (sum < 0 ? -count / 2 : count / 2)) / count);
+    }
+    
+    static bool agrees(Sample value, Sample reference, Sample absolute, Coefficient relative) {
+        int32_t difference = (int32_t)value - (int32_t)reference;
+        int32_t magnitude = reference < 0 ? -(int32_t)reference : reference;
+        if (difference < 0) difference = -difference;
+        return difference <= absolute + ((magnitude * relative) >> COEFFICIENT_SHIFT);
+    }
+    
+    static MagnitudeSq magnitudeSquared(Sample x, Sample y, Sample z) {
+        // 3 * 32768^2 < 2^32
+        return (uint32_t)((int32_t)x * x) + (uint32_t)((int32_t)y * y) + (uint32_t)((int32_t)z * z);
+    }
+    
+    static float magnitudeG(Sample x, Sample y, Sample z) {
+        return magnitudeSqToG(magnitudeSquared(x, y, z));
+    }
+    
+    static bool exceeds(MagnitudeSq magnitudeSq, float thresholdG) {
+        return magnitudeSq > magnitudeSqFromG(thresholdG);
+    }
+    
+    static bool ratioExceeds(Sum staSum, int staN, Sum ltaSum, int ltaN, float ratio) {
+        // Squares < 2^32: staSum * ltaN < 2^48 and ltaSum * staN < 2^48 for
+        // the configured windows, leaving 16 bits for the Q8 ratio
+        uint64_t lhs = (staSum * ltaN) << RATIO_SHIFT;
+        uint64_t rhs = ltaSum * staN * (uint32_t)lroundf(ratio * (1 << RATIO_SHIFT));
+        return lhs > rhs;
+    }
+};
+
+// Wide integer pipeline for oversample-and-decimate: int32 samples carrying
+// FRACTION_BITS below the ±2 g LSB, so the bits gained by the decimating FIR
+// survive into the detectors. Covers every accel range without headroom
+// shifting (±16 g is 2^22); 64-bit squares and sums.
+struct WideSampleFormat {
+    typedef int32_t Sample;
+    typedef uint32_t Magnitude;
+    typedef uint64_t MagnitudeSq;
+    typedef int64_t AxisSum;
+    typedef uint64_t Sum;
+    typedef int32_t Coefficient;
+    
+    static const int COEFFICIENT_SHIFT = 14;  // Q14: 1.0 == 16384
+    static const int RATIO_SHIFT = 8;         // Q8 trigger ratio
+    static const int FRACTION_BITS = WIDE_SAMPLE_FRACTION_BITS;
+    static_assert(COEFFICIENT_SHIFT - FRACTION_BITS - ACCEL_RANGE_MAX_SHIFT >= 1,
+                  "WIDE_SAMPLE_FRACTION_BITS leaves no rounding bit at the top accel range");
+    
+    static const char* name() { return "int32_q14"; }
+    
+    static Coefficient coefficient(float value) {
+        return (Coefficient)lroundf(value * (1 << COEFFICIENT_SHIFT));
+    }
+    
+    static Sample saturate(int64_t value) {
+        if (value > INT32_MAX) return INT32_MAX;
+        if (value < INT32_MIN) return INT32_MIN;
+        return (Sample)value;
+    }
+    
+    static float countsPerG() { return MPU6050_ACCEL_SCALE * (1 << FRACTION_BITS); }
+    
+    static Sample fromG(float g) { return saturate(llroundf(g * countsPerG())); }
+    
+    static Magnitude magnitudeFromG(float g) {
+        long long counts = llroundf(g * countsPerG());
+        if (counts < 0) return 0;
+        if (counts > UINT32_MAX) return UINT32_MAX;
+        return (Magnitude)counts;
+    }
+    
+    static MagnitudeSq magnitudeSqFromG(float g) {
+        MagnitudeSq counts = magnitudeFromG(g);
+        return counts * counts;
+    }
+    
+    static float toG(int64_t counts) { return counts / countsPerG(); }
+    static float sumToG(int64_t sum) { return sum / countsPerG(); }
+    static float sumSqToG2(Sum sum) { return sum / (countsPerG() * countsPerG()); }
+    static float magnitudeSqToG(MagnitudeSq magnitudeSq) { return sqrtf((float)magnitudeSq) / countsPerG(); }
+    
+    // Raw counts of the ±(2 << rangeShift) g range to pipeline counts
+    static Sample rotate(const Coefficient row[3], int16_t rawX, int16_t rawY, int16_t rawZ, int rangeShift = 0) {
+        // Same int32 product as the int16 format; the shift keeps the
+        // fraction bits instead of dropping them
+        int32_t acc = row[0] * rawX + row[1] * rawY + row[2] * rawZ;
+        const int shift = COEFFICIENT_SHIFT - FRACTION_BITS - rangeShift;
+        return (acc + (1 << (shift - 1))) >> shift;
+    }
+    
+    static Sample subtract(Sample value, Sample offset) {
+        return saturate((int64_t)value - offset);
+    }
+    
+    static Sample mean(AxisSum sum, int count) {
+        return saturate((sum + (sum < 0 ? -count / 2 : count / 2)) / count);
+    }
+    
+    static bool agrees(Sample value, Sample reference, Sample absolute, Coefficient relative) {
+        int64_t difference = (int64_t)value - reference;
+        int64_t magnitude = reference < 0 ? -(int64_t)reference : reference;
+        if (difference < 0) difference = -difference;
+        return difference <= absolute + ((magnitude * relative) >> COEFFICIENT_SHIFT);
+    }
+    
+    static MagnitudeSq magnitudeSquared(Sample x, Sample y, Sample z) {
+        return (uint64_t)((int64_t)x * x) + (uint64_t)((int64_t)y * y) + (uint64_t)((int64_t)z * z);
+    }
+    
+    static float magnitudeG(Sample x, Sample y, Sample z) {
+        return magnitudeSqToG(magnitudeSquared(x, y, z));
+    }
+    
+    static bool exceeds(MagnitudeSq magnitudeSq, float thresholdG) {
+        return magnitudeSq > magnitudeSqFromG(thresholdG);
+    }
+    
+    static bool ratioExceeds(Sum staSum, int staN, Sum ltaSum, int ltaN, float ratio) {
+        // Squares reach 2^46 at ±16 g, so the products can pass 64 bits
+        // during strong shaking: drop the same low bits from both sums first
+        uint32_t ratioQ = (uint32_t)lroundf(ratio * (1 << RATIO_SHIFT));
+        uint64_t top = staSum | ltaSum;
+        int headroom = top ? __builtin_clzll(top) : 64;
+        const int needed = 32 - __builtin_clz(((uint32_t)ltaN << RATIO_SHIFT) | ((uint32_t)staN * ratioQ));
+        if (headroom < needed) {
+            staSum >>= needed - headroom;
+            ltaSum >>= needed - headroom;
+        }
+        uint64_t lhs = (staSum * ltaN) << RATIO_SHIFT;
+        uint64_t rhs = ltaSum * staN * ratioQ;
+        return lhs > rhs;
+    }
+};
+
+#if SAMPLE_PIPELINE_FIXED_POINT && OVERSAMPLE_FACTOR > 1
+typedef WideSampleFormat SampleFormat;
+#elif SAMPLE_PIPELINE_FIXED_POINT
+typedef FixedSampleFormat SampleFormat;
+// Squared thresholds lose resolution quickly: keep the micro trigger several
+// LSB above zero at the headroom the auto-range needs
+static_assert(THRESHOLD_MICRO * MPU6050_ACCEL_SCALE / (1 << SAMPLE_PIPELINE_HEADROOM_SHIFT) >= 8.0f,
+              "THRESHOLD_MICRO below 8 LSB of the int16 pipeline: lower ACCEL_RANGE_MAX_SHIFT, "
+              "disable ACCEL_AUTO_RANGE or oversample (OVERSAMPLE_FACTOR > 1 selects int32 samples)");
+#else
+typedef FloatSampleFormat SampleFormat;
+#endif
+
+#endif // SAMPLE_FORMAT_H
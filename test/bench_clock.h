@@ -0,0 +1,40 @@
+#ifndef BENCH_CLOCK_H
+#define BENCH_CLOCK_H
+
+// Microsecond clock and deterministic noise shared by the host tests and
+// the benchmarks that also run on the ESP32 (pio test -e usb -f <test>)
+
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <esp_timer.h>
+static inline uint64_t benchNowUs() { return (uint64_t)esp_timer_get_time(); }
+#else
+#include <chrono>
+static inline uint64_t benchNowUs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+// xorshift32: the same sequence on the host and the target
+struct BenchRandom {
+    uint32_t state;
+
+    explicit BenchRandom(uint32_t seed = 0x2545F491u) : state(seed) {}
+
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Uniform in [-1, 1)
+    float uniform() { return (int32_t)next() / 2147483648.0f; }
+
+    // Approximately normal (Irwin-Hall of four uniforms), unit variance
+    float gaussian() { return (uniform() + uniform() + uniform() + uniform()) * 0.8660254f; }
+};
+
+#endif // BENCH_CLOCK_H
@@ -0,0 +1,74 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Host stand-in for the parts of the Arduino core the plain C++ modules use
+// (env:native). millis() is a settable clock so tests control time.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+
+#define PI 3.1415926535897932384626433832795
+#define IRAM_ATTR
+
+using std::min;
+using std::max;
+
+template <typename T, typename L, typename H>
+T constrain(T value, L low, H high) { return value < low ? low : (value > high ? high : value); }
+
+extern unsigned long hostMillis;
+inline unsigned long millis() { return hostMillis; }
+inline void delay(unsigned long ms) { hostMillis += ms; }
+
+class String {
+private:
+    std::string text;
+
+public:
+    String() {}
+    String(const char* value) : text(value != nullptr ? value : "") {}
+    String(const std::string& value) : text(value) {}
+    String(int value) : text(std::to_string(value)) {}
+    String(unsigned long value) : text(std::to_string(value)) {}
+
+    const char* c_str() const { return text.c_str(); }
+    unsigned int length() const { return text.size(); }
+    String& operator+=(const String& other) { text += other.text; return *this; }
+    String& operator+=(const char* other) { text += other; return *this; }
+    String& operator+=(char c) { text += c; return *this; }
+    bool operator==(const String& other) const { return text == other.text; }
+    bool operator==(const char* other) const { return text == other; }
+    friend String operator+(const String& a, const String& b) { return String(a.text + b.text); }
+};
+
+class HardwareSerial {
+public:
+    bool enabled = false;   // Tests turn module logging on when debugging
+
+    int printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        if (!enabled) return 0;
+        va_list args;
+        va_start(args, format);
+        int written = vprintf(format, args);
+        va_end(args);
+        return written;
+    }
+    void println(const char* text) { if (enabled) puts(text); }
+};
+
+extern HardwareSerial Serial;
+
+// Single definition of the host globals, in the test's translation unit
+#ifdef HOST_ARDUINO_MAIN
+unsigned long hostMillis = 0;
+HardwareSerial Serial;
+#endif
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,251 @@
+// Coincidence trigger with several simulated stations on a broker
+// stand-in: message format, the common onset window, re-triggers during
+// an event, own echoes and station-id collisions.
+
+#define HOST_ARDUINO_MAIN
+#include <Arduino.h>
+#include <unity.h>
+#include "../../src/modules/coincidence_trigger.cpp"
+
+static const uint64_t T0 = 1760000000000ULL;   // UTC ms of the test quake
+static const int MAX_STATIONS = 5;
+
+// Broker stand-in: every published trigger goes to every station
+// subscribed to TOPIC_TRIGGER_PEERS, the publisher included (as with the
+// wildcard subscription on a real broker)
+struct Broker {
+    CoincidenceTrigger* stations[MAX_STATIONS];
+    int stationCount = 0;
+    unsigned long delivered = 0;
+    String lastTopic;
+
+    void attach(CoincidenceTrigger& station) { stations[stationCount++] = &station; }
+
+    // The MQTT loop of one station: drain its outbox
+    void pump(CoincidenceTrigger& publisher) {
+        String payload;
+        while (publisher.popOutgoing(payload)) {
+            lastTopic = publisher.getTopic();
+            for (int i = 0; i < stationCount; i++) {
+                stations[i]->handlePeerMessage(payload.c_str(), payload.length(), millis());
+                delivered++;
+            }
+        }
+    }
+
+    void pumpAll() {
+        for (int i = 0; i < stationCount; i++) pump(*stations[i]);
+    }
+};
+
+void setUp() {
+    hostMillis = 100000;
+}
+void tearDown() {}
+
+void test_topic_follows_station_id() {
+    CoincidenceTrigger station("alpha", 2, 3000);
+    TEST_ASSERT_EQUAL_STRING("tele/alpha/trigger", station.getTopic());
+    station.setStationId("seismo-a1b2c3");
+    TEST_ASSERT_EQUAL_STRING("seismo-a1b2c3", station.getStationId());
+    TEST_ASSERT_EQUAL_STRING("tele/seismo-a1b2c3/trigger", station.getTopic());
+}
+
+void test_three_stations_confirm() {
+    CoincidenceTrigger a("alpha", 3, 3000), b("bravo", 3, 3000), c("charlie", 3, 3000);
+    Broker broker;
+    broker.attach(a);
+    broker.attach(b);
+    broker.attach(c);
+
+    // P wave crosses the network in 1.8 s
+    a.localTriggerOn(T0, 3.1f);
+    b.localTriggerOn(T0 + 900, 2.7f);
+    c.localTriggerOn(T0 + 1800, 2.6f);
+    broker.pumpAll();
+    TEST_ASSERT_EQUAL_STRING("tele/charlie/trigger", broker.lastTopic.c_str());
+
+    CoincidenceResult result = a.evaluate(T0);
+    TEST_ASSERT_TRUE(result.confirmed);
+    TEST_ASSERT_EQUAL(3, result.stations);
+    TEST_ASSERT_EQUAL_STRING("bravo,charlie", result.peers.c_str());
+    TEST_ASSERT_EQUAL(3, c.evaluate(T0 + 1800).stations);
+    TEST_ASSERT_EQUAL(2, a.getActivePeers(millis()));
+    TEST_ASSERT_EQUAL(0, a.getIdCollisions());
+}
+
+void test_onset_outside_window_is_not_counted() {
+    CoincidenceTrigger a("alpha", 2, 3000), b("bravo", 2, 3000);
+    Broker broker;
+    broker.attach(a);
+    broker.attach(b);
+
+    b.localTriggerOn(T0 + 3001, 2.6f);
+    broker.pumpAll();
+    CoincidenceResult result = a.evaluate(T0);
+    TEST_ASSERT_FALSE(result.confirmed);
+    TEST_ASSERT_EQUAL(1, result.stations);
+    TEST_ASSERT_EQUAL(1, a.getUnconfirmedEvents());
+}
+
+void test_onsets_share_one_window() {
+    // Bravo 2.5 s before and charlie 2.5 s after the local onset are each
+    // within the window of alpha, but 5 s apart from each other
+    CoincidenceTrigger a("alpha", 3, 3000), b("bravo", 3, 3000), c("charlie", 3, 3000);
+    Broker broker;
+    broker.attach(a);
+    broker.attach(b);
+    broker.attach(c);
+
+    b.localTriggerOn(T0 - 2500, 2.6f);
+    c.localTriggerOn(T0 + 2500, 2.6f);
+    broker.pumpAll();
+    CoincidenceResult result = a.evaluate(T0);
+    TEST_ASSERT_FALSE(result.confirmed);
+    TEST_ASSERT_EQUAL(2, result.stations);
+}
+
+void test_retrigger_keeps_matching_onset() {
+    // Bravo triggers with alpha, ends, and re-triggers on the coda before
+    // alpha's event is evaluated at onset + window
+    CoincidenceTrigger a("alpha", 2, 3000), b("bravo", 2, 3000);
+    Broker broker;
+    broker.attach(a);
+    broker.attach(b);
+
+    a.localTriggerOn(T0, 3.0f);
+    b.localTriggerOn(T0 + 400, 2.8f);
+    broker.pumpAll();
+    b.localTriggerOff(T0 + 1500);
+    b.localTriggerOn(T0 + 4000, 2.6f);
+    b.localTriggerOff(T0 + 4600);
+    b.localTriggerOn(T0 + 9000, 2.6f);
+    broker.pumpAll();
+
+    CoincidenceResult result = a.evaluate(T0);
+    TEST_ASSERT_TRUE(result.confirmed);
+    TEST_ASSERT_EQUAL_STRING("bravo", result.peers.c_str());
+
+    // The history is bounded: after COINCIDENCE_ONSET_HISTORY newer onsets
+    // the first one is gone
+    for (int i = 0; i < COINCIDENCE_ONSET_HISTORY; i++) {
+        b.localTriggerOn(T0 + 20000 + i * 5000, 2.6f);
+    }
+    broker.pumpAll();
+    TEST_ASSERT_FALSE(a.evaluate(T0).confirmed);
+}
+
+void test_repeated_message_is_stored_once() {
+    CoincidenceTrigger a("alpha", 2, 3000);
+    const char* message = "bravo,1,1760000000400,2.80";
+    for (int i = 0; i < COINCIDENCE_ONSET_HISTORY + 2; i++) {
+        TEST_ASSERT_TRUE(a.handlePeerMessage(message, strlen(message), millis()));
+    }
+    TEST_ASSERT_EQUAL(1, a.getKnownPeers());
+    TEST_ASSERT_TRUE(a.evaluate(T0).confirmed);
+}
+
+void test_own_echo_is_not_a_collision() {
+    CoincidenceTrigger a("alpha", 2, 3000);
+    Broker broker;
+    broker.attach(a);
+
+    a.localTriggerOn(T0, 3.0f);
+    a.localTriggerOff(T0 + 2000);
+    broker.pumpAll();
+    TEST_ASSERT_EQUAL(2, a.getMessagesSent());
+    TEST_ASSERT_EQUAL(0, a.getMessagesReceived());
+    TEST_ASSERT_EQUAL(0, a.getIdCollisions());
+    TEST_ASSERT_EQUAL(0, a.getKnownPeers());
+}
+
+void test_duplicate_station_id_is_reported() {
+    // Two stations left at the same id: each drops the other's triggers,
+    // but the collision is counted instead of passing silently
+    CoincidenceTrigger a("seismograph", 2, 3000), b("seismograph", 2, 3000);
+    Broker broker;
+    broker.attach(a);
+    broker.attach(b);
+
+    a.localTriggerOn(T0, 3.0f);
+    b.localTriggerOn(T0 + 300, 2.9f);
+    broker.pumpAll();
+    TEST_ASSERT_EQUAL(1, a.getIdCollisions());
+    TEST_ASSERT_EQUAL(1, b.getIdCollisions());
+    TEST_ASSERT_FALSE(a.evaluate(T0).confirmed);
+
+    // With unique ids they confirm each other
+    a.setStationId("seismo-0a0b0c");
+    b.setStationId("seismo-0d0e0f");
+    a.localTriggerOn(T0 + 60000, 3.0f);
+    b.localTriggerOn(T0 + 60300, 2.9f);
+    broker.pumpAll();
+    TEST_ASSERT_TRUE(a.evaluate(T0 + 60000).confirmed);
+    TEST_ASSERT_TRUE(b.evaluate(T0 + 60300).confirmed);
+}
+
+void test_malformed_messages_are_rejected() {
+    CoincidenceTrigger a("alpha", 2, 3000);
+    const char* messages[] = {
+        "",
+        "bravo",
+        "bravo,1",
+        "bravo,1,0,2.5",
+        "bravo,1,notanumber,2.5",
+    };
+    for (const char* message : messages) {
+        TEST_ASSERT_FALSE(a.handlePeerMessage(message, strlen(message), millis()));
+    }
+    char tooLong[80];
+    memset(tooLong, 'x', sizeof(tooLong));
+    TEST_ASSERT_FALSE(a.handlePeerMessage(tooLong, sizeof(tooLong), millis()));
+    TEST_ASSERT_EQUAL(6, a.getMessagesRejected());
+    TEST_ASSERT_EQUAL(0, a.getKnownPeers());
+
+    // Ratio is optional
+    const char* minimal = "bravo,1,1760000000100";
+    TEST_ASSERT_TRUE(a.handlePeerMessage(minimal, strlen(minimal), millis()));
+    TEST_ASSERT_TRUE(a.evaluate(T0).confirmed);
+}
+
+void test_peer_table_replaces_least_recent() {
+    CoincidenceTrigger a("alpha", 2, 3000);
+    char message[64];
+    for (int i = 0; i < COINCIDENCE_MAX_PEERS + 1; i++) {
+        hostMillis += 1000;
+        int length = snprintf(message, sizeof(message), "peer%d,1,%llu,2.6", i, (unsigned long long)(T0 + 100 * i));
+        TEST_ASSERT_TRUE(a.handlePeerMessage(message, length, millis()));
+    }
+    TEST_ASSERT_EQUAL(COINCIDENCE_MAX_PEERS, a.getKnownPeers());
+    CoincidenceResult result = a.evaluate(T0);
+    TEST_ASSERT_EQUAL(COINCIDENCE_MAX_PEERS + 1, result.stations);
+    TEST_ASSERT_TRUE(strstr(result.peers.c_str(), "peer0") == nullptr);
+}
+
+static int runTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_topic_follows_station_id);
+    RUN_TEST(test_three_stations_confirm);
+    RUN_TEST(test_onset_outside_window_is_not_counted);
+    RUN_TEST(test_onsets_share_one_window);
+    RUN_TEST(test_retrigger_keeps_matching_onset);
+    RUN_TEST(test_repeated_message_is_stored_once);
+    RUN_TEST(test_own_echo_is_not_a_collision);
+    RUN_TEST(test_duplicate_station_id_is_reported);
+    RUN_TEST(test_malformed_messages_are_rejected);
+    RUN_TEST(test_peer_table_replaces_least_recent);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runTests();
+}
+
+void loop() {}
+#else
+int main() {
+    return runTests();
+}
+#endif
@@ -0,0 +1,185 @@
+// Early magnitude on reference traces: the AIC pick against a known onset,
+// and tau_c / Pd from synthetic P waves of known period and displacement.
+// The traces are built from a displacement record, so the expected values
+// follow from the tau_c / Pd relations directly.
+
+#define HOST_ARDUINO_MAIN
+#include <Arduino.h>
+#include <unity.h>
+#include "../bench_clock.h"
+#include "../../src/modules/early_magnitude.cpp"
+
+static const uint64_t START_US = 5000000;        // Timer value of the first sample
+static const int LEAD_IN_SAMPLES = 2 * SAMPLING_RATE;
+static const float NOISE_G = 0.0002f;            // ~0.2 mg RMS, a quiet MPU6050
+static const float OFFSET_G = 0.002f;            // Offset residue the baseline removes
+
+static EarlyMagnitudeEstimator estimator;
+
+void setUp() {
+    estimator.reset();
+}
+void tearDown() {}
+
+// Reference P wave of moment magnitude M at EARLY_MAG_DISTANCE_KM: a
+// displacement sinusoid whose period is the tau_c and whose amplitude is the
+// Pd the relations give for M, switched on with a half-period sin^2 ramp so
+// the ground starts at rest. Acceleration is its second difference.
+struct ReferenceTrace {
+    float magnitude;
+    float periodS;
+    float pdCm;
+    int onsetSample;
+    int length;
+    static const int MAX_LENGTH = 6 * SAMPLING_RATE;
+    float accelG[MAX_LENGTH];
+
+    void build(float m, int onset, int total, uint32_t seed) {
+        magnitude = m;
+        periodS = powf(10.0f, (m - 5.787f) / 3.373f);
+        pdCm = powf(10.0f, -3.463f + 0.729f * m - 1.374f * log10f(EARLY_MAG_DISTANCE_KM));
+        onsetSample = onset;
+        length = total;
+
+        const double dt = 1.0 / SAMPLING_RATE;
+        const double omega = 2.0 * PI / periodS;
+        const double ramp = 0.5 * periodS;
+        const double amplitudeM = pdCm / 100.0;
+        auto displacement = [&](int n) -> double {
+            double t = (n - onsetSample) * dt;
+            if (t <= 0.0) return 0.0;
+            double envelope = t < ramp ? pow(sin(0.5 * PI * t / ramp), 2) : 1.0;
+            return amplitudeM * envelope * sin(omega * t);
+        };
+
+        BenchRandom random(seed);
+        for (int n = 0; n < length; n++) {
+            double accel = (displacement(n + 1) - 2.0 * displacement(n) + displacement(n - 1)) / (dt * dt);
+            accelG[n] = (float)(accel / 9.80665) + OFFSET_G + NOISE_G * random.gaussian();
+        }
+    }
+
+    // Feeds the trace in pipeline blocks; starts the estimator on the block
+    // holding triggerSample, like Seismograph::handleBlock()
+    void run(EarlyMagnitudeEstimator& target, int triggerSample) const {
+        SampleFormat::Sample block[PIPELINE_BLOCK_SIZE];
+        for (int n = 0; n < length; n += PIPELINE_BLOCK_SIZE) {
+            int count = min(PIPELINE_BLOCK_SIZE, length - n);
+            for (int i = 0; i < count; i++) block[i] = SampleFormat::fromG(accelG[n + i]);
+            target.addBlock(block, count, START_US + n * (uint64_t)SAMPLING_PERIOD_US);
+            if (triggerSample >= n && triggerSample < n + count) {
+                target.start(1, START_US + triggerSample * (uint64_t)SAMPLING_PERIOD_US);
+            }
+        }
+    }
+};
+
+static ReferenceTrace trace;
+
+void test_relations_invert() {
+    for (float m = 3.0f; m <= 7.5f; m += 0.5f) {
+        float tauC = powf(10.0f, (m - 5.787f) / 3.373f);
+        float pd = powf(10.0f, -3.463f + 0.729f * m - 1.374f * log10f(20.0f));
+        TEST_ASSERT_FLOAT_WITHIN(0.001f, m, EarlyMagnitudeEstimator::magnitudeFromTauC(tauC));
+        TEST_ASSERT_FLOAT_WITHIN(0.001f, m, EarlyMagnitudeEstimator::magnitudeFromPd(pd, 20.0f));
+    }
+    TEST_ASSERT_EQUAL_FLOAT(-2.0f, EarlyMagnitudeEstimator::magnitudeFromTauC(0.0f));
+    TEST_ASSERT_EQUAL_FLOAT(-2.0f, EarlyMagnitudeEstimator::magnitudeFromPd(0.0f, 20.0f));
+}
+
+void test_aic_pick_finds_onset() {
+    // STA/LTA fires 50-150 ms into the P wave; the pick goes back to the
+    // onset (a little late, the ramped onset starts below the noise)
+    for (int delay = 25; delay <= 75; delay += 25) {
+        estimator.reset();
+        trace.build(6.0f, LEAD_IN_SAMPLES, LEAD_IN_SAMPLES + 4 * SAMPLING_RATE, 11 + delay);
+        trace.run(estimator, LEAD_IN_SAMPLES + delay);
+        float expectedLeadMs = delay * 1000.0f / SAMPLING_RATE;
+        TEST_ASSERT_FLOAT_WITHIN(30.0f, expectedLeadMs, estimator.estimate().onsetLeadMs);
+    }
+}
+
+void test_tau_c_and_pd_recover_magnitude() {
+    const float magnitudes[] = { 5.5f, 6.0f, 6.5f };
+    unsigned long completedBefore = estimator.getEstimatesCompleted();
+    for (float m : magnitudes) {
+        estimator.reset();
+        trace.build(m, LEAD_IN_SAMPLES, LEAD_IN_SAMPLES + 4 * SAMPLING_RATE, 23);
+        trace.run(estimator, LEAD_IN_SAMPLES + 30);
+        const EarlyMagnitudeEstimate& e = estimator.estimate();
+
+        char message[160];
+        snprintf(message, sizeof(message), "M %.1f: tau_c %.3f s (ref %.3f), Pd %.4f cm (ref %.4f) -> M_tauc %.2f, M_pd %.2f",
+                 m, e.tauC, trace.periodS, e.pdCm, trace.pdCm, e.magnitudeTauC, e.magnitudePd);
+        TEST_MESSAGE(message);
+
+        TEST_ASSERT_TRUE(e.valid);
+        TEST_ASSERT_TRUE(e.complete);
+        TEST_ASSERT_EQUAL(EARLY_MAG_WINDOW_MS, e.windowMs);
+        TEST_ASSERT_FLOAT_WITHIN(0.15f * trace.periodS, trace.periodS, e.tauC);
+        TEST_ASSERT_FLOAT_WITHIN(0.25f * trace.pdCm, trace.pdCm, e.pdCm);
+        TEST_ASSERT_FLOAT_WITHIN(0.3f, m, e.magnitude);
+    }
+    TEST_ASSERT_EQUAL(completedBefore + 3, estimator.getEstimatesCompleted());
+}
+
+void test_preliminary_estimate_after_min_window() {
+    trace.build(6.0f, LEAD_IN_SAMPLES, LEAD_IN_SAMPLES + 4 * SAMPLING_RATE, 5);
+    // Stop feeding 1.2 s after the onset: a preliminary, not a final value
+    trace.length = LEAD_IN_SAMPLES + (EARLY_MAG_MIN_WINDOW_MS + 200) * SAMPLING_RATE / 1000;
+    trace.run(estimator, LEAD_IN_SAMPLES + 30);
+    const EarlyMagnitudeEstimate& e = estimator.estimate();
+    TEST_ASSERT_TRUE(e.valid);
+    TEST_ASSERT_FALSE(e.complete);
+    TEST_ASSERT_GREATER_OR_EQUAL(EARLY_MAG_MIN_WINDOW_MS, e.windowMs);
+
+    EarlyMagnitudeEstimate snapshot;
+    estimator.getSnapshot(snapshot);
+    TEST_ASSERT_EQUAL(e.windowMs, snapshot.windowMs);
+    TEST_ASSERT_EQUAL(1, snapshot.traceId);
+}
+
+void test_small_event_stays_invalid() {
+    // Pd below EARLY_MAG_MIN_PD_CM: the double-integrated noise would set tau_c
+    trace.build(4.0f, LEAD_IN_SAMPLES, LEAD_IN_SAMPLES + 4 * SAMPLING_RATE, 9);
+    TEST_ASSERT_LESS_THAN(EARLY_MAG_MIN_PD_CM, trace.pdCm);
+    unsigned long completedBefore = estimator.getEstimatesCompleted();
+    trace.run(estimator, LEAD_IN_SAMPLES + 30);
+    TEST_ASSERT_FALSE(estimator.estimate().valid);
+    TEST_ASSERT_EQUAL(completedBefore, estimator.getEstimatesCompleted());
+}
+
+void test_cancel_clears_estimate() {
+    trace.build(6.0f, LEAD_IN_SAMPLES, LEAD_IN_SAMPLES + 4 * SAMPLING_RATE, 3);
+    trace.run(estimator, LEAD_IN_SAMPLES + 30);
+    TEST_ASSERT_TRUE(estimator.estimate().valid);
+    estimator.cancel();
+    EarlyMagnitudeEstimate snapshot;
+    estimator.getSnapshot(snapshot);
+    TEST_ASSERT_FALSE(snapshot.valid);
+    TEST_ASSERT_EQUAL(0, snapshot.traceId);
+}
+
+static int runTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_relations_invert);
+    RUN_TEST(test_aic_pick_finds_onset);
+    RUN_TEST(test_tau_c_and_pd_recover_magnitude);
+    RUN_TEST(test_preliminary_estimate_after_min_window);
+    RUN_TEST(test_small_event_stays_invalid);
+    RUN_TEST(test_cancel_clears_estimate);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runTests();
+}
+
+void loop() {}
+#else
+int main() {
+    return runTests();
+}
+#endif
@@ -0,0 +1,172 @@
+// RunningMedian against a brute-force sorted window, and its cost per
+// sample against the copy + selection median the spike filter used before
+// (also on the ESP32: pio test -e usb -f test_running_median).
+
+#define HOST_ARDUINO_MAIN
+#include <Arduino.h>
+#include <unity.h>
+#include "../bench_clock.h"
+#include "../../src/utils/running_median.h"
+
+static const int STREAM_SAMPLES = 200000;
+
+void setUp() {}
+void tearDown() {}
+
+// Magnitudes like the spike filter sees: noise floor, bursts and spikes,
+// with many repeated values
+static uint16_t streamValue(BenchRandom& random, int n) {
+    int32_t value = 60 + (int32_t)(8.0f * random.gaussian());
+    if ((n / 1000) % 7 == 3) value += (int32_t)(400.0f * fabsf(random.uniform()));
+    if (random.next() % 97 == 0) value += 3000;
+    return (uint16_t)constrain(value, 0, 65535);
+}
+
+// Upper median of the last min(n, Window) values, by sorting a copy
+template <int Window>
+static uint16_t bruteForceMedian(const uint16_t* history, int n) {
+    int count = min(n, Window);
+    uint16_t sorted[Window];
+    for (int i = 0; i < count; i++) sorted[i] = history[n - count + i];
+    std::sort(sorted, sorted + count);
+    return sorted[count / 2];
+}
+
+template <int Window>
+static void checkAgainstBruteForce() {
+    static uint16_t history[STREAM_SAMPLES];
+    static RunningMedian<uint16_t, Window> median;
+    median.reset();
+    BenchRandom random(Window);
+    for (int n = 0; n < STREAM_SAMPLES; n++) {
+        history[n] = streamValue(random, n);
+        median.insert(history[n]);
+        if (median.median() != bruteForceMedian<Window>(history, n + 1)) {
+            char message[96];
+            snprintf(message, sizeof(message), "window %d differs at sample %d", Window, n);
+            TEST_FAIL_MESSAGE(message);
+        }
+    }
+    TEST_ASSERT_TRUE(median.isFull());
+    TEST_ASSERT_EQUAL(Window, median.size());
+}
+
+void test_matches_brute_force() {
+    checkAgainstBruteForce<1>();
+    checkAgainstBruteForce<2>();
+    checkAgainstBruteForce<3>();
+    checkAgainstBruteForce<4>();
+    checkAgainstBruteForce<5>();
+    checkAgainstBruteForce<11>();
+    checkAgainstBruteForce<21>();
+    checkAgainstBruteForce<51>();
+    checkAgainstBruteForce<101>();
+}
+
+void test_reset_empties_window() {
+    RunningMedian<uint16_t, 5> median;
+    TEST_ASSERT_EQUAL(0, median.median());
+    for (int i = 0; i < 5; i++) median.insert(100);
+    median.reset();
+    TEST_ASSERT_EQUAL(0, median.size());
+    median.insert(7);
+    TEST_ASSERT_EQUAL(7, median.median());
+}
+
+// The spike filter before the running median: copy the ring, then
+// selection-sort up to the middle element for every sample
+template <int Window>
+class CopySelectionMedian {
+private:
+    uint16_t data[Window];
+    int idx = 0;
+    int count = 0;
+
+public:
+    void insert(uint16_t value) {
+        data[idx] = value;
+        if (++idx == Window) idx = 0;
+        if (count < Window) count++;
+    }
+
+    uint16_t median() const {
+        uint16_t sorted[Window];
+        memcpy(sorted, data, count * sizeof(uint16_t));
+        for (int i = 0; i <= count / 2; i++) {
+            int smallest = i;
+            for (int j = i + 1; j < count; j++) {
+                if (sorted[j] < sorted[smallest]) smallest = j;
+            }
+            uint16_t t = sorted[i];
+            sorted[i] = sorted[smallest];
+            sorted[smallest] = t;
+        }
+        return sorted[count / 2];
+    }
+};
+
+static uint16_t benchStream[4096];
+static volatile uint32_t benchSink;
+
+// Insert + median, ns per sample
+template <typename Median>
+static float benchmarkMedian(Median& median, int samples) {
+    uint32_t sum = 0;
+    uint64_t start = benchNowUs();
+    for (int n = 0; n < samples; n++) {
+        median.insert(benchStream[n & 4095]);
+        sum += median.median();
+    }
+    uint64_t elapsed = benchNowUs() - start;
+    benchSink = sum;
+    return elapsed * 1000.0f / samples;
+}
+
+template <int Window>
+static void benchmarkWindow() {
+    static RunningMedian<uint16_t, Window> running;
+    static CopySelectionMedian<Window> copySelection;
+    running.reset();
+    // Fewer samples for the quadratic baseline on wide windows
+    const int samples = 200000;
+    const int baselineSamples = Window > 21 ? 20000 : samples;
+    float runningNs = benchmarkMedian(running, samples);
+    float baselineNs = benchmarkMedian(copySelection, baselineSamples);
+
+    char message[128];
+    snprintf(message, sizeof(message), "window %3d: running median %.1f ns, copy + selection %.1f ns per sample",
+             Window, runningNs, baselineNs);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_GREATER_THAN(0.0f, runningNs + baselineNs);
+}
+
+void test_benchmark_windows() {
+    BenchRandom random;
+    for (int n = 0; n < 4096; n++) benchStream[n] = streamValue(random, n);
+    benchmarkWindow<5>();
+    benchmarkWindow<11>();
+    benchmarkWindow<21>();
+    benchmarkWindow<51>();
+    benchmarkWindow<101>();
+}
+
+static int runTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_matches_brute_force);
+    RUN_TEST(test_reset_empties_window);
+    RUN_TEST(test_benchmark_windows);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runTests();
+}
+
+void loop() {}
+#else
+int main() {
+    return runTests();
+}
+#endif
@@ -0,0 +1,267 @@
+// Fixed-point sample pipeline against the float reference: exact helpers,
+// calibrated magnitudes within a few LSB (the chains only see |a|^2), the same trigger decisions, and
+// the cost per sample of each format (also on the ESP32:
+// pio test -e usb -f test_sample_format).
+
+#define HOST_ARDUINO_MAIN
+#include <Arduino.h>
+#include <unity.h>
+#include "../bench_clock.h"
+#include "../../src/modules/processing_pipeline.h"
+
+typedef Pipeline<FloatSampleFormat, SpikeFilterStage, StaLtaStage> FloatChain;
+typedef Pipeline<FixedSampleFormat, SpikeFilterStage, StaLtaStage> FixedChain;
+
+static const int STREAM_SAMPLES = 300000;      // 10 min at 500 Hz
+static const float TILT_DEG = 23.0f;
+static const float AZIMUTH_DEG = 40.0f;
+static const float NOISE_COUNTS = 3.0f;        // ~0.2 mg RMS, like a quiet MPU6050
+
+// Sensor frame -> Z-up frame: tilt about X, then azimuth about Z
+static float rotation[3][3];
+static float offsetG[3];
+
+static FloatChain floatChain;
+static FixedChain fixedChain;
+static FloatChain::Block floatBlock;
+static FixedChain::Block fixedBlock;
+
+void setUp() {}
+void tearDown() {}
+
+static void buildMount() {
+    float t = TILT_DEG * (float)PI / 180.0f;
+    float a = AZIMUTH_DEG * (float)PI / 180.0f;
+    float rx[3][3] = { { 1, 0, 0 }, { 0, cosf(t), -sinf(t) }, { 0, sinf(t), cosf(t) } };
+    float rz[3][3] = { { cosf(a), -sinf(a), 0 }, { sinf(a), cosf(a), 0 }, { 0, 0, 1 } };
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) {
+            rotation[r][c] = rz[r][0] * rx[0][c] + rz[r][1] * rx[1][c] + rz[r][2] * rx[2][c];
+        }
+    }
+    // Calibration leaves gravity as the Z offset of the Z-up frame
+    offsetG[0] = 0.0f;
+    offsetG[1] = 0.0f;
+    offsetG[2] = 1.0f;
+}
+
+// Raw counts of sample n: gravity plus noise, with an 8 Hz burst every 20 s
+static void rawSample(int n, BenchRandom& random, int16_t raw[3]) {
+    float up[3] = { 0.0f, 0.0f, 1.0f };
+    int second = n / SAMPLING_RATE;
+    if (second % 20 == 10) {
+        float t = (float)(n % (20 * SAMPLING_RATE) - 10 * SAMPLING_RATE) / SAMPLING_RATE;
+        float amplitude = 0.01f * (1 + (n / (20 * SAMPLING_RATE)) % 8);
+        float envelope = sinf((float)PI * t);
+        up[0] += amplitude * envelope * sinf(2.0f * (float)PI * 8.0f * t);
+        up[2] += 0.5f * amplitude * envelope * cosf(2.0f * (float)PI * 8.0f * t);
+    }
+    // Z-up frame back to the sensor frame (transpose)
+    for (int axis = 0; axis < 3; axis++) {
+        float g = rotation[0][axis] * up[0] + rotation[1][axis] * up[1] + rotation[2][axis] * up[2];
+        long counts = lroundf(g * MPU6050_ACCEL_SCALE + NOISE_COUNTS * random.gaussian());
+        raw[axis] = (int16_t)constrain(counts, -32768L, 32767L);
+    }
+}
+
+template <typename Format>
+struct Calibration {
+    typename Format::Coefficient coefficients[3][3];
+    typename Format::Sample offsets[3];
+
+    Calibration() {
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) coefficients[r][c] = Format::coefficient(rotation[r][c]);
+            offsets[r] = Format::fromG(offsetG[r]);
+        }
+    }
+
+    // Same per-sample work as Seismograph::calibrateBlock() + finishBlock()
+    void apply(const int16_t raw[3], SampleBlock<Format>& block, size_t i) const {
+        block.x[i] = Format::subtract(Format::rotate(coefficients[0], raw[0], raw[1], raw[2]), offsets[0]);
+        block.y[i] = Format::subtract(Format::rotate(coefficients[1], raw[0], raw[1], raw[2]), offsets[1]);
+        block.z[i] = Format::subtract(Format::rotate(coefficients[2], raw[0], raw[1], raw[2]), offsets[2]);
+        block.magnitudeSq[i] = Format::magnitudeSquared(block.x[i], block.y[i], block.z[i]);
+        block.inputMagnitudeSq[i] = block.magnitudeSq[i];
+    }
+};
+
+void test_squared_threshold_is_exact() {
+    // |a| > t on counts, decided on |a|^2 > t^2, up to the largest magnitude
+    const float thresholds[] = { THRESHOLD_MICRO, THRESHOLD_LIGHT, THRESHOLD_STRONG, 1.5f };
+    for (float thresholdG : thresholds) {
+        uint32_t threshold = FixedSampleFormat::magnitudeFromG(thresholdG);
+        for (uint32_t magnitude = 0; magnitude <= 56755; magnitude++) {
+            TEST_ASSERT_EQUAL(magnitude > threshold,
+                              FixedSampleFormat::exceeds(magnitude * magnitude, thresholdG));
+        }
+    }
+}
+
+void test_identity_rotation_is_exact() {
+    // Q14 identity: counts pass through, only the headroom shift rounds
+    FixedSampleFormat::Coefficient row[3] = {
+        FixedSampleFormat::coefficient(1.0f), FixedSampleFormat::coefficient(0.0f), FixedSampleFormat::coefficient(0.0f)
+    };
+    const int headroom = FixedSampleFormat::HEADROOM_SHIFT;
+    for (int32_t raw = -32768; raw <= 32767; raw += 7) {
+        int32_t expected = (raw + (headroom > 0 ? 1 << (headroom - 1) : 0)) >> headroom;
+        TEST_ASSERT_EQUAL_INT(expected, FixedSampleFormat::rotate(row, (int16_t)raw, 0, 0));
+    }
+}
+
+void test_ratio_decision_matches_exact_arithmetic() {
+    // The Q8 ratio is exact for 2.5; compare with the rational inequality
+    BenchRandom random(7);
+    for (int i = 0; i < 200000; i++) {
+        uint32_t sta = random.next() % (STA_WINDOW * 4000u);
+        uint32_t lta = random.next() % (LTA_WINDOW * 4000u) + 1;
+        bool expected = (uint64_t)sta * LTA_WINDOW * 2 > (uint64_t)lta * STA_WINDOW * 5;
+        TEST_ASSERT_EQUAL(expected, FixedSampleFormat::ratioExceeds(sta, STA_WINDOW, lta, LTA_WINDOW, 2.5f));
+    }
+}
+
+void test_wide_ratio_survives_full_scale() {
+    // LTA sums of ±16 g squares overflow the unscaled 64-bit products; the
+    // decision must still follow the exact rational inequality
+    BenchRandom random(11);
+    const uint64_t topSquare = 3ULL << 44;
+    for (int i = 0; i < 200000; i++) {
+        uint64_t sta = ((uint64_t)random.next() << 32 | random.next()) % (STA_WINDOW * topSquare);
+        uint64_t lta = ((uint64_t)random.next() << 32 | random.next()) % (LTA_WINDOW * topSquare) + 1;
+        long double lhs = (long double)sta * LTA_WINDOW * 4;
+        long double rhs = (long double)lta * STA_WINDOW * 25;
+        // Dropped low bits only matter within a few ulp of the edge
+        if (fabsl(lhs - rhs) < rhs * 1e-9L) continue;
+        TEST_ASSERT_EQUAL(lhs > rhs, WideSampleFormat::ratioExceeds(sta, STA_WINDOW, lta, LTA_WINDOW, 6.25f));
+    }
+}
+
+void test_fixed_chain_tracks_float_reference() {
+    buildMount();
+    Calibration<FloatSampleFormat> floatCalibration;
+    Calibration<FixedSampleFormat> fixedCalibration;
+    floatChain.reset();
+    fixedChain.reset();
+
+    const float lsb = 1.0f / FixedSampleFormat::countsPerG();
+    BenchRandom random;
+    float worstMagnitudeError = 0.0f;
+    long decisions = 0;
+    long disagreements = 0;
+    long floatTriggers = 0;
+    long lastFloatEdge = -1000000;
+    long lastFixedEdge = -1000000;
+    bool floatState = false;
+    bool fixedState = false;
+    long worstEdgeDistance = 0;
+
+    // One sample per call, so every decision can be compared (the chains
+    // are block-size independent). The ratio moves by several percent per
+    // sample at an onset, so one LSB can shift a trigger edge by a sample
+    // or two; a disagreement must sit next to an edge of either chain.
+    for (int n = 0; n < STREAM_SAMPLES; n++) {
+        int16_t raw[3];
+        rawSample(n, random, raw);
+        floatCalibration.apply(raw, floatBlock, 0);
+        fixedCalibration.apply(raw, fixedBlock, 0);
+        float error = fabsf(FixedSampleFormat::magnitudeSqToG(fixedBlock.magnitudeSq[0]) -
+                            FloatSampleFormat::magnitudeSqToG(floatBlock.magnitudeSq[0]));
+        if (error > worstMagnitudeError) worstMagnitudeError = error;
+
+        floatChain.processBlock(floatBlock, 1);
+        fixedChain.processBlock(fixedBlock, 1);
+        if (floatBlock.rejected[0] || fixedBlock.rejected[0]) continue;
+        decisions++;
+        floatTriggers += floatBlock.triggered[0];
+        if (floatBlock.triggered[0] != floatState) {
+            floatState = floatBlock.triggered[0];
+            lastFloatEdge = n;
+        }
+        if (fixedBlock.triggered[0] != fixedState) {
+            fixedState = fixedBlock.triggered[0];
+            lastFixedEdge = n;
+        }
+        if (floatState != fixedState) {
+            disagreements++;
+            long distance = n - max(lastFloatEdge, lastFixedEdge);
+            if (distance > worstEdgeDistance) worstEdgeDistance = distance;
+        }
+    }
+
+    char message[256];
+    snprintf(message, sizeof(message), "max |magnitude| error %.2f LSB, %ld of %ld trigger decisions differ "
+             "(%ld float triggers), at most %ld samples after a trigger edge",
+             worstMagnitudeError / lsb, disagreements, decisions, floatTriggers, worstEdgeDistance);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_GREATER_THAN(1000, floatTriggers);
+    TEST_ASSERT_LESS_OR_EQUAL(2.0f * lsb, worstMagnitudeError);
+    TEST_ASSERT_LESS_OR_EQUAL(decisions / 2000, disagreements);
+    TEST_ASSERT_LESS_OR_EQUAL(8, worstEdgeDistance);
+}
+
+void test_fixed_buffers_are_half_size() {
+    // Axis samples halve; the STA/LTA rings hold 32-bit squares in both formats
+    TEST_ASSERT_EQUAL(2 * sizeof(FixedChain::Block::x), sizeof(FloatChain::Block::x));
+    TEST_ASSERT_EQUAL(StaLtaStage<FloatSampleFormat>::Detector::bufferBytes(),
+                      StaLtaStage<FixedSampleFormat>::Detector::bufferBytes());
+    TEST_ASSERT_LESS_THAN(sizeof(FloatChain::Block), sizeof(FixedChain::Block));
+}
+
+// Calibration + spike filter + STA/LTA, ns per sample
+template <typename Format, typename Chain>
+static float benchmarkChain(Chain& chain, SampleBlock<Format>& block, const int16_t* raw, int samples) {
+    Calibration<Format> calibration;
+    chain.reset();
+    const size_t capacity = SampleBlock<Format>::CAPACITY;
+    uint64_t start = benchNowUs();
+    for (int n = 0; n + (int)capacity <= samples; n += capacity) {
+        for (size_t i = 0; i < capacity; i++) calibration.apply(raw + 3 * ((n + i) % 4096), block, i);
+        chain.processBlock(block, capacity);
+    }
+    return (benchNowUs() - start) * 1000.0f / samples;
+}
+
+void test_benchmark_formats() {
+    buildMount();
+    static int16_t raw[3 * 4096];
+    BenchRandom random;
+    for (int n = 0; n < 4096; n++) rawSample(9 * SAMPLING_RATE + n, random, raw + 3 * n);
+
+    const int samples = 200000;
+    float floatNs = benchmarkChain<FloatSampleFormat>(floatChain, floatBlock, raw, samples);
+    float fixedNs = benchmarkChain<FixedSampleFormat>(fixedChain, fixedBlock, raw, samples);
+
+    char message[256];
+    snprintf(message, sizeof(message), "per sample: %s %.1f ns, %s %.1f ns (%d samples, block %u)",
+             FloatSampleFormat::name(), floatNs, FixedSampleFormat::name(), fixedNs, samples,
+             (unsigned)FloatChain::Block::CAPACITY);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_GREATER_THAN(0.0f, floatNs + fixedNs);
+}
+
+static int runTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_squared_threshold_is_exact);
+    RUN_TEST(test_identity_rotation_is_exact);
+    RUN_TEST(test_ratio_decision_matches_exact_arithmetic);
+    RUN_TEST(test_wide_ratio_survives_full_scale);
+    RUN_TEST(test_fixed_chain_tracks_float_reference);
+    RUN_TEST(test_fixed_buffers_are_half_size);
+    RUN_TEST(test_benchmark_formats);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runTests();
+}
+
+void loop() {}
+#else
+int main() {
+    return runTests();
+}
+#endif